@@ -0,0 +1,147 @@
+#include "bench.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+const size_t BENCH_DEFAULT_WARMUP = 10;
+const size_t BENCH_DEFAULT_REPS = 100;
+const double BENCH_PERCENTILE = 0.99;
+const double BENCH_NS_PER_S = 1e9;
+
+volatile double bench_sink;
+
+typedef struct bench {
+  size_t warmup;
+  size_t reps;
+  const char *filter;
+  FILE *csv;
+  // per-operation times of the current case's repetitions, in ns
+  double *samples;
+} bench_t;
+
+bench_t *bench_init(int argc, char *argv[]) {
+  bench_t *bench = malloc(sizeof(bench_t));
+  assert(bench != NULL);
+  bench->warmup = BENCH_DEFAULT_WARMUP;
+  bench->reps = BENCH_DEFAULT_REPS;
+  bench->filter = NULL;
+  bench->csv = stdout;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "w:r:f:o:")) != -1) {
+    switch (opt) {
+    case 'w':
+      bench->warmup = strtoul(optarg, NULL, 10);
+      break;
+    case 'r':
+      bench->reps = strtoul(optarg, NULL, 10);
+      break;
+    case 'f':
+      bench->filter = optarg;
+      break;
+    case 'o':
+      bench->csv = fopen(optarg, "w");
+      if (bench->csv == NULL) {
+        perror(optarg);
+        exit(1);
+      }
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-w warmup] [-r reps] [-f filter] [-o csv]\n",
+              argv[0]);
+      exit(2);
+    }
+  }
+  if (bench->reps == 0) {
+    fprintf(stderr, "%s: need at least one repetition\n", argv[0]);
+    exit(2);
+  }
+  bench->samples = malloc(sizeof(double) * bench->reps);
+  assert(bench->samples != NULL);
+
+  fprintf(bench->csv, "name,ops,reps,median_ns,p99_ns,min_ns,mean_ns\n");
+  fprintf(stderr, "%-32s %12s %12s %12s\n", "case", "median ns/op",
+          "p99 ns/op", "min ns/op");
+  return bench;
+}
+
+void bench_free(bench_t *bench) {
+  if (bench->csv != stdout) {
+    fclose(bench->csv);
+  } else {
+    fflush(stdout);
+  }
+  free(bench->samples);
+  free(bench);
+}
+
+bool bench_selected(bench_t *bench, const char *name) {
+  return bench->filter == NULL || strstr(name, bench->filter) != NULL;
+}
+
+double bench_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * BENCH_NS_PER_S + now.tv_nsec;
+}
+
+int bench_compare_doubles(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/** Runs a case once and returns the time it took per operation, in ns */
+double bench_run_once(bench_case_t *bench_case) {
+  if (bench_case->setup != NULL) {
+    bench_case->setup(bench_case->aux);
+  }
+  double start = bench_now();
+  bench_case->run(bench_case->aux);
+  double elapsed = bench_now() - start;
+  if (bench_case->teardown != NULL) {
+    bench_case->teardown(bench_case->aux);
+  }
+  return elapsed / bench_case->ops;
+}
+
+bench_summary_t bench_summarize(double *samples, size_t count) {
+  assert(count > 0);
+  double total = 0;
+  for (size_t i = 0; i < count; i++) {
+    total += samples[i];
+  }
+  qsort(samples, count, sizeof(double), bench_compare_doubles);
+  // the nearest-rank percentile
+  size_t p99_index = (size_t)ceil(BENCH_PERCENTILE * count) - 1;
+  double median = count % 2 == 1
+                      ? samples[count / 2]
+                      : (samples[count / 2 - 1] + samples[count / 2]) / 2;
+  return (bench_summary_t){.median = median,
+                           .p99 = samples[p99_index],
+                           .min = samples[0],
+                           .mean = total / count};
+}
+
+void bench_run(bench_t *bench, bench_case_t bench_case) {
+  assert(bench_case.ops > 0);
+  if (!bench_selected(bench, bench_case.name)) {
+    return;
+  }
+  for (size_t i = 0; i < bench->warmup; i++) {
+    bench_run_once(&bench_case);
+  }
+  for (size_t i = 0; i < bench->reps; i++) {
+    bench->samples[i] = bench_run_once(&bench_case);
+  }
+  bench_summary_t summary = bench_summarize(bench->samples, bench->reps);
+
+  fprintf(bench->csv, "%s,%zu,%zu,%.2f,%.2f,%.2f,%.2f\n", bench_case.name,
+          bench_case.ops, bench->reps, summary.median, summary.p99,
+          summary.min, summary.mean);
+  fprintf(stderr, "%-32s %12.2f %12.2f %12.2f\n", bench_case.name,
+          summary.median, summary.p99, summary.min);
+}
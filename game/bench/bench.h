@@ -0,0 +1,116 @@
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A small timing harness for micro-benchmarks.
+ *
+ * Each case is run a number of times to warm up, then a number of timed
+ * repetitions. Every repetition runs a batch of operations, and the harness
+ * reports the median, 99th percentile, minimum and mean time per operation.
+ * Results go to stderr as a table and to a CSV file (stdout by default).
+ *
+ * Command line options, parsed by bench_init():
+ *   -w <count>  warm-up runs per case (default 10)
+ *   -r <count>  timed repetitions per case (default 100)
+ *   -f <text>   only run cases whose names contain the text
+ *   -o <path>   write the CSV to a file instead of stdout
+ */
+typedef struct bench bench_t;
+
+/**
+ * A function run by a benchmark case.
+ *
+ * @param aux the case's auxiliary value
+ */
+typedef void (*bench_fn_t)(void *aux);
+
+/**
+ * A benchmark case.
+ */
+typedef struct bench_case {
+  /** The name the case is reported under */
+  const char *name;
+  /** The number of operations one call to run performs */
+  size_t ops;
+  /** If non-NULL, called untimed before every run */
+  bench_fn_t setup;
+  /** The timed code */
+  bench_fn_t run;
+  /** If non-NULL, called untimed after every run */
+  bench_fn_t teardown;
+  /** The value passed to setup, run and teardown */
+  void *aux;
+} bench_case_t;
+
+/**
+ * Statistics over a set of timing samples, in the samples' units.
+ */
+typedef struct bench_summary {
+  double median;
+  /** The 99th percentile (nearest rank) */
+  double p99;
+  double min;
+  double mean;
+} bench_summary_t;
+
+/**
+ * Somewhere for cases to store results, so the compiler can't discard the
+ * computations being timed.
+ */
+extern volatile double bench_sink;
+
+/**
+ * Parses the command line and writes the CSV header.
+ * Prints a usage message and exits on bad options.
+ *
+ * @param argc the number of command line arguments
+ * @param argv the command line arguments
+ * @return a pointer to the newly allocated harness
+ */
+bench_t *bench_init(int argc, char *argv[]);
+
+/**
+ * Finishes the CSV and releases the memory allocated for a harness.
+ *
+ * @param bench a pointer to a harness returned from bench_init()
+ */
+void bench_free(bench_t *bench);
+
+/**
+ * Returns whether a case would be run, so callers can skip expensive setup
+ * for cases that have been filtered out.
+ *
+ * @param bench a pointer to a harness returned from bench_init()
+ * @param name the case's name
+ * @return true if the name passes the -f filter
+ */
+bool bench_selected(bench_t *bench, const char *name);
+
+/**
+ * Times a case and reports its results, unless it has been filtered out.
+ *
+ * @param bench a pointer to a harness returned from bench_init()
+ * @param bench_case the case to run
+ */
+void bench_run(bench_t *bench, bench_case_t bench_case);
+
+/**
+ * Reads a monotonic clock.
+ *
+ * @return the current time in ns, from an arbitrary starting point
+ */
+double bench_now(void);
+
+/**
+ * Summarizes a set of timing samples, sorting them in place.
+ *
+ * @param samples the samples
+ * @param count the number of samples (must be positive)
+ * @return their median, 99th percentile, minimum and mean
+ */
+bench_summary_t bench_summarize(double *samples, size_t count);
+
+#endif // #ifndef __BENCH_H__
@@ -0,0 +1,315 @@
+/**
+ * Micro-benchmarks for the engine's kernels: lists, vectors, polygons,
+ * collision detection, body integration and whole scene ticks.
+ *
+ * Usage: bin/bench [-w warmup] [-r reps] [-f filter] [-o csv]
+ */
+
+#include "bench.h"
+#include "body.h"
+#include "collision.h"
+#include "forces.h"
+#include "list.h"
+#include "polygon.h"
+#include "scene.h"
+#include "shape.h"
+#include "vec_array.h"
+#include "vector.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const size_t BENCH_LIST_SIZE = 10000;
+// removing from the front shifts the whole list, so keep it short
+const size_t BENCH_LIST_FRONT_SIZE = 1000;
+const size_t BENCH_NUM_VECTORS = 4096;
+const size_t BENCH_POLYGON_SIDES = 32;
+const size_t BENCH_POLYGON_OPS = 1000;
+const size_t BENCH_COLLISION_OPS = 1000;
+const size_t BENCH_CIRCLE_SIDES = 20;
+const double BENCH_RADIUS = 10;
+const size_t BENCH_NUM_BODIES = 1000;
+const size_t BENCH_SCENE_SIZES[] = {100, 1000, 10000};
+const double BENCH_WORLD_SIZE = 1000;
+const double BENCH_SPEED = 100;
+const double BENCH_DRAG = 0.1;
+const double BENCH_DT = 0.01;
+const color_t BENCH_COLOR = {.r = 1, .g = 1, .b = 1, .a = 1};
+
+double bench_random(double min, double max) {
+  return min + (max - min) * rand() / RAND_MAX;
+}
+
+vector_t bench_random_vector(double size) {
+  return (vector_t){bench_random(-size, size), bench_random(-size, size)};
+}
+
+/* Lists */
+
+typedef struct {
+  list_t *list;
+  size_t size;
+} bench_list_t;
+
+void bench_list_empty(void *aux) {
+  bench_list_t *bench_list = aux;
+  list_clear(bench_list->list);
+}
+
+void bench_list_fill(void *aux) {
+  bench_list_t *bench_list = aux;
+  list_clear(bench_list->list);
+  for (size_t i = 0; i < bench_list->size; i++) {
+    list_add(bench_list->list, (void *)(uintptr_t)(i + 1));
+  }
+}
+
+void bench_list_add(void *aux) {
+  bench_list_fill(aux);
+}
+
+void bench_list_remove_back(void *aux) {
+  bench_list_t *bench_list = aux;
+  for (size_t i = bench_list->size; i > 0; i--) {
+    list_remove(bench_list->list, i - 1);
+  }
+}
+
+void bench_list_remove_front(void *aux) {
+  bench_list_t *bench_list = aux;
+  for (size_t i = 0; i < bench_list->size; i++) {
+    list_remove(bench_list->list, 0);
+  }
+}
+
+void bench_lists(bench_t *bench) {
+  bench_list_t bench_list = {.list = list_init(BENCH_LIST_SIZE, NULL),
+                             .size = BENCH_LIST_SIZE};
+  bench_run(bench, (bench_case_t){.name = "list_add",
+                                  .ops = BENCH_LIST_SIZE,
+                                  .setup = bench_list_empty,
+                                  .run = bench_list_add,
+                                  .aux = &bench_list});
+  bench_run(bench, (bench_case_t){.name = "list_remove_back",
+                                  .ops = BENCH_LIST_SIZE,
+                                  .setup = bench_list_fill,
+                                  .run = bench_list_remove_back,
+                                  .aux = &bench_list});
+  bench_list_t front_list = {.list = bench_list.list,
+                             .size = BENCH_LIST_FRONT_SIZE};
+  bench_run(bench, (bench_case_t){.name = "list_remove_front",
+                                  .ops = BENCH_LIST_FRONT_SIZE,
+                                  .setup = bench_list_fill,
+                                  .run = bench_list_remove_front,
+                                  .aux = &front_list});
+  list_free(bench_list.list);
+}
+
+/* Vectors */
+
+void bench_vec_add(void *aux) {
+  vector_t *vectors = aux, sum = VEC_ZERO;
+  for (size_t i = 0; i < BENCH_NUM_VECTORS; i++) {
+    sum = vec_add(sum, vectors[i]);
+  }
+  bench_sink = sum.x + sum.y;
+}
+
+void bench_vec_dot(void *aux) {
+  vector_t *vectors = aux;
+  double sum = 0;
+  for (size_t i = 0; i + 1 < BENCH_NUM_VECTORS; i++) {
+    sum += vec_dot(vectors[i], vectors[i + 1]);
+  }
+  bench_sink = sum;
+}
+
+void bench_vec_rotate(void *aux) {
+  vector_t *vectors = aux, sum = VEC_ZERO;
+  for (size_t i = 0; i < BENCH_NUM_VECTORS; i++) {
+    sum = vec_add(sum, vec_rotate(vectors[i], i * 0.001));
+  }
+  bench_sink = sum.x + sum.y;
+}
+
+void bench_vec_normalize(void *aux) {
+  vector_t *vectors = aux, sum = VEC_ZERO;
+  for (size_t i = 0; i < BENCH_NUM_VECTORS; i++) {
+    sum = vec_add(sum, vec_normalize(vectors[i]));
+  }
+  bench_sink = sum.x + sum.y;
+}
+
+void bench_vectors(bench_t *bench) {
+  vector_t *vectors = malloc(sizeof(vector_t) * BENCH_NUM_VECTORS);
+  for (size_t i = 0; i < BENCH_NUM_VECTORS; i++) {
+    vectors[i] = bench_random_vector(BENCH_WORLD_SIZE);
+  }
+  bench_case_t cases[] = {
+      {.name = "vec_add", .run = bench_vec_add},
+      {.name = "vec_dot", .run = bench_vec_dot},
+      {.name = "vec_rotate", .run = bench_vec_rotate},
+      {.name = "vec_normalize", .run = bench_vec_normalize},
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(*cases); i++) {
+    cases[i].ops = BENCH_NUM_VECTORS;
+    cases[i].aux = vectors;
+    bench_run(bench, cases[i]);
+  }
+  free(vectors);
+}
+
+/* Polygons */
+
+void bench_polygon_centroid(void *aux) {
+  vector_t sum = VEC_ZERO;
+  for (size_t i = 0; i < BENCH_POLYGON_OPS; i++) {
+    sum = vec_add(sum, polygon_centroid(aux));
+  }
+  bench_sink = sum.x + sum.y;
+}
+
+void bench_polygon_translate(void *aux) {
+  for (size_t i = 0; i < BENCH_POLYGON_OPS; i++) {
+    // alternate directions so the polygon stays put
+    polygon_translate(aux, i % 2 == 0 ? (vector_t){1, 2} : (vector_t){-1, -2});
+  }
+}
+
+void bench_polygon_rotate(void *aux) {
+  for (size_t i = 0; i < BENCH_POLYGON_OPS; i++) {
+    polygon_rotate(aux, 0.01, VEC_ZERO);
+  }
+}
+
+void bench_polygons(bench_t *bench) {
+  shape_t *circle = shape_circle(BENCH_POLYGON_SIDES, BENCH_RADIUS);
+  vec_array_t *polygon = vec_array_copy(shape_get_vertices(circle));
+  bench_case_t cases[] = {
+      {.name = "polygon_centroid", .run = bench_polygon_centroid},
+      {.name = "polygon_translate", .run = bench_polygon_translate},
+      {.name = "polygon_rotate", .run = bench_polygon_rotate},
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(*cases); i++) {
+    cases[i].ops = BENCH_POLYGON_OPS;
+    cases[i].aux = polygon;
+    bench_run(bench, cases[i]);
+  }
+  vec_array_free(polygon);
+  shape_release(circle);
+}
+
+/* Collisions */
+
+typedef struct {
+  vec_array_t *circle;
+  vec_array_t *rect;
+} bench_pair_t;
+
+void bench_find_collision(void *aux) {
+  bench_pair_t *pair = aux;
+  size_t collided = 0;
+  for (size_t i = 0; i < BENCH_COLLISION_OPS; i++) {
+    collided += find_collision(pair->circle, pair->rect).collided;
+  }
+  bench_sink = collided;
+}
+
+void bench_collisions(bench_t *bench) {
+  shape_t *circle = shape_circle(BENCH_CIRCLE_SIDES, BENCH_RADIUS);
+  shape_t *rect = shape_rectangle(4 * BENCH_RADIUS, 2 * BENCH_RADIUS);
+  bench_pair_t overlapping = {.circle = vec_array_copy(shape_get_vertices(circle)),
+                              .rect = vec_array_copy(shape_get_vertices(rect))};
+  bench_pair_t separate = {.circle = vec_array_copy(shape_get_vertices(circle)),
+                           .rect = vec_array_copy(shape_get_vertices(rect))};
+  polygon_translate(overlapping.circle, (vector_t){BENCH_RADIUS, 0});
+  polygon_translate(separate.circle, (vector_t){4 * BENCH_RADIUS, 0});
+
+  bench_run(bench, (bench_case_t){.name = "find_collision_circle_rect_hit",
+                                  .ops = BENCH_COLLISION_OPS,
+                                  .run = bench_find_collision,
+                                  .aux = &overlapping});
+  bench_run(bench, (bench_case_t){.name = "find_collision_circle_rect_miss",
+                                  .ops = BENCH_COLLISION_OPS,
+                                  .run = bench_find_collision,
+                                  .aux = &separate});
+
+  bench_pair_t pairs[] = {overlapping, separate};
+  for (size_t i = 0; i < sizeof(pairs) / sizeof(*pairs); i++) {
+    vec_array_free(pairs[i].circle);
+    vec_array_free(pairs[i].rect);
+  }
+  shape_release(circle);
+  shape_release(rect);
+}
+
+/* Bodies and scenes */
+
+body_t *bench_random_body(shape_t *shape) {
+  body_t *body = body_init_shape(shape, VEC_ZERO, 1, BENCH_COLOR);
+  body_set_centroid(body, bench_random_vector(BENCH_WORLD_SIZE));
+  body_set_velocity(body, bench_random_vector(BENCH_SPEED));
+  body_set_rotation(body, bench_random(0, 2 * M_PI));
+  return body;
+}
+
+void bench_body_tick(void *aux) {
+  list_t *bodies = aux;
+  for (size_t i = 0; i < list_size(bodies); i++) {
+    body_tick(list_get(bodies, i), BENCH_DT);
+  }
+}
+
+void bench_scene_tick_canon(void *aux) { scene_tick_canon(aux, BENCH_DT); }
+
+void bench_bodies(bench_t *bench) {
+  shape_t *shape = shape_circle(BENCH_CIRCLE_SIDES, BENCH_RADIUS);
+
+  if (bench_selected(bench, "body_tick")) {
+    list_t *bodies = list_init(BENCH_NUM_BODIES, body_free);
+    for (size_t i = 0; i < BENCH_NUM_BODIES; i++) {
+      list_add(bodies, bench_random_body(shape));
+    }
+    bench_run(bench, (bench_case_t){.name = "body_tick",
+                                    .ops = BENCH_NUM_BODIES,
+                                    .run = bench_body_tick,
+                                    .aux = bodies});
+    list_free(bodies);
+  }
+
+  // every body has its own drag force, like the game's bodies have forces
+  for (size_t i = 0; i < sizeof(BENCH_SCENE_SIZES) / sizeof(size_t); i++) {
+    char name[64];
+    snprintf(name, sizeof(name), "scene_tick_canon_%zu", BENCH_SCENE_SIZES[i]);
+    if (!bench_selected(bench, name)) {
+      continue;
+    }
+    scene_t *scene = scene_init();
+    for (size_t j = 0; j < BENCH_SCENE_SIZES[i]; j++) {
+      body_t *body = bench_random_body(shape);
+      scene_add_body(scene, body);
+      create_drag(scene, BENCH_DRAG, body);
+    }
+    // one op per tick
+    bench_run(bench, (bench_case_t){.name = name,
+                                    .ops = 1,
+                                    .run = bench_scene_tick_canon,
+                                    .aux = scene});
+    scene_free(scene);
+  }
+  shape_release(shape);
+}
+
+int main(int argc, char *argv[]) {
+  bench_t *bench = bench_init(argc, argv);
+  srand(0);
+  bench_lists(bench);
+  bench_vectors(bench);
+  bench_polygons(bench);
+  bench_collisions(bench);
+  bench_bodies(bench);
+  bench_free(bench);
+  shape_registry_free();
+  return 0;
+}
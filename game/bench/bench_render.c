@@ -0,0 +1,96 @@
+/**
+ * Micro-benchmarks for the renderer, run against SDL's dummy video driver so
+ * they need no display. Most time the main thread's side of drawing:
+ * recording draw calls and publishing frames to the render thread.
+ * The replay cases time drawing a recorded frame, with the render thread
+ * switched off so sdl_show() replays it before returning. A render thread
+ * cannot be stopped once started, so they run in a child process.
+ *
+ * Usage: bin/bench_render [-w warmup] [-r reps] [-f filter] [-o csv]
+ */
+
+#include "bench.h"
+#include "sdl_wrapper.h"
+#include "polygon.h"
+#include "shape.h"
+#include "vec_array.h"
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+const size_t BENCH_POLYGONS_PER_FRAME = 1000;
+const size_t BENCH_POLYGON_SIDES = 20;
+const double BENCH_POLYGON_RADIUS = 5;
+const vector_t BENCH_MIN = {.x = 0, .y = 0};
+const vector_t BENCH_MAX = {.x = 1000, .y = 500};
+const color_t BENCH_COLOR = {.r = 0.2, .g = 0.6, .b = 1, .a = 1};
+// fast enough that frame pacing never sleeps
+const double BENCH_FRAME_RATE = 1e6;
+
+void bench_record_polygons(void *aux) {
+  vec_array_t *polygon = aux;
+  for (size_t i = 0; i < BENCH_POLYGONS_PER_FRAME; i++) {
+    sdl_draw_polygon(polygon, BENCH_COLOR);
+  }
+}
+
+void bench_draw_polygons(void *aux) {
+  bench_record_polygons(aux);
+  sdl_show();
+}
+
+void bench_show(void *aux) { sdl_show(); }
+
+/** Opens the window, with or without a render thread */
+void bench_sdl_init(bool render_thread) {
+  sdl_set_render_thread(render_thread);
+  sdl_init(BENCH_MIN, BENCH_MAX);
+  sdl_set_frame_rate(BENCH_FRAME_RATE);
+}
+
+/** Runs the cases that replay frames on the main thread */
+void bench_replay(bench_t *bench, vec_array_t *polygon) {
+  bench_sdl_init(false);
+  // the polygons are recorded untimed, so only drawing them is timed
+  bench_run(bench, (bench_case_t){.name = "sdl_replay_polygons",
+                                  .ops = BENCH_POLYGONS_PER_FRAME,
+                                  .setup = bench_record_polygons,
+                                  .run = bench_show,
+                                  .aux = polygon});
+}
+
+int main(int argc, char *argv[]) {
+  bench_t *bench = bench_init(argc, argv);
+  setenv("SDL_VIDEODRIVER", "dummy", false);
+  setenv("SDL_AUDIODRIVER", "dummy", false);
+  shape_t *circle = shape_circle(BENCH_POLYGON_SIDES, BENCH_POLYGON_RADIUS);
+  vec_array_t *polygon = vec_array_copy(shape_get_vertices(circle));
+  polygon_translate(polygon, vec_multiply(0.5, BENCH_MAX));
+
+  pid_t child = -1;
+  if (bench_selected(bench, "sdl_replay_polygons")) {
+    // the child's results must follow the header, not repeat it
+    fflush(NULL);
+    child = fork();
+  }
+  if (child == 0) {
+    bench_replay(bench, polygon);
+  } else {
+    if (child > 0) {
+      waitpid(child, NULL, 0);
+    }
+    bench_sdl_init(true);
+    bench_run(bench, (bench_case_t){.name = "sdl_draw_polygon",
+                                    .ops = BENCH_POLYGONS_PER_FRAME,
+                                    .run = bench_draw_polygons,
+                                    .aux = polygon});
+    bench_run(bench, (bench_case_t){.name = "sdl_show_empty",
+                                    .ops = 1,
+                                    .run = bench_show});
+  }
+  sdl_quit();
+  vec_array_free(polygon);
+  shape_release(circle);
+  bench_free(bench);
+  return 0;
+}
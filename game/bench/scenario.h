@@ -0,0 +1,94 @@
+#ifndef __SCENARIO_H__
+#define __SCENARIO_H__
+
+#include "scene.h"
+#include <stddef.h>
+
+/**
+ * Headless macro-benchmark scenarios, ported from the archived demos.
+ * Each one builds a scene, plays itself (no input needed) and is ticked by
+ * bin/scenarios, which times its update, physics and render phases.
+ */
+
+/**
+ * The knobs a scenario scales with. Each scenario documents which ones it
+ * reads; a value of 0 means "use the scenario's default", and the scenario
+ * fills in the defaults it used so they can be reported.
+ */
+typedef struct scenario_options {
+  /** -n: the number of bodies, segments, balls or pellets */
+  size_t count;
+  /** -r: the number of rows */
+  size_t rows;
+  /** -c: the number of columns (bricks or invaders per row) */
+  size_t columns;
+} scenario_options_t;
+
+/**
+ * A scenario. Its state is private to it.
+ */
+typedef struct scenario {
+  /** The name the scenario is selected and reported by */
+  const char *name;
+  /** Which options the scenario reads, for the usage message */
+  const char *usage;
+  /**
+   * Builds the scenario's scene.
+   *
+   * @param options the options to build with; defaults are filled in
+   * @return the scenario's state
+   */
+  void *(*init)(scenario_options_t *options);
+  /**
+   * Runs the scenario's game logic for a tick: spawning, steering, wrapping.
+   *
+   * @param state the state returned from init
+   * @param dt the tick length, in seconds
+   */
+  void (*update)(void *state, double dt);
+  /**
+   * Steps the scenario's physics, the same way its demo did.
+   *
+   * @param state the state returned from init
+   * @param dt the tick length, in seconds
+   */
+  void (*tick)(void *state, double dt);
+  /**
+   * @param state the state returned from init
+   * @return the scene to draw
+   */
+  scene_t *(*get_scene)(void *state);
+  /**
+   * Releases a scenario's state.
+   *
+   * @param state the state returned from init
+   */
+  void (*free)(void *state);
+} scenario_t;
+
+extern const scenario_t SCENARIO_NBODIES;
+extern const scenario_t SCENARIO_DAMPING;
+extern const scenario_t SCENARIO_PEGS;
+extern const scenario_t SCENARIO_BREAKOUT;
+extern const scenario_t SCENARIO_SPACEINVADERS;
+extern const scenario_t SCENARIO_PACMAN;
+
+/**
+ * Picks a uniformly random number, using rand().
+ *
+ * @param low the lower bound
+ * @param high the upper bound
+ * @return a number between low and high
+ */
+double scenario_random(double low, double high);
+
+/**
+ * Picks an option's value, or its default if it wasn't given.
+ *
+ * @param value the option's value, which is updated to the result
+ * @param fallback the default value
+ * @return the value to use
+ */
+size_t scenario_option(size_t *value, size_t fallback);
+
+#endif // #ifndef __SCENARIO_H__
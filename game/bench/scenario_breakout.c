@@ -0,0 +1,222 @@
+/**
+ * Breakout (archive breakout demo): balls bounce between the walls, the
+ * paddle and rows of bricks, and every brick a ball hits is destroyed.
+ * The paddle follows the first ball (the demo's "hack mode"). A ball that
+ * reaches the ground is served again, and the bricks come back once they
+ * are all gone, so the scene keeps going for any number of ticks.
+ */
+
+#include "forces.h"
+#include "scenario.h"
+#include "shape.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const size_t BREAKOUT_DEFAULT_ROWS = 3;
+const size_t BREAKOUT_DEFAULT_COLUMNS = 10;
+const size_t BREAKOUT_DEFAULT_COUNT = 1;
+const vector_t BREAKOUT_WINDOW = {.x = 672, .y = 768};
+const double BREAKOUT_WALL_THICKNESS = 20;
+const double BREAKOUT_GROUND_HEIGHT = 6;
+const color_t BREAKOUT_WALL_COLOR = {.r = 0.3, .g = 0.3, .b = 0.3, .a = 1};
+const double BREAKOUT_PADDLE_WIDTH = 100;
+const double BREAKOUT_PADDLE_HEIGHT = 20;
+const vector_t BREAKOUT_PADDLE_SPAWN = {.x = 336, .y = 10};
+const double BREAKOUT_PADDLE_SPEED = 500;
+const color_t BREAKOUT_PADDLE_COLOR = {.r = 1, .g = 1, .b = 1, .a = 1};
+const double BREAKOUT_BALL_SIZE = 8;
+const size_t BREAKOUT_BALL_RESOLUTION = 20;
+const double BREAKOUT_BALL_MASS = 1;
+const vector_t BREAKOUT_BALL_SPAWN = {.x = 336, .y = 40};
+const double BREAKOUT_BALL_MIN_SPEED = 50;
+const double BREAKOUT_BALL_MAX_SPEED = 250;
+const color_t BREAKOUT_BALL_COLOR = {.r = 1, .g = 0.1, .b = 0, .a = 1};
+const double BREAKOUT_BRICK_HEIGHT = 20;
+const double BREAKOUT_PADDING = 100;
+const double BREAKOUT_ELASTICITY = 1;
+
+typedef struct breakout {
+  scene_t *scene;
+  body_t *paddle;
+  body_t *ground;
+  // the paddle and the walls, which every ball bounces off
+  list_t *fixtures;
+  list_t *balls;
+  size_t bricks_left;
+  size_t rows;
+  size_t columns;
+} breakout_t;
+
+// credit:
+// https://justinparrtech.com/JustinParr-Tech/spectrum-generating-color-function-using-sine-waves/
+color_t breakout_rainbow(double n, double m) {
+  double a = 5 * M_PI * n / (3 * m) + M_PI / 2;
+  return (color_t){.r = fmax(0, fmin(255, sin(a) * 192 + 128)) / 255,
+                   .g = fmax(0, fmin(255, sin(a - 2 * M_PI / 3) * 192 + 128)) /
+                        255,
+                   .b = fmax(0, fmin(255, sin(a - 4 * M_PI / 3) * 192 + 128)) /
+                        255,
+                   .a = 1};
+}
+
+body_t *breakout_add_box(breakout_t *breakout, double width, double height,
+                         vector_t center, color_t color) {
+  shape_t *box = shape_rectangle(width, height);
+  body_t *body = body_init_shape(box, center, INFINITY, color);
+  shape_release(box);
+  scene_add_body(breakout->scene, body);
+  return body;
+}
+
+void breakout_serve(body_t *ball) {
+  body_set_centroid(ball, BREAKOUT_BALL_SPAWN);
+  double direction = rand() % 2 == 0 ? 1 : -1;
+  body_set_velocity(
+      ball,
+      (vector_t){direction * scenario_random(BREAKOUT_BALL_MIN_SPEED,
+                                             BREAKOUT_BALL_MAX_SPEED),
+                 scenario_random(BREAKOUT_BALL_MIN_SPEED,
+                                 BREAKOUT_BALL_MAX_SPEED)});
+}
+
+void breakout_hit_brick(body_t *ball, body_t *brick, vector_t axis,
+                        void *aux) {
+  if (body_is_removed(brick)) {
+    return;
+  }
+  body_add_elastic_impulse(ball, brick, BREAKOUT_ELASTICITY);
+  body_remove(brick);
+  breakout_t *breakout = aux;
+  breakout->bricks_left--;
+}
+
+void breakout_hit_ground(body_t *ball, body_t *ground, vector_t axis,
+                         void *aux) {
+  breakout_serve(ball);
+}
+
+void breakout_add_bricks(breakout_t *breakout) {
+  double width = (BREAKOUT_WINDOW.x - 2 * BREAKOUT_WALL_THICKNESS) /
+                 breakout->columns;
+  shape_t *brick_shape = shape_rectangle(width, BREAKOUT_BRICK_HEIGHT);
+  for (size_t row = 0; row < breakout->rows; row++) {
+    for (size_t col = 0; col < breakout->columns; col++) {
+      vector_t center = {
+          BREAKOUT_WALL_THICKNESS + (col + 0.5) * width,
+          BREAKOUT_WINDOW.y - BREAKOUT_WALL_THICKNESS - BREAKOUT_PADDING -
+              (row + 0.5) * BREAKOUT_BRICK_HEIGHT};
+      body_t *brick =
+          body_init_shape(brick_shape, center, INFINITY,
+                          breakout_rainbow(col, breakout->columns));
+      scene_add_body(breakout->scene, brick);
+      breakout->bricks_left++;
+      for (size_t i = 0; i < list_size(breakout->balls); i++) {
+        create_collision(breakout->scene, list_get(breakout->balls, i), brick,
+                         breakout_hit_brick, breakout, NULL);
+      }
+    }
+  }
+  shape_release(brick_shape);
+}
+
+void *breakout_init(scenario_options_t *options) {
+  breakout_t *breakout = malloc(sizeof(breakout_t));
+  assert(breakout != NULL);
+  breakout->rows = scenario_option(&options->rows, BREAKOUT_DEFAULT_ROWS);
+  breakout->columns =
+      scenario_option(&options->columns, BREAKOUT_DEFAULT_COLUMNS);
+  size_t num_balls = scenario_option(&options->count, BREAKOUT_DEFAULT_COUNT);
+  breakout->scene = scene_init();
+  breakout->fixtures = list_init(4, NULL);
+  breakout->balls = list_init(num_balls, NULL);
+  breakout->bricks_left = 0;
+
+  breakout->paddle = breakout_add_box(
+      breakout, BREAKOUT_PADDLE_WIDTH, BREAKOUT_PADDLE_HEIGHT,
+      BREAKOUT_PADDLE_SPAWN, BREAKOUT_PADDLE_COLOR);
+  list_add(breakout->fixtures, breakout->paddle);
+  double half_wall = BREAKOUT_WALL_THICKNESS / 2;
+  list_add(breakout->fixtures,
+           breakout_add_box(breakout, BREAKOUT_WALL_THICKNESS,
+                            BREAKOUT_WINDOW.y,
+                            (vector_t){half_wall, BREAKOUT_WINDOW.y / 2},
+                            BREAKOUT_WALL_COLOR));
+  list_add(breakout->fixtures,
+           breakout_add_box(breakout, BREAKOUT_WINDOW.x,
+                            BREAKOUT_WALL_THICKNESS,
+                            (vector_t){BREAKOUT_WINDOW.x / 2,
+                                       BREAKOUT_WINDOW.y - half_wall},
+                            BREAKOUT_WALL_COLOR));
+  list_add(breakout->fixtures,
+           breakout_add_box(breakout, BREAKOUT_WALL_THICKNESS,
+                            BREAKOUT_WINDOW.y,
+                            (vector_t){BREAKOUT_WINDOW.x - half_wall,
+                                       BREAKOUT_WINDOW.y / 2},
+                            BREAKOUT_WALL_COLOR));
+  breakout->ground = breakout_add_box(
+      breakout, BREAKOUT_WINDOW.x, BREAKOUT_GROUND_HEIGHT,
+      (vector_t){BREAKOUT_WINDOW.x / 2, -BREAKOUT_GROUND_HEIGHT / 2},
+      BREAKOUT_WALL_COLOR);
+
+  shape_t *ball_shape =
+      shape_circle(BREAKOUT_BALL_RESOLUTION, BREAKOUT_BALL_SIZE);
+  for (size_t i = 0; i < num_balls; i++) {
+    body_t *ball = body_init_shape(ball_shape, BREAKOUT_BALL_SPAWN,
+                                   BREAKOUT_BALL_MASS, BREAKOUT_BALL_COLOR);
+    breakout_serve(ball);
+    scene_add_body(breakout->scene, ball);
+    list_add(breakout->balls, ball);
+    for (size_t j = 0; j < list_size(breakout->fixtures); j++) {
+      create_physics_collision(breakout->scene, BREAKOUT_ELASTICITY, ball,
+                               list_get(breakout->fixtures, j));
+    }
+    create_collision(breakout->scene, ball, breakout->ground,
+                     breakout_hit_ground, NULL, NULL);
+  }
+  shape_release(ball_shape);
+  breakout_add_bricks(breakout);
+  return breakout;
+}
+
+void breakout_update(void *state, double dt) {
+  breakout_t *breakout = state;
+  if (breakout->bricks_left == 0) {
+    breakout_add_bricks(breakout);
+  }
+
+  // chase the first ball, stopping at the walls
+  vector_t paddle = body_get_centroid(breakout->paddle);
+  double target = body_get_centroid(list_get(breakout->balls, 0)).x;
+  double half_width = BREAKOUT_PADDLE_WIDTH / 2 + BREAKOUT_WALL_THICKNESS;
+  target = fmax(half_width, fmin(BREAKOUT_WINDOW.x - half_width, target));
+  double step = BREAKOUT_PADDLE_SPEED * dt;
+  paddle.x += fmax(-step, fmin(step, target - paddle.x));
+  body_set_centroid(breakout->paddle, paddle);
+}
+
+void breakout_tick(void *state, double dt) {
+  scene_tick(((breakout_t *)state)->scene, dt);
+}
+
+scene_t *breakout_get_scene(void *state) {
+  return ((breakout_t *)state)->scene;
+}
+
+void breakout_free(void *state) {
+  breakout_t *breakout = state;
+  scene_free(breakout->scene);
+  list_free(breakout->fixtures);
+  list_free(breakout->balls);
+  free(breakout);
+}
+
+const scenario_t SCENARIO_BREAKOUT = {
+    .name = "breakout",
+    .usage = "-r brick rows (3), -c bricks per row (10), -n balls (1)",
+    .init = breakout_init,
+    .update = breakout_update,
+    .tick = breakout_tick,
+    .get_scene = breakout_get_scene,
+    .free = breakout_free,
+};
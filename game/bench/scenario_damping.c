@@ -0,0 +1,137 @@
+/**
+ * Damped rope (archive damping demo): a chain of beads joined by springs,
+ * pinned at one end, pulled down by a distant Earth and slowed by drag.
+ * A pac-man sits in the window and eats any bead that swings into it.
+ */
+
+#include "forces.h"
+#include "scenario.h"
+#include "shape.h"
+#include "vec_array.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const size_t DAMPING_DEFAULT_COUNT = 100;
+const vector_t DAMPING_CENTER = {.x = 800, .y = 450};
+const vector_t DAMPING_ROPE_START = {.x = 500, .y = 800};
+const double DAMPING_ROPE_LENGTH = 600;
+const double DAMPING_SEGMENT_MASS = 0.5;
+const size_t DAMPING_SEGMENT_RESOLUTION = 100;
+const double DAMPING_K = 2300;
+const double DAMPING_GAMMA = 0.94;
+const color_t DAMPING_ROPE_COLOR = {.r = 1, .g = 1, .b = 1, .a = 1};
+const double DAMPING_G = 1e-10;
+const double DAMPING_EARTH_MASS = 8e26;
+const vector_t DAMPING_EARTH_POSITION = {.x = 800, .y = -1e7};
+const color_t DAMPING_EARTH_COLOR = {.r = 0, .g = 0, .b = 0, .a = 1};
+const size_t DAMPING_PACMAN_RESOLUTION = 100;
+const double DAMPING_PACMAN_SIZE = 30;
+const double DAMPING_PACMAN_MOUTH = M_PI / 3;
+const color_t DAMPING_PACMAN_COLOR = {.r = 1, .g = 1, .b = 0, .a = 1};
+// the pac-man and the Earth come before the rope in the scene
+const size_t DAMPING_FIRST_SEGMENT = 2;
+
+typedef struct damping {
+  scene_t *scene;
+  body_t *pacman;
+} damping_t;
+
+/** Makes a pac-man centered at (0, 0), facing right */
+shape_t *damping_make_pacman(void) {
+  vec_array_t *pacman = vec_array_init(DAMPING_PACMAN_RESOLUTION + 1);
+  double step = (2 * M_PI - DAMPING_PACMAN_MOUTH) / DAMPING_PACMAN_RESOLUTION;
+  for (size_t i = 0; i < DAMPING_PACMAN_RESOLUTION; i++) {
+    double angle = DAMPING_PACMAN_MOUTH / 2 + i * step;
+    vec_array_add(pacman, vec_multiply(DAMPING_PACMAN_SIZE,
+                                       (vector_t){cos(angle), sin(angle)}));
+  }
+  vec_array_add(pacman, VEC_ZERO);
+  return shape_from_polygon(pacman);
+}
+
+void *damping_init(scenario_options_t *options) {
+  size_t count = scenario_option(&options->count, DAMPING_DEFAULT_COUNT);
+  damping_t *damping = malloc(sizeof(damping_t));
+  assert(damping != NULL);
+  damping->scene = scene_init();
+
+  shape_t *pacman_shape = damping_make_pacman();
+  damping->pacman =
+      body_init_shape(pacman_shape, DAMPING_CENTER, 1, DAMPING_PACMAN_COLOR);
+  scene_add_body(damping->scene, damping->pacman);
+  shape_release(pacman_shape);
+
+  shape_t *earth_shape = shape_circle(3, 1);
+  body_t *earth = body_init_shape(earth_shape, DAMPING_EARTH_POSITION,
+                                  DAMPING_EARTH_MASS, DAMPING_EARTH_COLOR);
+  scene_add_body(damping->scene, earth);
+  shape_release(earth_shape);
+
+  double spacing = DAMPING_ROPE_LENGTH / count;
+  shape_t *bead = shape_circle(DAMPING_SEGMENT_RESOLUTION, spacing / 2);
+  vector_t center = DAMPING_ROPE_START;
+  for (size_t i = 0; i < count; i++) {
+    scene_add_body(damping->scene,
+                   body_init_shape(bead, center, DAMPING_SEGMENT_MASS,
+                                   DAMPING_ROPE_COLOR));
+    center.x += spacing;
+  }
+  shape_release(bead);
+
+  // the first bead is pinned: nothing pulls on it
+  size_t num_bodies = scene_bodies(damping->scene);
+  for (size_t i = DAMPING_FIRST_SEGMENT; i + 1 < num_bodies; i++) {
+    body_t *body1 = scene_get_body(damping->scene, i);
+    body_t *body2 = scene_get_body(damping->scene, i + 1);
+    if (i == DAMPING_FIRST_SEGMENT) {
+      create_spring(damping->scene, DAMPING_K, body2, body1);
+      continue;
+    }
+    create_newtonian_gravity(damping->scene, DAMPING_G, body1, earth);
+    create_drag(damping->scene, DAMPING_GAMMA, body1);
+    create_spring(damping->scene, DAMPING_K, body1, body2);
+    if (i + 2 < num_bodies) {
+      create_spring(damping->scene, DAMPING_K, body2, body1);
+    }
+  }
+  return damping;
+}
+
+void damping_update(void *state, double dt) {
+  damping_t *damping = state;
+  vector_t mouth = body_get_centroid(damping->pacman);
+  for (size_t i = DAMPING_FIRST_SEGMENT; i < scene_bodies(damping->scene);
+       i++) {
+    body_t *bead = scene_get_body(damping->scene, i);
+    if (!body_is_removed(bead) &&
+        vec_dist(body_get_centroid(bead), mouth) < DAMPING_PACMAN_SIZE) {
+      // the scene drops the bead's springs along with it
+      body_remove(bead);
+    }
+  }
+}
+
+void damping_tick(void *state, double dt) {
+  damping_t *damping = state;
+  scene_tick_canon_no_reset(damping->scene, dt);
+  scene_accel_reset(damping->scene);
+}
+
+scene_t *damping_get_scene(void *state) { return ((damping_t *)state)->scene; }
+
+void damping_free(void *state) {
+  damping_t *damping = state;
+  scene_free(damping->scene);
+  free(damping);
+}
+
+const scenario_t SCENARIO_DAMPING = {
+    .name = "damping",
+    .usage = "-n rope segments (100)",
+    .init = damping_init,
+    .update = damping_update,
+    .tick = damping_tick,
+    .get_scene = damping_get_scene,
+    .free = damping_free,
+};
@@ -0,0 +1,92 @@
+/**
+ * N-body gravity (archive nbodies demo): star-shaped bodies scattered over
+ * the window, with Newtonian gravity between every pair.
+ * Forces grow with the square of the body count.
+ */
+
+#include "forces.h"
+#include "scenario.h"
+#include "shape.h"
+#include "vec_array.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const size_t NBODIES_DEFAULT_COUNT = 60;
+const vector_t NBODIES_WINDOW = {.x = 1600, .y = 900};
+const size_t NBODIES_STAR_POINTS = 4;
+const double NBODIES_STAR_RATIO = 3.0 / 7.0;
+const double NBODIES_STAR_SIZE = 30;
+const double NBODIES_MASS = 1;
+const double NBODIES_G = 1e5;
+
+typedef struct nbodies {
+  scene_t *scene;
+} nbodies_t;
+
+/** Makes a star centered at (0, 0), alternating long and short points */
+shape_t *nbodies_make_star(void) {
+  size_t num_vertices = NBODIES_STAR_POINTS * 2;
+  vec_array_t *star = vec_array_init(num_vertices);
+  for (size_t i = 0; i < num_vertices; i++) {
+    double length = NBODIES_STAR_SIZE * (i % 2 == 0 ? 1 : NBODIES_STAR_RATIO);
+    double angle = 2 * M_PI * i / num_vertices;
+    vec_array_add(star, (vector_t){length * cos(angle), length * sin(angle)});
+  }
+  return shape_from_polygon(star);
+}
+
+void *nbodies_init(scenario_options_t *options) {
+  size_t count = scenario_option(&options->count, NBODIES_DEFAULT_COUNT);
+  nbodies_t *nbodies = malloc(sizeof(nbodies_t));
+  assert(nbodies != NULL);
+  nbodies->scene = scene_init();
+  shape_t *star = nbodies_make_star();
+  for (size_t i = 0; i < count; i++) {
+    vector_t position = {scenario_random(0, NBODIES_WINDOW.x),
+                         scenario_random(0, NBODIES_WINDOW.y)};
+    double offset = scenario_random(0, M_PI / 2);
+    color_t color = {.r = fabs(sin(offset)),
+                     .g = fabs(sin(offset + M_PI / 6)),
+                     .b = fabs(sin(offset + M_PI / 4)),
+                     .a = 1};
+    scene_add_body(nbodies->scene,
+                   body_init_shape(star, position, NBODIES_MASS, color));
+  }
+  shape_release(star);
+
+  for (size_t i = 0; i < count; i++) {
+    for (size_t j = i + 1; j < count; j++) {
+      create_newtonian_gravity(nbodies->scene, NBODIES_G,
+                               scene_get_body(nbodies->scene, i),
+                               scene_get_body(nbodies->scene, j));
+    }
+  }
+  return nbodies;
+}
+
+void nbodies_update(void *state, double dt) {}
+
+void nbodies_tick(void *state, double dt) {
+  nbodies_t *nbodies = state;
+  scene_tick_canon_no_reset(nbodies->scene, dt);
+  scene_accel_reset(nbodies->scene);
+}
+
+scene_t *nbodies_get_scene(void *state) { return ((nbodies_t *)state)->scene; }
+
+void nbodies_free(void *state) {
+  nbodies_t *nbodies = state;
+  scene_free(nbodies->scene);
+  free(nbodies);
+}
+
+const scenario_t SCENARIO_NBODIES = {
+    .name = "nbodies",
+    .usage = "-n bodies (60)",
+    .init = nbodies_init,
+    .update = nbodies_update,
+    .tick = nbodies_tick,
+    .get_scene = nbodies_get_scene,
+    .free = nbodies_free,
+};
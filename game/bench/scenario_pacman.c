@@ -0,0 +1,137 @@
+/**
+ * Pac-man (archive pacman demo): pac-man wanders the window, wrapping around
+ * its edges and eating the pellets it passes over, while a new pellet appears
+ * every second. Pac-man picks a new direction every second in place of the
+ * demo's arrow keys.
+ */
+
+#include "scenario.h"
+#include "shape.h"
+#include "vec_array.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const size_t PACMAN_DEFAULT_COUNT = 13;
+const vector_t PACMAN_WINDOW = {.x = 1600, .y = 900};
+const size_t PACMAN_RESOLUTION = 100;
+const double PACMAN_SIZE = 30;
+const double PACMAN_MOUTH = M_PI / 3;
+const double PACMAN_SPEED = 200;
+const double PACMAN_TURN_PERIOD = 1;
+const color_t PACMAN_COLOR = {.r = 1, .g = 1, .b = 0, .a = 1};
+const double PACMAN_PELLET_SIZE = 10;
+const double PACMAN_SPAWN_PERIOD = 1;
+
+typedef struct pacman {
+  scene_t *scene;
+  body_t *pacman;
+  shape_t *pellet_shape;
+  double time_since_spawn;
+  double time_since_turn;
+} pacman_t;
+
+/** Makes a pac-man centered at (0, 0), facing right */
+shape_t *pacman_make_pacman(void) {
+  vec_array_t *pacman = vec_array_init(PACMAN_RESOLUTION + 1);
+  double step = (2 * M_PI - PACMAN_MOUTH) / PACMAN_RESOLUTION;
+  for (size_t i = 0; i < PACMAN_RESOLUTION; i++) {
+    double angle = PACMAN_MOUTH / 2 + i * step;
+    vec_array_add(pacman,
+                  vec_multiply(PACMAN_SIZE, (vector_t){cos(angle), sin(angle)}));
+  }
+  vec_array_add(pacman, VEC_ZERO);
+  return shape_from_polygon(pacman);
+}
+
+void pacman_spawn_pellet(pacman_t *pacman) {
+  vector_t position = {scenario_random(0, PACMAN_WINDOW.x),
+                       scenario_random(0, PACMAN_WINDOW.y)};
+  color_t color = {.r = scenario_random(0, 1),
+                   .g = scenario_random(0, 1),
+                   .b = scenario_random(0, 1),
+                   .a = 1};
+  scene_add_body(pacman->scene,
+                 body_init_shape(pacman->pellet_shape, position, 1, color));
+}
+
+void pacman_turn(body_t *pacman) {
+  double angle = (rand() % 4) * M_PI / 2;
+  body_set_rotation(pacman, angle);
+  body_set_velocity(pacman,
+                    vec_multiply(PACMAN_SPEED, (vector_t){cos(angle), sin(angle)}));
+}
+
+void *pacman_init(scenario_options_t *options) {
+  size_t count = scenario_option(&options->count, PACMAN_DEFAULT_COUNT);
+  pacman_t *pacman = malloc(sizeof(pacman_t));
+  assert(pacman != NULL);
+  pacman->scene = scene_init();
+  pacman->pellet_shape =
+      shape_rectangle(PACMAN_PELLET_SIZE, PACMAN_PELLET_SIZE);
+  pacman->time_since_spawn = 0;
+  pacman->time_since_turn = 0;
+
+  shape_t *pacman_shape = pacman_make_pacman();
+  pacman->pacman = body_init_shape(pacman_shape, vec_multiply(0.5, PACMAN_WINDOW),
+                                   1, PACMAN_COLOR);
+  shape_release(pacman_shape);
+  scene_add_body(pacman->scene, pacman->pacman);
+  pacman_turn(pacman->pacman);
+  for (size_t i = 0; i < count; i++) {
+    pacman_spawn_pellet(pacman);
+  }
+  return pacman;
+}
+
+void pacman_update(void *state, double dt) {
+  pacman_t *pacman = state;
+  pacman->time_since_spawn += dt;
+  if (pacman->time_since_spawn >= PACMAN_SPAWN_PERIOD) {
+    pacman->time_since_spawn = 0;
+    pacman_spawn_pellet(pacman);
+  }
+  pacman->time_since_turn += dt;
+  if (pacman->time_since_turn >= PACMAN_TURN_PERIOD) {
+    pacman->time_since_turn = 0;
+    pacman_turn(pacman->pacman);
+  }
+
+  // wrap around the window's edges
+  vector_t centroid = body_get_centroid(pacman->pacman);
+  vector_t wrapped = {fmod(centroid.x + PACMAN_WINDOW.x, PACMAN_WINDOW.x),
+                      fmod(centroid.y + PACMAN_WINDOW.y, PACMAN_WINDOW.y)};
+  if (!vec_equals(wrapped, centroid)) {
+    body_set_centroid(pacman->pacman, wrapped);
+  }
+
+  for (size_t i = 1; i < scene_bodies(pacman->scene); i++) {
+    body_t *pellet = scene_get_body(pacman->scene, i);
+    if (vec_dist(body_get_centroid(pellet), wrapped) < PACMAN_SIZE) {
+      scene_remove_body(pacman->scene, i);
+    }
+  }
+}
+
+void pacman_tick(void *state, double dt) {
+  scene_tick(((pacman_t *)state)->scene, dt);
+}
+
+scene_t *pacman_get_scene(void *state) { return ((pacman_t *)state)->scene; }
+
+void pacman_free(void *state) {
+  pacman_t *pacman = state;
+  scene_free(pacman->scene);
+  shape_release(pacman->pellet_shape);
+  free(pacman);
+}
+
+const scenario_t SCENARIO_PACMAN = {
+    .name = "pacman",
+    .usage = "-n starting pellets (13)",
+    .init = pacman_init,
+    .update = pacman_update,
+    .tick = pacman_tick,
+    .get_scene = pacman_get_scene,
+    .free = pacman_free,
+};
@@ -0,0 +1,214 @@
+/**
+ * Pegs (archive pegs demo): balls dropped onto a triangle of pegs between
+ * two slanted walls. Balls bounce off pegs, walls and each other, and freeze
+ * when they land on the ground or on a frozen ball, so the pile grows.
+ * Every new ball gets a collision with every body already in the scene.
+ */
+
+#include "forces.h"
+#include "scenario.h"
+#include "shape.h"
+#include "vec_array.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const size_t PEGS_DEFAULT_ROWS = 11;
+// balls dropped per second
+const size_t PEGS_DEFAULT_COUNT = 1;
+const vector_t PEGS_MAX = {.x = 80, .y = 80};
+const size_t PEGS_CIRCLE_POINTS = 40;
+const double PEGS_ROW_SPACING = 3.6;
+const double PEGS_COL_SPACING = 3.5;
+const double PEGS_PEG_RADIUS = 0.5;
+const double PEGS_BALL_RADIUS = 1;
+const double PEGS_BALL_MASS = 2;
+const double PEGS_PEG_ELASTICITY = 0.3;
+const double PEGS_BALL_ELASTICITY = 0.7;
+const double PEGS_WALL_WIDTH = 1;
+const double PEGS_DELTA_X = 1;
+const double PEGS_DROP_HEIGHT = 3;
+const vector_t PEGS_START_VELOCITY = {.x = 0, .y = -8};
+const color_t PEGS_BALL_COLOR = {.r = 1, .g = 0, .b = 0, .a = 1};
+const color_t PEGS_PEG_COLOR = {.r = 0, .g = 1, .b = 0, .a = 1};
+const color_t PEGS_WALL_COLOR = {.r = 0, .g = 0, .b = 1, .a = 1};
+// an Earth-like mass, far enough below the scene to pull with g = 9.8
+const double PEGS_G = 6.67e-11;
+const double PEGS_EARTH_MASS = 6e24;
+const double PEGS_EARTH_G = 9.8;
+
+typedef enum { PEGS_BALL, PEGS_FROZEN, PEGS_WALL, PEGS_GRAVITY } pegs_type_t;
+
+typedef struct pegs {
+  scene_t *scene;
+  shape_t *ball_shape;
+  double drop_interval;
+  double time_since_drop;
+} pegs_t;
+
+pegs_type_t *pegs_make_type(pegs_type_t type) {
+  pegs_type_t *info = malloc(sizeof(pegs_type_t));
+  assert(info != NULL);
+  *info = type;
+  return info;
+}
+
+pegs_type_t pegs_get_type(body_t *body) {
+  return *(pegs_type_t *)body_get_info(body);
+}
+
+body_t *pegs_add_body(scene_t *scene, shape_t *shape, vector_t centroid,
+                      double mass, color_t color, pegs_type_t type) {
+  body_t *body = body_init_shape_with_info(shape, centroid, mass, color,
+                                           pegs_make_type(type), free);
+  scene_add_body(scene, body);
+  return body;
+}
+
+/** Makes a rectangle of the given length, rotated about its end */
+shape_t *pegs_make_wall(double length, double angle) {
+  vec_array_t *wall = vec_array_init(4);
+  vector_t corners[] = {{0, -PEGS_WALL_WIDTH / 2},
+                        {length, -PEGS_WALL_WIDTH / 2},
+                        {length, PEGS_WALL_WIDTH / 2},
+                        {0, PEGS_WALL_WIDTH / 2}};
+  for (size_t i = 0; i < sizeof(corners) / sizeof(*corners); i++) {
+    vec_array_add(wall, vec_rotate(corners[i], angle));
+  }
+  return shape_from_polygon(wall);
+}
+
+void pegs_add_walls(scene_t *scene) {
+  double angle = atan2(PEGS_ROW_SPACING, PEGS_COL_SPACING / 2);
+  double length = hypot(PEGS_MAX.x / 2, PEGS_MAX.y);
+  vector_t half = vec_multiply(length / 2, (vector_t){cos(angle), sin(angle)});
+
+  shape_t *left = pegs_make_wall(length, angle);
+  pegs_add_body(scene, left, half, INFINITY, PEGS_WALL_COLOR, PEGS_WALL);
+  shape_release(left);
+  shape_t *right = pegs_make_wall(length, M_PI - angle);
+  pegs_add_body(scene, right, (vector_t){PEGS_MAX.x - half.x, half.y},
+                INFINITY, PEGS_WALL_COLOR, PEGS_WALL);
+  shape_release(right);
+
+  // the ground freezes the balls that land on it
+  shape_t *ground = shape_rectangle(PEGS_MAX.x, PEGS_WALL_WIDTH);
+  pegs_add_body(scene, ground, (vector_t){PEGS_MAX.x / 2, PEGS_WALL_WIDTH / 2},
+                INFINITY, PEGS_WALL_COLOR, PEGS_FROZEN);
+  shape_release(ground);
+}
+
+void pegs_add_pegs(scene_t *scene, size_t rows) {
+  shape_t *peg = shape_circle(PEGS_CIRCLE_POINTS, PEGS_PEG_RADIUS);
+  for (size_t row = 1; row <= rows; row++) {
+    for (size_t col = 0; col <= row; col++) {
+      vector_t center = {PEGS_MAX.x / 2 + (col - row * 0.5) * PEGS_COL_SPACING,
+                         PEGS_MAX.y - (row + 1) * PEGS_ROW_SPACING};
+      pegs_add_body(scene, peg, center, INFINITY, PEGS_PEG_COLOR, PEGS_WALL);
+    }
+  }
+  shape_release(peg);
+}
+
+/** Replaces a ball that hit the ground or the pile with a frozen one */
+void pegs_freeze(body_t *ball, body_t *target, vector_t axis, void *aux) {
+  if (body_is_removed(ball)) {
+    return;
+  }
+  body_remove(ball);
+  pegs_t *pegs = aux;
+  body_t *frozen =
+      pegs_add_body(pegs->scene, pegs->ball_shape, body_get_centroid(ball),
+                    PEGS_BALL_MASS, PEGS_BALL_COLOR, PEGS_FROZEN);
+
+  // balls still falling freeze when they land on this one
+  for (size_t i = 0; i < scene_bodies(pegs->scene); i++) {
+    body_t *body = scene_get_body(pegs->scene, i);
+    if (pegs_get_type(body) == PEGS_BALL && !body_is_removed(body)) {
+      create_collision(pegs->scene, body, frozen, pegs_freeze, pegs, NULL);
+    }
+  }
+}
+
+void pegs_drop_ball(pegs_t *pegs) {
+  size_t num_bodies = scene_bodies(pegs->scene);
+  vector_t center = {
+      PEGS_MAX.x / 2 + scenario_random(-0.5, 0.5) * PEGS_DELTA_X,
+      PEGS_MAX.y - PEGS_DROP_HEIGHT};
+  body_t *ball = pegs_add_body(pegs->scene, pegs->ball_shape, center,
+                               PEGS_BALL_MASS, PEGS_BALL_COLOR, PEGS_BALL);
+  body_set_velocity(ball, PEGS_START_VELOCITY);
+
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = scene_get_body(pegs->scene, i);
+    if (body_is_removed(body)) {
+      continue;
+    }
+    switch (pegs_get_type(body)) {
+    case PEGS_BALL:
+      create_physics_collision(pegs->scene, PEGS_BALL_ELASTICITY, ball, body);
+      break;
+    case PEGS_WALL:
+      create_physics_collision(pegs->scene, PEGS_PEG_ELASTICITY, ball, body);
+      break;
+    case PEGS_FROZEN:
+      create_collision(pegs->scene, ball, body, pegs_freeze, pegs, NULL);
+      break;
+    case PEGS_GRAVITY:
+      create_newtonian_gravity(pegs->scene, PEGS_G, body, ball);
+      break;
+    }
+  }
+}
+
+void *pegs_init(scenario_options_t *options) {
+  size_t rows = scenario_option(&options->rows, PEGS_DEFAULT_ROWS);
+  size_t drops = scenario_option(&options->count, PEGS_DEFAULT_COUNT);
+  pegs_t *pegs = malloc(sizeof(pegs_t));
+  assert(pegs != NULL);
+  pegs->scene = scene_init();
+  pegs->ball_shape = shape_circle(PEGS_CIRCLE_POINTS, PEGS_BALL_RADIUS);
+  pegs->drop_interval = 1.0 / drops;
+  pegs->time_since_drop = INFINITY;
+
+  shape_t *earth = shape_rectangle(1, 1);
+  double earth_distance = sqrt(PEGS_G * PEGS_EARTH_MASS / PEGS_EARTH_G);
+  pegs_add_body(pegs->scene, earth, (vector_t){PEGS_MAX.x / 2, -earth_distance},
+                PEGS_EARTH_MASS, PEGS_WALL_COLOR, PEGS_GRAVITY);
+  shape_release(earth);
+  pegs_add_pegs(pegs->scene, rows);
+  pegs_add_walls(pegs->scene);
+  return pegs;
+}
+
+void pegs_update(void *state, double dt) {
+  pegs_t *pegs = state;
+  pegs->time_since_drop += dt;
+  if (pegs->time_since_drop > pegs->drop_interval) {
+    pegs_drop_ball(pegs);
+    pegs->time_since_drop = 0;
+  }
+}
+
+void pegs_tick(void *state, double dt) {
+  scene_tick(((pegs_t *)state)->scene, dt);
+}
+
+scene_t *pegs_get_scene(void *state) { return ((pegs_t *)state)->scene; }
+
+void pegs_free(void *state) {
+  pegs_t *pegs = state;
+  scene_free(pegs->scene);
+  shape_release(pegs->ball_shape);
+  free(pegs);
+}
+
+const scenario_t SCENARIO_PEGS = {
+    .name = "pegs",
+    .usage = "-r peg rows (11), -n balls dropped per second (1)",
+    .init = pegs_init,
+    .update = pegs_update,
+    .tick = pegs_tick,
+    .get_scene = pegs_get_scene,
+    .free = pegs_free,
+};
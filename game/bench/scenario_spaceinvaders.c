@@ -0,0 +1,273 @@
+/**
+ * Space invaders (archive spaceinvaders demo): rows of invaders march across
+ * the window and step down at its edges while the player sweeps back and
+ * forth underneath. The player fires whenever its last bullet is gone, and a
+ * random invader fires every second. A new wave replaces the invaders once
+ * they are all shot or reach the ground; the player never dies.
+ */
+
+#include "forces.h"
+#include "scenario.h"
+#include "shape.h"
+#include "vec_array.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const size_t INVADERS_DEFAULT_ROWS = 3;
+const size_t INVADERS_DEFAULT_COLUMNS = 10;
+// the demo's window, grown if needed to fit the invaders
+const vector_t INVADERS_MIN_WINDOW = {.x = 672, .y = 768};
+const double INVADERS_MARGIN_X = 72;
+const double INVADERS_MARGIN_Y = 500;
+const double INVADERS_PADDING_X = 15;
+const double INVADERS_PADDING_Y = 10;
+const double INVADERS_RADIUS = 22.5;
+const size_t INVADERS_RESOLUTION = 50;
+const double INVADERS_SPEED = 100;
+const double INVADERS_MASS = 1;
+const color_t INVADERS_COLOR = {.r = 1, .g = 1, .b = 1, .a = 1};
+const double INVADERS_BULLET_WIDTH = 6;
+const double INVADERS_BULLET_LENGTH = 10;
+const double INVADERS_BULLET_MASS = 1;
+const double INVADERS_BULLET_SPEED = 400;
+const double INVADERS_BULLET_COOLDOWN = 1;
+const color_t INVADERS_BULLET_COLOR = {.r = 0.7, .g = 0.3, .b = 0.5, .a = 1};
+const double INVADERS_PLAYER_LENGTH = 20;
+const double INVADERS_PLAYER_WIDTH = 40;
+const size_t INVADERS_PLAYER_RESOLUTION = 100;
+const double INVADERS_PLAYER_SPEED = 120;
+const double INVADERS_PLAYER_Y = 30;
+const double INVADERS_PLAYER_MASS = 10;
+const color_t INVADERS_PLAYER_COLOR = {.r = 0, .g = 0, .b = 1, .a = 1};
+
+typedef enum {
+  INVADERS_PLAYER,
+  INVADERS_INVADER,
+  INVADERS_PLAYER_BULLET,
+  INVADERS_INVADER_BULLET
+} invaders_type_t;
+
+typedef struct invaders {
+  scene_t *scene;
+  vector_t window;
+  size_t rows;
+  size_t columns;
+  shape_t *invader_shape;
+  shape_t *bullet_shape;
+  body_t *player;
+  double time_since_shot;
+  list_t *live_invaders;
+} invaders_t;
+
+invaders_type_t invaders_get_type(body_t *body) {
+  return *(invaders_type_t *)body_get_info(body);
+}
+
+body_t *invaders_add_body(invaders_t *invaders, shape_t *shape,
+                          vector_t centroid, double mass, color_t color,
+                          invaders_type_t type) {
+  invaders_type_t *info = malloc(sizeof(invaders_type_t));
+  assert(info != NULL);
+  *info = type;
+  body_t *body =
+      body_init_shape_with_info(shape, centroid, mass, color, info, free);
+  scene_add_body(invaders->scene, body);
+  return body;
+}
+
+/** Makes an invader centered at (0, 0): a dome with a point underneath */
+shape_t *invaders_make_invader(void) {
+  vec_array_t *invader = vec_array_init(INVADERS_RESOLUTION + 1);
+  for (size_t i = 0; i < INVADERS_RESOLUTION; i++) {
+    double angle = M_PI * i / INVADERS_RESOLUTION;
+    vec_array_add(invader, vec_multiply(INVADERS_RADIUS,
+                                        (vector_t){cos(angle), sin(angle)}));
+  }
+  vec_array_add(invader, (vector_t){0, -INVADERS_RADIUS / 2});
+  return shape_from_polygon(invader);
+}
+
+/** Makes the player centered at (0, 0): an ellipse */
+shape_t *invaders_make_player(void) {
+  vec_array_t *player = vec_array_init(INVADERS_PLAYER_RESOLUTION);
+  for (size_t i = 0; i < INVADERS_PLAYER_RESOLUTION; i++) {
+    double angle = 2 * M_PI * i / INVADERS_PLAYER_RESOLUTION;
+    vec_array_add(player, (vector_t){INVADERS_PLAYER_WIDTH * cos(angle),
+                                     INVADERS_PLAYER_LENGTH * sin(angle)});
+  }
+  return shape_from_polygon(player);
+}
+
+void invaders_spawn_wave(invaders_t *invaders) {
+  double step_x = 2 * INVADERS_RADIUS + INVADERS_PADDING_X,
+         step_y = 2 * INVADERS_RADIUS + INVADERS_PADDING_Y;
+  for (size_t row = 0; row < invaders->rows; row++) {
+    for (size_t col = 0; col < invaders->columns; col++) {
+      vector_t center = {
+          INVADERS_PADDING_X + INVADERS_RADIUS + col * step_x,
+          invaders->window.y - INVADERS_PADDING_Y - INVADERS_RADIUS -
+              row * step_y};
+      body_t *invader =
+          invaders_add_body(invaders, invaders->invader_shape, center,
+                            INVADERS_MASS, INVADERS_COLOR, INVADERS_INVADER);
+      body_set_velocity(invader, (vector_t){INVADERS_SPEED, 0});
+    }
+  }
+}
+
+void invaders_bullet_hit_player(body_t *bullet, body_t *player, vector_t axis,
+                                void *aux) {
+  body_remove(bullet);
+}
+
+void invaders_fire(invaders_t *invaders, body_t *shooter,
+                   invaders_type_t type) {
+  bool from_player = type == INVADERS_PLAYER_BULLET;
+  body_t *bullet = invaders_add_body(
+      invaders, invaders->bullet_shape, body_get_centroid(shooter),
+      INVADERS_BULLET_MASS, INVADERS_BULLET_COLOR, type);
+  body_set_velocity(bullet, (vector_t){0, from_player ? INVADERS_BULLET_SPEED
+                                                      : -INVADERS_BULLET_SPEED});
+  if (!from_player) {
+    create_collision(invaders->scene, bullet, invaders->player,
+                     invaders_bullet_hit_player, NULL, NULL);
+    return;
+  }
+  for (size_t i = 0; i < list_size(invaders->live_invaders); i++) {
+    create_destructive_collision(invaders->scene,
+                                 list_get(invaders->live_invaders, i), bullet);
+  }
+}
+
+void *invaders_init(scenario_options_t *options) {
+  invaders_t *invaders = malloc(sizeof(invaders_t));
+  assert(invaders != NULL);
+  invaders->rows = scenario_option(&options->rows, INVADERS_DEFAULT_ROWS);
+  invaders->columns =
+      scenario_option(&options->columns, INVADERS_DEFAULT_COLUMNS);
+  invaders->window = (vector_t){
+      fmax(INVADERS_MIN_WINDOW.x,
+           invaders->columns * (2 * INVADERS_RADIUS + INVADERS_PADDING_X) +
+               INVADERS_MARGIN_X),
+      fmax(INVADERS_MIN_WINDOW.y,
+           invaders->rows * (2 * INVADERS_RADIUS + INVADERS_PADDING_Y) +
+               INVADERS_MARGIN_Y)};
+  invaders->scene = scene_init();
+  invaders->invader_shape = invaders_make_invader();
+  invaders->bullet_shape =
+      shape_rectangle(INVADERS_BULLET_WIDTH, INVADERS_BULLET_LENGTH);
+  invaders->time_since_shot = 0;
+  invaders->live_invaders = list_init(invaders->rows * invaders->columns, NULL);
+
+  shape_t *player_shape = invaders_make_player();
+  invaders->player = invaders_add_body(
+      invaders, player_shape,
+      (vector_t){invaders->window.x / 2, INVADERS_PLAYER_Y},
+      INVADERS_PLAYER_MASS, INVADERS_PLAYER_COLOR, INVADERS_PLAYER);
+  body_set_velocity(invaders->player, (vector_t){INVADERS_PLAYER_SPEED, 0});
+  shape_release(player_shape);
+  invaders_spawn_wave(invaders);
+  return invaders;
+}
+
+/** Marches an invader, turning it around and down at the window's edges */
+void invaders_march(invaders_t *invaders, body_t *invader) {
+  vector_t centroid = body_get_centroid(invader);
+  double velocity = body_get_velocity(invader).x;
+  double margin = INVADERS_RADIUS + INVADERS_PADDING_X;
+  if ((velocity > 0 && centroid.x + margin > invaders->window.x) ||
+      (velocity < 0 && centroid.x - margin < 0)) {
+    body_set_velocity(invader, (vector_t){-velocity, 0});
+    centroid.y -=
+        (2 * INVADERS_RADIUS + INVADERS_PADDING_Y) * invaders->rows;
+    body_set_centroid(invader, centroid);
+  }
+}
+
+void invaders_update(void *state, double dt) {
+  invaders_t *invaders = state;
+  scene_t *scene = invaders->scene;
+  list_clear(invaders->live_invaders);
+  bool player_bullet = false, landed = false;
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (body_is_removed(body)) {
+      continue;
+    }
+    vector_t centroid = body_get_centroid(body);
+    switch (invaders_get_type(body)) {
+    case INVADERS_INVADER:
+      invaders_march(invaders, body);
+      landed = landed || centroid.y - INVADERS_RADIUS <= 0;
+      list_add(invaders->live_invaders, body);
+      break;
+    case INVADERS_PLAYER_BULLET:
+    case INVADERS_INVADER_BULLET:
+      if (centroid.y < 0 || centroid.y > invaders->window.y) {
+        body_remove(body);
+      } else {
+        player_bullet = player_bullet ||
+                        invaders_get_type(body) == INVADERS_PLAYER_BULLET;
+      }
+      break;
+    case INVADERS_PLAYER:
+      break;
+    }
+  }
+
+  if (landed || list_size(invaders->live_invaders) == 0) {
+    for (size_t i = 0; i < list_size(invaders->live_invaders); i++) {
+      body_remove(list_get(invaders->live_invaders, i));
+    }
+    list_clear(invaders->live_invaders);
+    invaders_spawn_wave(invaders);
+    return;
+  }
+
+  // sweep the player from wall to wall
+  body_t *player = invaders->player;
+  double x = body_get_centroid(player).x, velocity = body_get_velocity(player).x;
+  if ((velocity > 0 && x + INVADERS_PLAYER_WIDTH > invaders->window.x) ||
+      (velocity < 0 && x - INVADERS_PLAYER_WIDTH < 0)) {
+    body_set_velocity(player, (vector_t){-velocity, 0});
+  }
+  if (!player_bullet) {
+    invaders_fire(invaders, player, INVADERS_PLAYER_BULLET);
+  }
+
+  invaders->time_since_shot += dt;
+  if (invaders->time_since_shot >= INVADERS_BULLET_COOLDOWN) {
+    size_t shooter = rand() % list_size(invaders->live_invaders);
+    invaders_fire(invaders, list_get(invaders->live_invaders, shooter),
+                  INVADERS_INVADER_BULLET);
+    invaders->time_since_shot = 0;
+  }
+}
+
+void invaders_tick(void *state, double dt) {
+  scene_tick(((invaders_t *)state)->scene, dt);
+}
+
+scene_t *invaders_get_scene(void *state) {
+  return ((invaders_t *)state)->scene;
+}
+
+void invaders_free(void *state) {
+  invaders_t *invaders = state;
+  scene_free(invaders->scene);
+  shape_release(invaders->invader_shape);
+  shape_release(invaders->bullet_shape);
+  list_free(invaders->live_invaders);
+  free(invaders);
+}
+
+const scenario_t SCENARIO_SPACEINVADERS = {
+    .name = "spaceinvaders",
+    .usage = "-r invader rows (3), -c invaders per row (10)",
+    .init = invaders_init,
+    .update = invaders_update,
+    .tick = invaders_tick,
+    .get_scene = invaders_get_scene,
+    .free = invaders_free,
+};
@@ -0,0 +1,176 @@
+/**
+ * Scenario macro-benchmarks: runs the archived demos headless on the current
+ * library and reports how long each phase of a tick takes.
+ *
+ * Usage: bin/scenarios <scenario|all> [-t ticks] [-s seed] [-o csv]
+ *                      [-n count] [-r rows] [-c columns]
+ *
+ * Every tick runs three timed phases: "update" (the scenario's game logic),
+ * "physics" (forces and integration) and "render" (scene_render() and
+ * sdl_show() on the null renderer). Results go to stderr as a table and to
+ * a CSV file (stdout by default).
+ */
+
+#include "bench.h"
+#include "scenario.h"
+#include "sdl_wrapper.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+const size_t SCENARIO_DEFAULT_TICKS = 1000;
+const double SCENARIO_DT = 0.01;
+const double SCENARIO_NS_PER_US = 1e3;
+
+const scenario_t *const SCENARIOS[] = {
+    &SCENARIO_NBODIES,  &SCENARIO_DAMPING,       &SCENARIO_PEGS,
+    &SCENARIO_BREAKOUT, &SCENARIO_SPACEINVADERS, &SCENARIO_PACMAN,
+};
+const size_t NUM_SCENARIOS = sizeof(SCENARIOS) / sizeof(*SCENARIOS);
+
+typedef enum {
+  PHASE_UPDATE,
+  PHASE_PHYSICS,
+  PHASE_RENDER,
+  PHASE_TOTAL,
+  NUM_PHASES
+} scenario_phase_t;
+
+const char *const SCENARIO_PHASE_NAMES[] = {"update", "physics", "render",
+                                            "total"};
+
+double scenario_random(double low, double high) {
+  return low + (high - low) * rand() / RAND_MAX;
+}
+
+size_t scenario_option(size_t *value, size_t fallback) {
+  if (*value == 0) {
+    *value = fallback;
+  }
+  return *value;
+}
+
+void scenario_usage(const char *program) {
+  fprintf(stderr,
+          "usage: %s <scenario|all> [-t ticks] [-s seed] [-o csv] "
+          "[-n count] [-r rows] [-c columns]\n",
+          program);
+  for (size_t i = 0; i < NUM_SCENARIOS; i++) {
+    fprintf(stderr, "  %-14s %s\n", SCENARIOS[i]->name, SCENARIOS[i]->usage);
+  }
+  exit(2);
+}
+
+/** Runs a scenario and writes a CSV row per phase */
+void scenario_run(const scenario_t *scenario, scenario_options_t options,
+                  size_t ticks, FILE *csv) {
+  void *state = scenario->init(&options);
+  scene_t *scene = scenario->get_scene(state);
+  double *samples[NUM_PHASES];
+  for (size_t phase = 0; phase < NUM_PHASES; phase++) {
+    samples[phase] = malloc(sizeof(double) * ticks);
+    assert(samples[phase] != NULL);
+  }
+
+  for (size_t tick = 0; tick < ticks; tick++) {
+    double start = bench_now();
+    scenario->update(state, SCENARIO_DT);
+    double updated = bench_now();
+    scenario->tick(state, SCENARIO_DT);
+    double ticked = bench_now();
+    scene_render(scene);
+    sdl_show();
+    double rendered = bench_now();
+    samples[PHASE_UPDATE][tick] = updated - start;
+    samples[PHASE_PHYSICS][tick] = ticked - updated;
+    samples[PHASE_RENDER][tick] = rendered - ticked;
+    samples[PHASE_TOTAL][tick] = rendered - start;
+  }
+  size_t bodies = scene_bodies(scene);
+
+  for (size_t phase = 0; phase < NUM_PHASES; phase++) {
+    bench_summary_t summary = bench_summarize(samples[phase], ticks);
+    fprintf(csv, "%s,%zu,%zu,%zu,%zu,%zu,%s,%.2f,%.2f,%.2f\n",
+            scenario->name, options.count, options.rows, options.columns,
+            ticks, bodies, SCENARIO_PHASE_NAMES[phase],
+            summary.median / SCENARIO_NS_PER_US,
+            summary.p99 / SCENARIO_NS_PER_US,
+            summary.mean / SCENARIO_NS_PER_US);
+    fprintf(stderr, "%-14s %-8s %12.2f %12.2f %12.2f\n", scenario->name,
+            SCENARIO_PHASE_NAMES[phase], summary.median / SCENARIO_NS_PER_US,
+            summary.p99 / SCENARIO_NS_PER_US,
+            summary.mean / SCENARIO_NS_PER_US);
+    free(samples[phase]);
+  }
+  fprintf(stderr, "%-14s %zu ticks, %zu bodies at the end\n", scenario->name,
+          ticks, bodies);
+  scenario->free(state);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2 || argv[1][0] == '-') {
+    scenario_usage(argv[0]);
+  }
+  const char *name = argv[1];
+  size_t ticks = SCENARIO_DEFAULT_TICKS;
+  unsigned seed = 0;
+  scenario_options_t options = {0};
+  FILE *csv = stdout;
+  // skip the scenario name
+  optind = 2;
+  int opt;
+  while ((opt = getopt(argc, argv, "t:s:o:n:r:c:")) != -1) {
+    switch (opt) {
+    case 't':
+      ticks = strtoul(optarg, NULL, 10);
+      break;
+    case 's':
+      seed = strtoul(optarg, NULL, 10);
+      break;
+    case 'o':
+      csv = fopen(optarg, "w");
+      if (csv == NULL) {
+        perror(optarg);
+        return 1;
+      }
+      break;
+    case 'n':
+      options.count = strtoul(optarg, NULL, 10);
+      break;
+    case 'r':
+      options.rows = strtoul(optarg, NULL, 10);
+      break;
+    case 'c':
+      options.columns = strtoul(optarg, NULL, 10);
+      break;
+    default:
+      scenario_usage(argv[0]);
+    }
+  }
+  if (ticks == 0) {
+    scenario_usage(argv[0]);
+  }
+
+  bool all = strcmp(name, "all") == 0, found = false;
+  fprintf(csv, "scenario,count,rows,columns,ticks,bodies,phase,median_us,"
+               "p99_us,mean_us\n");
+  fprintf(stderr, "%-14s %-8s %12s %12s %12s\n", "scenario", "phase",
+          "median us", "p99 us", "mean us");
+  for (size_t i = 0; i < NUM_SCENARIOS; i++) {
+    if (all || strcmp(name, SCENARIOS[i]->name) == 0) {
+      found = true;
+      srand(seed);
+      scenario_run(SCENARIOS[i], options, ticks, csv);
+    }
+  }
+  if (csv != stdout) {
+    fclose(csv);
+  }
+  if (!found) {
+    fprintf(stderr, "unknown scenario: %s\n", name);
+    scenario_usage(argv[0]);
+  }
+  return 0;
+}
@@ -2,12 +2,16 @@
 #include "text.h"
 #include "collision.h"
 #include "color.h"
+#include "food_field.h"
 #include "forces.h"
 #include "list.h"
+#include "metrics.h"
 #include "polygon.h"
+#include "pool.h"
 #include "scene.h"
 #include "sdl_wrapper.h"
 #include "state.h"
+#include "trace.h"
 #include "vector.h"
 #include "player.h"
 #include "utils.h"
@@ -39,11 +43,27 @@ const size_t WALL_RIGHT_BODIES_INDEX = 4;
 const double WALL_IMPULSE = 80000;
 const color_t WALL_COLOR = (color_t){.r = 0.3, .g = 0.3, .b = 0.3, .a = 1};
 
+// layer constants, used to filter scene queries
+const uint32_t LAYER_WALL = 1 << 1;
+const uint32_t LAYER_BULLET = 1 << 2;
+// room for the bodies of one query, so queries during play don't allocate
+const size_t QUERY_RESULTS_CAPACITY = 64;
+
 // game constants
 const size_t GAME_NUM_PLAYERS = 4;
 const double PLAYER_COLLISION_IMPULSE = 100;
 const size_t INFO_MAX_LEN = 100;
 const double dt = 0.01;
+// toggles the game's dev mode, which shows the profiler HUD
+const char DEV_MODE_KEY = '`';
+// in dev mode, prints the engine's metrics as JSON
+const char METRICS_KEY = '/';
+// in dev mode, starts tracing, or dumps the trace and stops
+const char TRACE_KEY = '.';
+const char *TRACE_DUMP_PATH = "slyce-trace.json";
+// while tracing, frames slower than this are also dumped on their own
+const double TRACE_SLOW_FRAME_MS = 50;
+const char *TRACE_SLOW_FRAME_PREFIX = "slyce-slow";
 
 // color constants
 const color_t COLOR_WHITE = (color_t) {1, 1, 1, 1};
@@ -105,17 +125,30 @@ const double FOOD_SPAWN_TIME = 5;
 const time_t FOOD_FLASH_FREQUENCY = 1;
 const color_t FOOD_COLOR = (color_t){.r = 1, .g = 0.72, .b = 0.69, .a = 1};
 const size_t PTS_IN_PELLET = 4;
+const double FOOD_CELL_SIZE = 50;
+
+// powerup constants, indexed by pellet type
+#define PU_NUM_TYPES 4
+char *const PU_TYPES[PU_NUM_TYPES] = {"pu_base_speed", "pu_bullet_speed",
+                                      "pu_rotate_rate", "pu_dash_boost"};
+const color_t PU_COLORS[PU_NUM_TYPES] = {
+    (color_t){.r = 0.3, .b = 1, .g = 1, .a = 1},
+    (color_t){.r = 0.5, .b = 1, .g = 0.1, .a = 1},
+    (color_t){.r = 1, .b = 0.9, .g = 0, .a = 1},
+    (color_t){.r = 1, .b = 0, .g = 0.9, .a = 1}};
 
 // sound constants
 const int FREE_CHANNEL = -1;
 const int SECONDARY_CHANNEL = 0;
 const int REPEATED_SOUND_CHANNEL = 1;
+const int LOOP_FOREVER = -1;
 
 // state def
 typedef struct state
 {
   scene_t *scene_game;
   scene_t *scene_menu;
+  food_field_t *food;
   text_t *timer;
   bool sound_playing;
   list_t *players;
@@ -125,27 +158,44 @@ typedef struct state
   double time_since_dash;
   double game_time;
   double time_since_pellet_spawn;
+  // scratch list for scene queries, cleared before each one
+  list_t *query_results;
 } state_t;
 
-list_t *make_left_wall()
+// the arena and its walls, for queries over everything in play
+aabb_t arena_box()
+{
+  vector_t margin = (vector_t){WALL_THICKNESS, WALL_THICKNESS};
+  return (aabb_t){.min = vec_subtract(MIN_POSITION, margin), .max = vec_add(WINDOW, margin)};
+}
+
+// finds every body in the arena on the given layers, in state->query_results
+list_t *query_arena(state_t *state, uint32_t mask)
+{
+  list_clear(state->query_results);
+  scene_query_aabb(state->scene_game, arena_box(), mask, state->query_results);
+  return state->query_results;
+}
+
+vec_array_t *make_left_wall()
 {
   return make_rectangle(WALL_THICKNESS, WINDOW.y,
                         (vector_t){-0.5 * WALL_THICKNESS, CENTER.y});
 }
 
-list_t *make_bottom_wall()
+vec_array_t *make_bottom_wall()
 {
   return make_rectangle(WINDOW.x, WALL_THICKNESS,
                         (vector_t){CENTER.x, -0.5 * WALL_THICKNESS});
 }
 
-list_t *make_top_wall()
+vec_array_t *make_top_wall()
 {
   return make_rectangle(WINDOW.x, WALL_THICKNESS,
                         (vector_t){CENTER.x, WINDOW.y + 0.5 * WALL_THICKNESS});
 }
 
-list_t *make_right_wall()
+vec_array_t *make_right_wall()
 {
   return make_rectangle(WALL_THICKNESS, WINDOW.y,
                         (vector_t){WINDOW.x + 0.5 * WALL_THICKNESS, CENTER.y});
@@ -153,12 +203,9 @@ list_t *make_right_wall()
 
 void wall_collision_handler(body_t *body1, body_t *body2, vector_t axis, void *aux)
 {
-  list_t *shape1 = body_get_shape(body1);
-  list_t *shape2 = body_get_shape(body2);
-  if (find_collision(shape1, shape2).collided)
+  if (body_find_collision(body1, body2).collided)
   {
-    char *info = malloc(sizeof(char) * INFO_MAX_LEN);
-    strcpy(info, list_get((list_t *)body_get_info(body2), 0));
+    char *info = list_get((list_t *)body_get_info(body2), 0);
     if (strcmp(info, "wall_top") == 0)
     {
       vector_t velocity = (vector_t){.x = 0, .y = -WALL_IMPULSE};
@@ -180,8 +227,6 @@ void wall_collision_handler(body_t *body1, body_t *body2, vector_t axis, void *a
       body_add_impulse(body1, velocity);
     }
   }
-  list_free(shape1);
-  list_free(shape2);
 }
 
 void player_collision_handler(body_t *body1, body_t *body2, vector_t axis, void *aux)
@@ -195,9 +240,7 @@ void player_collision_handler(body_t *body1, body_t *body2, vector_t axis, void
     size_t player_id2 = *((size_t *)list_get((list_t *)body_get_info(body2), 1));
     player_t *p1 = list_get(state->players, player_id1);
     player_t *p2 = list_get(state->players, player_id2);
-    list_t *body1_pts = body_get_shape(body1);
-    list_t *body2_pts = body_get_shape(body2);
-    if (find_collision(body1_pts, body2_pts).collided && p1->cd_collide_player <= 0 && p2->cd_collide_player <= 0)
+    if (body_find_collision(body1, body2).collided && p1->cd_collide_player <= 0 && p2->cd_collide_player <= 0)
     {
       vector_t head_velocity = body_get_velocity(body1);
       vector_t body_velocity = body_get_velocity(body2);
@@ -213,10 +256,8 @@ void player_collision_handler(body_t *body1, body_t *body2, vector_t axis, void
       body_add_impulse(body2, impulse_on_body);
       player_refresh_cd_collide_player(p1);
       player_refresh_cd_collide_player(p2);
-      sdl_play_sound(FREE_CHANNEL, "assets/collide.wav", 0);
+      sdl_play_sound(FREE_CHANNEL, SOUND_COLLIDE, 0);
     }
-    list_free(body1_pts);
-    list_free(body2_pts);
   }
 }
 
@@ -226,10 +267,7 @@ void bullet_collision_handler(body_t *body1, body_t *body2, vector_t axis,
   state_t *state = (state_t *)aux;
   size_t bullet_player_id = *((size_t *)list_get((list_t *)body_get_info(body1), 1));
   char *body_impacted_type = list_get((list_t *)body_get_info(body2), 0);
-  list_t *bullet_pts = body_get_shape(body1);
-  list_t *impact_pts = body_get_shape(body2);
-
-  if (find_collision(bullet_pts, impact_pts).collided)
+  if (body_find_collision(body1, body2).collided)
   {
     if (strcmp(body_impacted_type, "wall_top") == 0 || strcmp(body_impacted_type, "wall_bottom") == 0 ||
         strcmp(body_impacted_type, "wall_left") == 0 || strcmp(body_impacted_type, "wall_right") == 0)
@@ -245,116 +283,74 @@ void bullet_collision_handler(body_t *body1, body_t *body2, vector_t axis,
       body_remove(body1);
     }
   }
-  list_free(bullet_pts);
-  list_free(impact_pts);
 }
 
-void pellet_collision_handler(body_t *body1, body_t *body2, vector_t axis,
-                              void *aux)
+typedef struct pellet_pickup
 {
-  list_t *aux_casted = (list_t *)aux;
-  state_t *state = list_get(aux_casted, 0);
-  player_t *player = list_get(aux_casted, 1);
-  list_t *snake_pts = body_get_shape(body1);
-  list_t *food_pts = body_get_shape(body2);
+  state_t *state;
+  player_t *player;
+} pellet_pickup_t;
 
-  if (find_collision(snake_pts, food_pts).collided)
-  {
-    player_eat(player, body2, state->scene_game);
-    body_t *added_body = player_add_body(player);
-    scene_add_body(state->scene_game, added_body);
-    create_drag(state->scene_game, DRAG_CONST, list_get(player->meta_bodies, list_size(player->meta_bodies) - 1));
-    create_spring(state->scene_game, SPRING_CONST, list_get(player->meta_bodies, list_size(player->meta_bodies) - 1), list_get(player->meta_bodies, list_size(player->meta_bodies) - 2));
-    for (size_t i = 0; i < GAME_NUM_PLAYERS; i++)
-    { // add collisions between added body and other player heads
-      if (list_get(state->players, i) != player)
-      {
-        body_t *player_head = player_get_head(list_get(state->players, i));
-        create_collision(state->scene_game, player_head, added_body, player_collision_handler, state, NULL);
-      }
+void pellet_pickup_handler(food_t food, void *aux)
+{
+  pellet_pickup_t *pickup = (pellet_pickup_t *)aux;
+  state_t *state = pickup->state;
+  player_t *player = pickup->player;
+
+  player_eat(player, PU_TYPES[food.type], state->scene_game);
+  body_t *added_body = player_add_body(player);
+  scene_add_body(state->scene_game, added_body);
+  create_drag(state->scene_game, DRAG_CONST, list_get(player->meta_bodies, list_size(player->meta_bodies) - 1));
+  create_spring(state->scene_game, SPRING_CONST, list_get(player->meta_bodies, list_size(player->meta_bodies) - 1), list_get(player->meta_bodies, list_size(player->meta_bodies) - 2));
+  for (size_t i = 0; i < GAME_NUM_PLAYERS; i++)
+  { // add collisions between added body and other player heads
+    if (list_get(state->players, i) != player)
+    {
+      body_t *player_head = player_get_head(list_get(state->players, i));
+      create_collision(state->scene_game, player_head, added_body, player_collision_handler, state, NULL);
     }
-    for (size_t i = 0; i < scene_bodies(state->scene_game); i++) // add collisions between added body and existing bullets
+  }
+  list_t *bullets = query_arena(state, LAYER_BULLET);
+  for (size_t i = 0; i < list_size(bullets); i++) // add collisions between added body and existing bullets
+  {
+    body_t *bullet = list_get(bullets, i);
+    size_t bullet_player_id = *((size_t *)list_get((list_t *)body_get_info(bullet), 1));
+    if (bullet_player_id != player->player_id)
     {
-      body_t *curr_body = scene_get_body(state->scene_game, i);
-      char *body_type = list_get((list_t *)body_get_info(curr_body), 0);
-      if (strcmp(body_type, "bullet") == 0) // if its a bullet
-      {
-        size_t curr_body_player_id = *((size_t *)list_get((list_t *)body_get_info(curr_body), 1));
-        if (curr_body_player_id != player->player_id)
-        {
-          create_collision(state->scene_game, curr_body, added_body, bullet_collision_handler, state, NULL);
-        }
-      }
+      create_collision(state->scene_game, bullet, added_body, bullet_collision_handler, state, NULL);
     }
-    body_remove(body2);
   }
-  list_free(snake_pts);
-  list_free(food_pts);
 }
 
-list_t *get_pu_types()
+void spawn_pellet(state_t *state)
 {
-  list_t *pu_types = list_init(4, free);
-  list_add(pu_types, "pu_base_speed");
-  list_add(pu_types, "pu_bullet_speed");
-  list_add(pu_types, "pu_rotate_rate");
-  list_add(pu_types, "pu_dash_boost");
-  return pu_types;
-}
-
-list_t *get_pu_colors()
-{
-  list_t *pu_colors = list_init(4, free);
-  color_t *color1 = malloc(sizeof(color_t));
-  color_t *color2 = malloc(sizeof(color_t));
-  color_t *color3 = malloc(sizeof(color_t));
-  color_t *color4 = malloc(sizeof(color_t));
-  *color1 = (color_t){.r = 0.3, .b = 1, .g = 1, .a = 1};
-  *color2 = (color_t){.r = 0.5, .b = 1, .g = 0.1, .a = 1};
-  *color3 = (color_t){.r = 1, .b = 0.9, .g = 0, .a = 1};
-  *color4 = (color_t){.r = 1, .b = 0, .g = 0.9, .a = 1};
-  list_add(pu_colors, color1);
-  list_add(pu_colors, color2);
-  list_add(pu_colors, color3);
-  list_add(pu_colors, color4);
-  return pu_colors;
+  vector_t pellet_pos = (vector_t){.x = (double)rand_range(MIN_POSITION.x, WINDOW.x), .y = (double)rand_range(MIN_POSITION.y, WINDOW.y)};
+  size_t pellet_type = (size_t)(rand_range(0, 1) * PU_NUM_TYPES) % PU_NUM_TYPES;
+  food_field_add(state->food, pellet_pos, pellet_type);
 }
 
-void spawn_pellet(state_t *state, list_t *pu_types, list_t *pu_colors)
+// each choice body frees its own info, so each gets its own copy of the id
+size_t *color_choice_id(size_t player_id)
 {
-  vector_t pellet_pos = (vector_t){.x = (double)rand_range(MIN_POSITION.x, WINDOW.x), .y = (double)rand_range(MIN_POSITION.y, WINDOW.y)};
-  size_t pellet_type = (size_t)(rand_range(0, 1) * 4);
-  list_t *info = list_init(2, free);
-  char *body_type = malloc(sizeof(char) * INFO_MAX_LEN);
-  char *pu_type = malloc(sizeof(char) * INFO_MAX_LEN);
-  strcpy(body_type, "food\0");
-  strcpy(pu_type, (char *)list_get(pu_types, pellet_type));
-  list_add(info, body_type);
-  list_add(info, pu_type);
-  body_t *food = body_init_with_info(make_circle(6, FOOD_SIDE_LENGTH, pellet_pos), 1, *((color_t *)list_get(pu_colors, pellet_type)), info, list_free);
-  body_set_glow(food, true);
-  body_set_glow_radius(food, FOOD_SIDE_LENGTH);
-  scene_add_body(state->scene_game, food);
-  for (size_t k = 0; k < GAME_NUM_PLAYERS; k++)
-  {
-    list_t *aux = list_init(2, NULL);
-    list_add(aux, state);
-    list_add(aux, list_get(state->players, k));
-    create_collision(state->scene_game, player_get_head(list_get(state->players, k)), food, pellet_collision_handler, aux, NULL);
-  }
+  size_t *id = malloc(sizeof(size_t));
+  assert(id != NULL);
+  *id = player_id;
+  return id;
 }
 
-void spawn_color_choices(state_t *state, size_t *player_id, vector_t center, color_t c1, color_t c2, color_t c3, color_t c4)
+void spawn_color_choices(state_t *state, size_t player_id, vector_t center, color_t c1, color_t c2, color_t c3, color_t c4)
 {
   vector_t choice1_pos = vec_add(center, (vector_t){-30, 30});
   vector_t choice2_pos = vec_add(center, (vector_t){30, 30});
   vector_t choice3_pos = vec_add(center, (vector_t){-30, -30});
   vector_t choice4_pos = vec_add(center, (vector_t){30, -30});
 
-  body_t *choice1 = body_init_with_info(make_rectangle(CHOICE_SIZE, CHOICE_SIZE, choice1_pos), CHOICE_MASS, c1, player_id, free);
-  body_t *choice2 = body_init_with_info(make_rectangle(CHOICE_SIZE, CHOICE_SIZE, choice2_pos), CHOICE_MASS, c2, player_id, free);
-  body_t *choice3 = body_init_with_info(make_rectangle(CHOICE_SIZE, CHOICE_SIZE, choice3_pos), CHOICE_MASS, c3, player_id, free);
-  body_t *choice4 = body_init_with_info(make_rectangle(CHOICE_SIZE, CHOICE_SIZE, choice4_pos), CHOICE_MASS, c4, player_id, free);
+  shape_t *choice_shape = shape_rectangle(CHOICE_SIZE, CHOICE_SIZE);
+  body_t *choice1 = body_init_shape_with_info(choice_shape, choice1_pos, CHOICE_MASS, c1, color_choice_id(player_id), free);
+  body_t *choice2 = body_init_shape_with_info(choice_shape, choice2_pos, CHOICE_MASS, c2, color_choice_id(player_id), free);
+  body_t *choice3 = body_init_shape_with_info(choice_shape, choice3_pos, CHOICE_MASS, c3, color_choice_id(player_id), free);
+  body_t *choice4 = body_init_shape_with_info(choice_shape, choice4_pos, CHOICE_MASS, c4, color_choice_id(player_id), free);
+  shape_release(choice_shape);
 
   scene_add_body(state->scene_menu, choice1);
   scene_add_body(state->scene_menu, choice2);
@@ -365,6 +361,7 @@ void spawn_color_choices(state_t *state, size_t *player_id, vector_t center, col
 void game_init(state_t *state)
 {
   state->scene_game = scene_init();
+  state->food = food_field_init(MIN_POSITION, WINDOW, FOOD_CELL_SIZE, FOOD_SIDE_LENGTH, PU_COLORS, PU_NUM_TYPES);
   state->game_started = true;
 
   for (size_t i = 0; i < GAME_NUM_PLAYERS; i++)
@@ -415,43 +412,44 @@ void game_init(state_t *state)
   }
 
   // spawn random food
-  list_t *pu_types = get_pu_types();
-  list_t *pu_colors = get_pu_colors();
-
   for (size_t i = 0; i < FOOD_COUNT_INITIAL; i++)
   {
-    spawn_pellet(state, pu_types, pu_colors);
+    spawn_pellet(state);
   }
 
   // initialize walls
-  list_t *wall_left_pts = make_left_wall();
+  vec_array_t *wall_left_pts = make_left_wall();
   list_t *wall_left_info = list_init(1, free);
   char *wall_left_name = malloc(sizeof(char) * INFO_MAX_LEN);
-  wall_left_name = "wall_left";
+  strcpy(wall_left_name, "wall_left");
   list_add(wall_left_info, wall_left_name);
 
-  list_t *wall_top_pts = make_top_wall();
+  vec_array_t *wall_top_pts = make_top_wall();
   list_t *wall_top_info = list_init(1, free);
   char *wall_top_name = malloc(sizeof(char) * INFO_MAX_LEN);
-  wall_top_name = "wall_top";
+  strcpy(wall_top_name, "wall_top");
   list_add(wall_top_info, wall_top_name);
 
-  list_t *wall_right_pts = make_right_wall();
+  vec_array_t *wall_right_pts = make_right_wall();
   list_t *wall_right_info = list_init(1, free);
   char *wall_right_name = malloc(sizeof(char) * INFO_MAX_LEN);
-  wall_right_name = "wall_right";
+  strcpy(wall_right_name, "wall_right");
   list_add(wall_right_info, wall_right_name);
 
-  list_t *wall_bottom_pts = make_bottom_wall();
+  vec_array_t *wall_bottom_pts = make_bottom_wall();
   list_t *wall_bottom_info = list_init(1, free);
   char *wall_bottom_name = malloc(sizeof(char) * INFO_MAX_LEN);
-  wall_bottom_name = "wall_bottom";
+  strcpy(wall_bottom_name, "wall_bottom");
   list_add(wall_bottom_info, wall_bottom_name);
 
-  body_t *wall_left = body_init_with_info(wall_left_pts, WALL_MASS, WALL_COLOR, wall_left_info, NULL);
-  body_t *wall_top = body_init_with_info(wall_top_pts, WALL_MASS, WALL_COLOR, wall_top_info, NULL);
-  body_t *wall_right = body_init_with_info(wall_right_pts, WALL_MASS, WALL_COLOR, wall_right_info, NULL);
-  body_t *wall_bottom = body_init_with_info(wall_bottom_pts, WALL_MASS, WALL_COLOR, wall_bottom_info, NULL);
+  body_t *wall_left = body_init_with_info(wall_left_pts, WALL_MASS, WALL_COLOR, wall_left_info, list_free);
+  body_t *wall_top = body_init_with_info(wall_top_pts, WALL_MASS, WALL_COLOR, wall_top_info, list_free);
+  body_t *wall_right = body_init_with_info(wall_right_pts, WALL_MASS, WALL_COLOR, wall_right_info, list_free);
+  body_t *wall_bottom = body_init_with_info(wall_bottom_pts, WALL_MASS, WALL_COLOR, wall_bottom_info, list_free);
+  body_set_layer(wall_left, LAYER_WALL);
+  body_set_layer(wall_top, LAYER_WALL);
+  body_set_layer(wall_right, LAYER_WALL);
+  body_set_layer(wall_bottom, LAYER_WALL);
 
   scene_add_body(state->scene_game, wall_left);
   scene_add_body(state->scene_game, wall_top);
@@ -474,10 +472,15 @@ void game_init(state_t *state)
   }
 
   // summon player keybind titles
-  char player1_help_text[INFO_MAX_LEN] = "Q W E R";
-  char player2_help_text[INFO_MAX_LEN] = "U I O P";
-  char player3_help_text[INFO_MAX_LEN] = "Z X C V";
-  char player4_help_text[INFO_MAX_LEN] = "B N M <";
+  // the texts own their strings, so they can't live on the stack
+  char *player1_help_text = malloc(sizeof(char) * INFO_MAX_LEN);
+  char *player2_help_text = malloc(sizeof(char) * INFO_MAX_LEN);
+  char *player3_help_text = malloc(sizeof(char) * INFO_MAX_LEN);
+  char *player4_help_text = malloc(sizeof(char) * INFO_MAX_LEN);
+  strcpy(player1_help_text, "Q W E R");
+  strcpy(player2_help_text, "U I O P");
+  strcpy(player3_help_text, "Z X C V");
+  strcpy(player4_help_text, "B N M <");
 
   color_t player1_color = ((player_t *) list_get(state->players, 0))->st_color;
   color_t player2_color = ((player_t *) list_get(state->players, 1))->st_color;
@@ -561,29 +564,52 @@ void menu_init(state_t *state)
   scene_add_text(state->scene_menu, start_button);
   scene_add_text(state->scene_menu, help);
 
-  size_t *p1_id = malloc(sizeof(size_t));
-  size_t *p2_id = malloc(sizeof(size_t));
-  size_t *p3_id = malloc(sizeof(size_t));
-  size_t *p4_id = malloc(sizeof(size_t));
-  *p1_id = 0;
-  *p2_id = 1;
-  *p3_id = 2;
-  *p4_id = 3;
-
-  spawn_color_choices(state, p1_id, vec_add(player1_title_pos, CHOICE_SPAWN_POSITION), COLOR_PLAYER1_CHOICE1, COLOR_PLAYER1_CHOICE2, COLOR_PLAYER1_CHOICE3, COLOR_PLAYER1_CHOICE4);
-  spawn_color_choices(state, p2_id, vec_add(player2_title_pos, CHOICE_SPAWN_POSITION), COLOR_PLAYER2_CHOICE1, COLOR_PLAYER2_CHOICE2, COLOR_PLAYER2_CHOICE3, COLOR_PLAYER2_CHOICE4);
-  spawn_color_choices(state, p3_id, vec_add(player3_title_pos, CHOICE_SPAWN_POSITION), COLOR_PLAYER3_CHOICE1, COLOR_PLAYER3_CHOICE2, COLOR_PLAYER3_CHOICE3, COLOR_PLAYER3_CHOICE4);
-  spawn_color_choices(state, p4_id, vec_add(player4_title_pos, CHOICE_SPAWN_POSITION), COLOR_PLAYER4_CHOICE1, COLOR_PLAYER4_CHOICE2, COLOR_PLAYER4_CHOICE3, COLOR_PLAYER4_CHOICE4);
+
+  spawn_color_choices(state, 0, vec_add(player1_title_pos, CHOICE_SPAWN_POSITION), COLOR_PLAYER1_CHOICE1, COLOR_PLAYER1_CHOICE2, COLOR_PLAYER1_CHOICE3, COLOR_PLAYER1_CHOICE4);
+  spawn_color_choices(state, 1, vec_add(player2_title_pos, CHOICE_SPAWN_POSITION), COLOR_PLAYER2_CHOICE1, COLOR_PLAYER2_CHOICE2, COLOR_PLAYER2_CHOICE3, COLOR_PLAYER2_CHOICE4);
+  spawn_color_choices(state, 2, vec_add(player3_title_pos, CHOICE_SPAWN_POSITION), COLOR_PLAYER3_CHOICE1, COLOR_PLAYER3_CHOICE2, COLOR_PLAYER3_CHOICE3, COLOR_PLAYER3_CHOICE4);
+  spawn_color_choices(state, 3, vec_add(player4_title_pos, CHOICE_SPAWN_POSITION), COLOR_PLAYER4_CHOICE1, COLOR_PLAYER4_CHOICE2, COLOR_PLAYER4_CHOICE3, COLOR_PLAYER4_CHOICE4);
 }
 
 void keyboard_handler(state_t *state, char key, key_event_type_t type, double held_time)
 {
   if (!state->sound_playing)
   {
-    sdl_play_sound(SECONDARY_CHANNEL, "assets/soundtrack.wav", INFINITY);
+    sdl_play_sound(SECONDARY_CHANNEL, SOUND_SOUNDTRACK, LOOP_FOREVER);
     state->sound_playing = true;
   }
 
+  if (type == KEY_PRESSED && key == DEV_MODE_KEY && state->game_started)
+  {
+    scene_set_dev_mode(state->scene_game, !scene_get_dev_mode(state->scene_game));
+    return;
+  }
+  if (type == KEY_PRESSED && key == METRICS_KEY && state->game_started && scene_get_dev_mode(state->scene_game))
+  {
+    metrics_snapshot_t total = metrics_get_total();
+    metrics_write_json(stdout, &total);
+    printf("\n");
+    return;
+  }
+  if (type == KEY_PRESSED && key == TRACE_KEY && state->game_started && scene_get_dev_mode(state->scene_game))
+  {
+    if (tick_tracer() == NULL)
+    {
+      tick_tracer_set_enabled(true);
+      tracer_set_slow_frame(tick_tracer(), TRACE_SLOW_FRAME_MS, TRACE_SLOW_FRAME_PREFIX);
+      printf("tracing\n");
+    }
+    else
+    {
+      if (tracer_dump(tick_tracer(), TRACE_DUMP_PATH))
+      {
+        printf("trace written to %s\n", TRACE_DUMP_PATH);
+      }
+      tick_tracer_set_enabled(false);
+    }
+    return;
+  }
+
   if (state->game_started)
   {
     player_t *p = NULL;
@@ -631,15 +657,12 @@ void keyboard_handler(state_t *state, char key, key_event_type_t type, double he
     else if (type == 0 && p->st_shoot_key == key && p->cd_shoot == 0)
     {
       body_t *bullet = player_shoot(p);
-      for (size_t i = 0; i < scene_bodies(state->scene_game); i++) // create bullet collision with walls
+      body_set_layer(bullet, LAYER_BULLET);
+      // every wall, since a bullet spawned on or past a wall's edge is not in front of it
+      list_t *walls = query_arena(state, LAYER_WALL);
+      for (size_t i = 0; i < list_size(walls); i++) // create bullet collisions with walls
       {
-        list_t *body_info = (list_t *)body_get_info(scene_get_body(state->scene_game, i));
-        char *body_type = list_get(body_info, 0);
-
-        if (strcmp(body_type, "wall_top") == 0 || strcmp(body_type, "wall_bottom") == 0 || strcmp(body_type, "wall_left") == 0 || strcmp(body_type, "wall_right") == 0)
-        {
-          create_collision(state->scene_game, bullet, scene_get_body(state->scene_game, i), bullet_collision_handler, state, NULL);
-        }
+        create_collision(state->scene_game, bullet, list_get(walls, i), bullet_collision_handler, state, NULL);
       }
       for (size_t i = 0; i < list_size(state->players); i++) // create bullet collisions with player bodies
       {
@@ -668,13 +691,13 @@ void keyboard_handler(state_t *state, char key, key_event_type_t type, double he
         strcpy(error_text, "All players must select colors!");
 
         text_t *error = text_init(error_text, vec_add(CENTER, (vector_t){0, -300}), ERROR_TEXT_HEIGHT, ERROR_TEXT_WIDTH, ERROR_COLOR, ERROR_DURATION);
-        sdl_play_sound(REPEATED_SOUND_CHANNEL, "assets/menu_error.wav", 2);
+        sdl_play_sound(REPEATED_SOUND_CHANNEL, SOUND_MENU_ERROR, 2);
         scene_add_text(state->scene_menu, error);
         return;
       }
     }
     game_init(state);
-    sdl_play_sound(FREE_CHANNEL, "assets/game_start.wav", 1);
+    sdl_play_sound(FREE_CHANNEL, SOUND_GAME_START, 1);
   }
 }
 // emscripten: init
@@ -682,9 +705,12 @@ state_t *emscripten_init()
 {
   // init sdl
   sdl_init(MIN_POSITION, WINDOW);
+  // the game ticks once per frame
+  sdl_set_frame_rate(1 / dt);
 
   // init state
   state_t *state = malloc(sizeof(state_t));
+  state->query_results = list_init(QUERY_RESULTS_CAPACITY, NULL);
 
   menu_init(state);
 
@@ -697,28 +723,19 @@ void handle_mouse(state_t *state)
   // body hovering
   if (!state->game_started)
   {
-    list_t *bodies = scene_get_bodies(state->scene_menu);
-    for (size_t i = 0; i < scene_bodies(state->scene_menu); i++)
+    vector_t scene_pos = (vector_t){mouse_pos.x, WINDOW.y - mouse_pos.y};
+    body_t *b = scene_query_point(state->scene_menu, scene_pos, BODY_LAYER_ALL);
+    if (b != NULL)
     {
-      body_t *b = list_get(bodies, i);
-      vector_t body_center = body_get_centroid(b);
-      double corrected_x = body_center.x;
-      double corrected_y = WINDOW.y - body_center.y;
-      if (mouse_pos.x > corrected_x - (CHOICE_SIZE / 2) && mouse_pos.x < corrected_x + (CHOICE_SIZE / 2))
+      size_t p_id = *((size_t *)body_get_info(b));
+      player_t *p = ((player_t *)list_get(state->players, p_id));
+      text_t *t = list_get(scene_get_texts(state->scene_menu), p_id);
+      color_t color = body_get_color(b);
+      if (!color_equals(p->st_color, color))
       {
-        if (mouse_pos.y > corrected_y - (CHOICE_SIZE / 2) && mouse_pos.y < corrected_y + (CHOICE_SIZE / 2))
-        {
-          size_t p_id = *((size_t *)body_get_info(b));
-          player_t *p = ((player_t *)list_get(state->players, p_id));
-          text_t *t = list_get(scene_get_texts(state->scene_menu), p_id);
-          color_t color = body_get_color(b);
-          if (!color_equals(p->st_color, color))
-          {
-            player_set_color(p, color);
-            text_set_color(t, color);
-            sdl_play_sound(FREE_CHANNEL, "assets/menu_select.wav", 0);
-          }
-        }
+        player_set_color(p, color);
+        text_set_color(t, color);
+        sdl_play_sound(FREE_CHANNEL, SOUND_MENU_SELECT, 0);
       }
     }
   }
@@ -727,13 +744,23 @@ void handle_mouse(state_t *state)
 void main_spawn_pellets(state_t *state)
 {
   // random powerup spawns
-  list_t *pu_types = get_pu_types();
-  list_t *pu_colors = get_pu_colors();
-
   if (state->time_since_pellet_spawn >= FOOD_SPAWN_TIME) // spawn pellets
   {
     state->time_since_pellet_spawn = 0;
-    spawn_pellet(state, pu_types, pu_colors);
+    spawn_pellet(state);
+  }
+}
+
+void main_collect_pellets(state_t *state)
+{
+  // each head only looks at the grid cells around it,
+  // and reaches as far as its bounding circle, so pickup follows the drawn head
+  for (size_t i = 0; i < GAME_NUM_PLAYERS; i++)
+  {
+    player_t *p = list_get(state->players, i);
+    body_t *head = player_get_head(p);
+    pellet_pickup_t pickup = {.state = state, .player = p};
+    food_field_collect(state->food, body_get_centroid(head), body_get_bounding_radius(head), pellet_pickup_handler, &pickup);
   }
 }
 
@@ -754,6 +781,9 @@ void main_tick_players(state_t *state)
 
 void main_render_game(state_t *state)
 {
+  // pellets lie below everything else
+  food_field_draw(state->food, true);
+
   // shows cosmetics that are below the bodies in the scene
   for (size_t i = 0; i < GAME_NUM_PLAYERS; i++)
   {
@@ -761,9 +791,8 @@ void main_render_game(state_t *state)
     player_render_cosmetics_below(p);
   }
 
-  // draws all the bodies in a scene
-  sdl_render_scene(state->scene_game);
-  // scene_draw(state->scene_game);
+  // draws the bodies, their glows and the texts in the scene
+  scene_render(state->scene_game);
 
   // shows cosmetics that are above the bodies in the scene
   for (size_t i = 0; i < GAME_NUM_PLAYERS; i++)
@@ -773,11 +802,8 @@ void main_render_game(state_t *state)
   }
 }
 
-void main_render_menu(state_t *state)
+void main_tick_menu(state_t *state)
 {
-  // tick bodies
-  sdl_render_scene(state->scene_menu);
-
   // tick text buttons
   for (size_t i = 0; i < list_size(scene_get_texts(state->scene_menu)); i++)
   {
@@ -789,6 +815,11 @@ void main_render_menu(state_t *state)
   }
 }
 
+void main_render_menu(state_t *state)
+{
+  scene_render(state->scene_menu);
+}
+
 void emscripten_main(state_t *state)
 {
   // sdl: clear window
@@ -797,8 +828,6 @@ void emscripten_main(state_t *state)
   // handle mouse
   handle_mouse(state);
 
-  // sdl_render_image();
-
   // handle keypresses
   sdl_on_key(keyboard_handler);
 
@@ -807,12 +836,14 @@ void emscripten_main(state_t *state)
     state->game_time += dt;
     state->time_since_pellet_spawn += dt;
     main_spawn_pellets(state);
+    main_collect_pellets(state);
     main_tick_players(state);
     main_render_game(state);
   }
   else
   {
-    sdl_render_image();
+    main_tick_menu(state);
+    sdl_render_image(IMAGE_BACKGROUND);
     main_render_menu(state);
   }
 
@@ -820,10 +851,37 @@ void emscripten_main(state_t *state)
   sdl_show();
 }
 
+scene_t *emscripten_get_scene(state_t *state)
+{
+  return state->game_started ? state->scene_game : state->scene_menu;
+}
+
 // emscripten: free resources
 void emscripten_free(state_t *state)
 {
-  scene_free(state->scene_game);
+  if (state->game_started)
+  {
+    food_field_free(state->food);
+    scene_free(state->scene_game);
+  }
+  else
+  {
+    // the players' segments and tags were never handed to the game scene
+    for (size_t i = 0; i < list_size(state->players); i++)
+    {
+      player_t *p = list_get(state->players, i);
+      for (size_t j = 0; j < list_size(p->meta_bodies); j++)
+      {
+        body_free(list_get(p->meta_bodies, j));
+      }
+      text_free(p->score_tag);
+    }
+  }
+  list_free(state->players);
+  list_free(state->query_results);
   scene_free(state->scene_menu);
+  shape_registry_free();
+  pool_registry_free();
   free(state);
+  sdl_quit();
 }
\ No newline at end of file
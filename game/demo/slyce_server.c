@@ -0,0 +1,75 @@
+/**
+ * Main entry of the dedicated server, as demo/slyce.c is of the game:
+ * plays SLYCE on the core library for clients over UDP (see server.h)
+ * until it is interrupted or has run a number of ticks, then prints its
+ * statistics. tests/loopback.c runs the same server against 64 clients.
+ *
+ * Usage: bin/slyce_server [-a address] [-p port] [-n ticks]
+ *
+ * By default it listens on every address, on SLYCE_SERVER_DEFAULT_PORT.
+ */
+
+#include "server.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+const uint16_t SLYCE_SERVER_DEFAULT_PORT = 27960;
+
+server_t *slyce_server = NULL;
+
+void slyce_server_stop(int signal) { server_close(slyce_server); }
+
+int main(int argc, char *argv[]) {
+  uint32_t ip = INADDR_ANY;
+  uint16_t port = SLYCE_SERVER_DEFAULT_PORT;
+  size_t ticks = 0;
+  struct in_addr address;
+  int opt;
+  while ((opt = getopt(argc, argv, "a:p:n:")) != -1) {
+    switch (opt) {
+    case 'a':
+      if (inet_pton(AF_INET, optarg, &address) != 1) {
+        fprintf(stderr, "%s: not an IPv4 address\n", optarg);
+        return 2;
+      }
+      ip = ntohl(address.s_addr);
+      break;
+    case 'p':
+      port = strtoul(optarg, NULL, 10);
+      break;
+    case 'n':
+      ticks = strtoul(optarg, NULL, 10);
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-a address] [-p port] [-n ticks]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+
+  slyce_server = server_init(ip, port);
+  if (!server_bind(slyce_server)) {
+    server_free(slyce_server);
+    return 1;
+  }
+  struct sigaction action = {.sa_handler = slyce_server_stop};
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  printf("listening on UDP port %u at %d ticks/s\n",
+         server_get_port(slyce_server), SERVER_TICK_RATE);
+  fflush(stdout);
+  server_listen(slyce_server, ticks);
+
+  server_stats_t stats = server_get_stats(slyce_server);
+  printf("%zu ticks (%zu skipped), %zu clients, %zu packets in (%zu "
+         "rejected), %zu out (%zu dropped), %zu inputs dropped\n",
+         stats.ticks, stats.ticks_skipped, stats.clients,
+         stats.packets_received, stats.packets_rejected, stats.packets_sent,
+         stats.sends_dropped, stats.inputs_dropped);
+  server_free(slyce_server);
+  return 0;
+}
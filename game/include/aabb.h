@@ -0,0 +1,61 @@
+#ifndef __AABB_H__
+#define __AABB_H__
+
+#include "vector.h"
+#include <stdbool.h>
+
+/**
+ * An axis-aligned bounding box.
+ * aabb_t is defined here, like vector_t, because it is passed *by value*.
+ */
+typedef struct {
+  vector_t min;
+  vector_t max;
+} aabb_t;
+
+/**
+ * Returns whether two boxes overlap (touching edges count as overlapping).
+ *
+ * @param a the first box
+ * @param b the second box
+ * @return true if the boxes share at least one point
+ */
+bool aabb_overlaps(aabb_t a, aabb_t b);
+
+/**
+ * Returns whether a point lies inside (or on the boundary of) a box.
+ *
+ * @param box the box
+ * @param point the point to test
+ * @return true if the point is inside the box
+ */
+bool aabb_contains_point(aabb_t box, vector_t point);
+
+/**
+ * Grows a box by the same margin on every side.
+ *
+ * @param box the box to grow
+ * @param margin the distance to move each side outwards
+ * @return the grown box
+ */
+aabb_t aabb_expand(aabb_t box, double margin);
+
+/**
+ * Computes the smallest box containing a circle.
+ *
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @return the circle's bounding box
+ */
+aabb_t aabb_from_circle(vector_t center, double radius);
+
+/**
+ * Computes the smallest box containing a line segment.
+ *
+ * @param start one endpoint of the segment
+ * @param end the other endpoint of the segment
+ * @return the segment's bounding box
+ */
+aabb_t aabb_from_segment(vector_t start, vector_t end);
+
+#endif // #ifndef __AABB_H__
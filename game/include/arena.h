@@ -0,0 +1,80 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+/**
+ * A bump allocator for short-lived memory.
+ * Allocations are carved out of one large block and are never freed
+ * individually; arena_reset() releases all of them at once.
+ * Once the block is big enough for a frame's worth of allocations,
+ * allocating from the arena never calls malloc.
+ */
+typedef struct arena arena_t;
+
+/**
+ * Allocates an empty arena.
+ *
+ * @param capacity the initial size of the arena's block, in bytes
+ * @return a pointer to the newly allocated arena
+ */
+arena_t *arena_init(size_t capacity);
+
+/**
+ * Releases the memory allocated for an arena and everything allocated in it.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ */
+void arena_free(arena_t *arena);
+
+/**
+ * Allocates memory from an arena, suitably aligned for any type.
+ * If the arena's block is full, the allocation spills into an extra block;
+ * the next arena_reset() grows the main block so it does not spill again.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @param size the number of bytes to allocate
+ * @return a pointer to the memory, valid until the next arena_reset()
+ */
+void *arena_alloc(arena_t *arena, size_t size);
+
+/**
+ * Releases everything allocated from an arena, keeping its memory for reuse.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ */
+void arena_reset(arena_t *arena);
+
+/**
+ * Gets the number of bytes allocated from an arena since its last reset.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return the number of bytes in use
+ */
+size_t arena_get_used(arena_t *arena);
+
+/**
+ * Gets the number of times an arena has called malloc or realloc.
+ * In steady state this stops increasing, which is how tests can check that
+ * frames do not allocate.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return the number of system allocations made by the arena
+ */
+size_t arena_get_malloc_count(arena_t *arena);
+
+/**
+ * Gets the arena used for memory that only lives until the end of the
+ * current frame, such as geometry built only to be drawn.
+ * sdl_show() resets it once the frame has been presented.
+ *
+ * @return the frame arena
+ */
+arena_t *frame_arena(void);
+
+/**
+ * Releases everything allocated from the frame arena.
+ */
+void frame_arena_reset(void);
+
+#endif // #ifndef __ARENA_H__
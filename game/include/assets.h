@@ -0,0 +1,52 @@
+#ifndef __ASSETS_H__
+#define __ASSETS_H__
+
+/**
+ * The sounds the game can play.
+ * Each one is loaded from its file once, when the window is opened,
+ * and played by id afterwards (see sdl_play_sound()).
+ */
+typedef enum {
+  SOUND_BULLET_HIT,
+  SOUND_COLLIDE,
+  SOUND_DASH,
+  SOUND_DEATH_DMG,
+  SOUND_DEATH_SCREAM,
+  SOUND_GAME_START,
+  SOUND_MENU_ERROR,
+  SOUND_MENU_MOVE,
+  SOUND_MENU_SELECT,
+  SOUND_PU_BASE_SPEED,
+  SOUND_PU_BULLET_SPEED,
+  SOUND_PU_DASH_BOOST,
+  SOUND_PU_ROTATE_RATE,
+  SOUND_RESPAWN,
+  SOUND_SHOOT,
+  SOUND_SOUNDTRACK,
+  NUM_SOUNDS
+} sound_id_t;
+
+/**
+ * The images the game can draw.
+ * Each one is loaded into a texture once, when the window is opened,
+ * and drawn by id afterwards (see sdl_render_image()).
+ */
+typedef enum { IMAGE_BACKGROUND, NUM_IMAGES } image_id_t;
+
+/**
+ * Gets the file a sound is loaded from.
+ *
+ * @param sound the id of the sound
+ * @return the path of the sound's WAV file
+ */
+const char *asset_sound_path(sound_id_t sound);
+
+/**
+ * Gets the file an image is loaded from.
+ *
+ * @param image the id of the image
+ * @return the path of the image's BMP file
+ */
+const char *asset_image_path(image_id_t image);
+
+#endif // #ifndef __ASSETS_H__
@@ -7,6 +7,14 @@
 
 typedef struct aux aux_t;
 
+/**
+ * Bundles the parameters of a force creator.
+ *
+ * @param constants the force's constants, owned by the aux (may be NULL)
+ * @param bodies the bodies the force acts on; the aux only borrows this list,
+ *   which should be the one passed to scene_add_bodies_force_creator()
+ * @return a pointer to the newly allocated aux
+ */
 aux_t *aux_init(list_t *constants, list_t *bodies);
 
 list_t *aux_get_bodies(aux_t *aux);
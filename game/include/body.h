@@ -1,10 +1,15 @@
 #ifndef __BODY_H__
 #define __BODY_H__
 
+#include "aabb.h"
+#include "collision.h"
 #include "color.h"
 #include "list.h"
+#include "shape.h"
+#include "vec_array.h"
 #include "vector.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * A rigid body constrained to the plane.
@@ -14,18 +19,37 @@
  */
 typedef struct body body_t;
 
+/**
+ * The layer bodies are created on.
+ * Layers are bits; scene queries take a mask of the layers they care about.
+ */
+extern const uint32_t BODY_LAYER_DEFAULT;
+
+/**
+ * A layer mask matching every layer.
+ */
+extern const uint32_t BODY_LAYER_ALL;
+
 /**
  * Initializes a body without any info.
  * Acts like body_init_with_info() where info and info_freer are NULL.
  */
-body_t *body_init(list_t *shape, double mass, color_t color);
+body_t *body_init(vec_array_t *shape, double mass, color_t color);
+
+/**
+ * Initializes a body that shares a shape prototype, without any info.
+ * Acts like body_init_shape_with_info() where info and info_freer are NULL.
+ */
+body_t *body_init_shape(shape_t *shape, vector_t centroid, double mass,
+                        color_t color);
 
 /**
  * Allocates memory for a body with the given parameters.
  * The body is initially at rest.
  * Asserts that the mass is positive and that the required memory is allocated.
  *
- * @param shape a list of vectors describing the initial shape of the body
+ * @param shape an array of vectors describing the initial shape of the body;
+ *   the body takes ownership of it
  * @param mass the mass of the body (if INFINITY, stops the body from moving)
  * @param color the color of the body, used to draw it on the screen
  * @param info additional information to associate with the body,
@@ -33,9 +57,26 @@ body_t *body_init(list_t *shape, double mass, color_t color);
  * @param info_freer if non-NULL, a function call on the info to free it
  * @return a pointer to the newly allocated body
  */
-body_t *body_init_with_info(list_t *shape, double mass, color_t color,
+body_t *body_init_with_info(vec_array_t *shape, double mass, color_t color,
                             void *info, free_func_t info_freer);
 
+/**
+ * Allocates memory for a body whose outline is a shared shape prototype
+ * (see shape_circle()). The body stores only a reference to the shape plus
+ * its own position and rotation, so it does not copy any vertices.
+ *
+ * @param shape the body's shape; the body takes its own reference to it
+ * @param centroid where to place the shape's local origin
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_shape_with_info(shape_t *shape, vector_t centroid,
+                                  double mass, color_t color, void *info,
+                                  free_func_t info_freer);
+
 /**
  * @param body1 First body in collision
  * @param body2 Second body in collision
@@ -52,12 +93,123 @@ void body_free(void *body);
 
 /**
  * Gets the current shape of a body.
- * Returns a newly allocated vector list, which must be list_free()d.
+ * Returns a newly allocated vector array, which must be vec_array_free()d.
  *
  * @param body a pointer to a body returned from body_init()
  * @return the polygon describing the body's current position
  */
-list_t *body_get_shape(body_t *body);
+vec_array_t *body_get_shape(body_t *body);
+
+/**
+ * Gets the current shape of a body for drawing.
+ * Like body_get_shape(), but the vector array lives in the frame arena
+ * (see arena.h), so it must not be freed and is only valid until the
+ * end of the frame.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the polygon describing the body's current position
+ */
+vec_array_t *body_get_frame_shape(body_t *body);
+
+/**
+ * Gets the shape prototype a body was made from.
+ * Its vertices are in local space; see body_get_angle() and
+ * body_get_centroid() for the transform that places it.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's shape, owned by the body
+ */
+shape_t *body_get_prototype(body_t *body);
+
+/**
+ * Gets the rotation of a body about its centroid.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the angle last passed to body_set_rotation(), or 0
+ */
+double body_get_angle(body_t *body);
+
+/**
+ * Gets the axis-aligned bounding box of a body's current shape.
+ * The box is cached on the body and kept up to date as it moves,
+ * so this does not touch the body's vertices.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the smallest box containing the body
+ */
+aabb_t body_get_aabb(body_t *body);
+
+/**
+ * Gets the body's "fat" bounding box: its bounding box grown by a margin.
+ * The fat box only changes when the body moves out of it, which makes it
+ * suitable for spatial indexes that should not be rebuilt every tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a box containing body_get_aabb()
+ */
+aabb_t body_get_fat_aabb(body_t *body);
+
+/**
+ * Gets the radius of the body's bounding circle,
+ * which is centered on the body's centroid.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the distance from the centroid to the furthest vertex
+ */
+double body_get_bounding_radius(body_t *body);
+
+/**
+ * Cheaply tests whether two bodies might be colliding by comparing their
+ * bounding circles and boxes, without touching their vertices.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return false if the bodies are certainly disjoint, true otherwise
+ */
+bool body_bounds_overlap(body_t *body1, body_t *body2);
+
+/**
+ * Computes the collision between two bodies' current shapes.
+ * Disjoint bodies are rejected with body_bounds_overlap() before running
+ * the full separating axis test, and no copies of the shapes are made.
+ * The test uses the shape metadata computed by body_init(), so concave
+ * bodies are handled through their convex parts.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return the collision info, as returned by find_collision_meta()
+ */
+collision_info_t body_find_collision(body_t *body1, body_t *body2);
+
+/**
+ * Returns whether a point lies inside a body's current shape.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param point the point to test
+ * @return true if the point is inside the body
+ */
+bool body_contains_point(body_t *body, vector_t point);
+
+/**
+ * Returns whether a body's current shape overlaps a circle.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @return true if the body and the circle share at least one point
+ */
+bool body_overlaps_circle(body_t *body, vector_t center, double radius);
+
+/**
+ * Intersects a line segment with a body's current shape.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @return the fraction of the way from start to end at which the segment
+ *   enters the body, or INFINITY if it misses (see polygon_raycast())
+ */
+double body_raycast(body_t *body, vector_t start, vector_t end);
 
 /**
  * Gets the current center of mass of a body.
@@ -161,7 +313,15 @@ void body_set_color(body_t *body, color_t color);
  */
 void body_add_force(body_t *body, vector_t force);
 
-list_t *vector_pts(vector_t start, vector_t acl);
+/**
+ * Builds the outline of an arrow from start to start + acl.
+ * The vector array lives in the frame arena (see arena.h).
+ *
+ * @param start the tail of the arrow
+ * @param acl the vector the arrow represents
+ * @return the arrow's polygon, valid until the end of the frame
+ */
+vec_array_t *vector_pts(vector_t start, vector_t acl);
 
 /**
  * Draws body's current acceleration vector in RED
@@ -170,6 +330,58 @@ list_t *vector_pts(vector_t start, vector_t acl);
  */
 void body_draw_acl(body_t *body);
 
+/**
+ * Gets the layer bits of a body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's layers (BODY_LAYER_DEFAULT unless changed)
+ */
+uint32_t body_get_layer(body_t *body);
+
+/**
+ * Sets the layer bits of a body, used to filter scene queries.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param layer the body's new layer bits
+ */
+void body_set_layer(body_t *body, uint32_t layer);
+
+/**
+ * Has a body append itself to a list whenever its fat bounding box changes
+ * (see body_get_fat_aabb()), so a spatial index built from fat boxes only
+ * re-inserts the bodies that moved. The body appends itself right away,
+ * and then at most once until body_clear_moved() is called.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param motion_list the list to append to, which must not own its
+ *   elements, or NULL to stop reporting
+ */
+void body_set_motion_list(body_t *body, list_t *motion_list);
+
+/**
+ * Lets a body append itself to its motion list again,
+ * once it has been taken off the list.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_clear_moved(body_t *body);
+
+/**
+ * Gets the handle of a body in its scene's spatial index.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the handle, or SIZE_MAX if the body is not indexed
+ */
+size_t body_get_index_handle(body_t *body);
+
+/**
+ * Sets the handle of a body in its scene's spatial index.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param handle the handle, or SIZE_MAX if the body is not indexed
+ */
+void body_set_index_handle(body_t *body, size_t handle);
+
 bool body_get_glow(body_t *body);
 
 void body_set_glow(body_t *body, bool glow);
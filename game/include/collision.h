@@ -1,7 +1,8 @@
 #ifndef __COLLISION_H__
 #define __COLLISION_H__
 
-#include "list.h"
+#include "polygon.h"
+#include "vec_array.h"
 #include "vector.h"
 #include <stdbool.h>
 
@@ -23,7 +24,7 @@ typedef struct {
 
 /**
  * Computes the status of the collision between two convex polygons.
- * The shapes are given as lists of vertices in counterclockwise order.
+ * The shapes are given as arrays of vertices in counterclockwise order.
  * There is an edge between each pair of consecutive vertices,
  * and one between the first vertex and the last vertex.
  *
@@ -32,6 +33,31 @@ typedef struct {
  * @return whether the shapes are colliding, and if so, the collision axis.
  * The axis should be a unit vector pointing from shape1 towards shape2.
  */
-collision_info_t find_collision(list_t *shape1, list_t *shape2);
+collision_info_t find_collision(vec_array_t *shape1, vec_array_t *shape2);
+
+/**
+ * Computes the status of the collision between two placed polygons,
+ * using their precomputed metadata (see polygon_meta_init()).
+ * Each polygon is given in local space together with the rigid transform
+ * that places it in the world: rotate by the angle, then translate.
+ * Each pair of convex parts is tested on its deduplicated axes only,
+ * so this also works for concave polygons.
+ *
+ * @param shape1 the first shape's local vertices
+ * @param meta1 the metadata computed for shape1
+ * @param pos1 where shape1's local origin is placed
+ * @param angle1 how far shape1 is rotated about its local origin
+ * @param shape2 the second shape's local vertices
+ * @param meta2 the metadata computed for shape2
+ * @param pos2 where shape2's local origin is placed
+ * @param angle2 how far shape2 is rotated about its local origin
+ * @return whether the shapes are colliding, and if so, the world-space
+ *   collision axis of the most deeply overlapping pair of parts
+ */
+collision_info_t find_collision_meta(vec_array_t *shape1,
+                                     polygon_meta_t *meta1, vector_t pos1,
+                                     double angle1, vec_array_t *shape2,
+                                     polygon_meta_t *meta2, vector_t pos2,
+                                     double angle2);
 
 #endif // #ifndef __COLLISION_H__
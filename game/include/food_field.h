@@ -0,0 +1,117 @@
+#ifndef __FOOD_FIELD_H__
+#define __FOOD_FIELD_H__
+
+#include "color.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A single pellet in a food field.
+ * Pellets are plain records stored by value, not bodies: they have no shape,
+ * forces or collision packages, so thousands of them cost almost nothing.
+ */
+typedef struct {
+  vector_t pos;
+  size_t type;
+} food_t;
+
+/**
+ * A field of pellets bucketed into a uniform grid over the arena.
+ * Pickup queries only visit the cells around the query circle, so the cost of
+ * a tick does not depend on how many pellets are lying around.
+ */
+typedef struct food_field food_field_t;
+
+/**
+ * A function called for every pellet picked up by food_field_collect().
+ * The pellet has already been removed from the field when this is called,
+ * so the handler may safely spawn new pellets.
+ *
+ * @param food the pellet that was picked up
+ * @param aux the auxiliary value passed to food_field_collect()
+ */
+typedef void (*food_handler_t)(food_t food, void *aux);
+
+/**
+ * Allocates an empty food field covering the given rectangle.
+ * Pellets spawned outside of the rectangle are clamped into the border cells.
+ *
+ * @param min the bottom left corner of the field
+ * @param max the top right corner of the field
+ * @param cell_size side length of a grid cell; should be at least the
+ *   diameter of the largest query circle so a query touches few cells
+ * @param radius the radius of every pellet
+ * @param palette the color of each pellet type, indexed by food_t.type
+ * @param num_types the number of entries in palette
+ * @return a pointer to the newly allocated field
+ */
+food_field_t *food_field_init(vector_t min, vector_t max, double cell_size,
+                              double radius, const color_t *palette,
+                              size_t num_types);
+
+/**
+ * Releases the memory allocated for a food field and all of its pellets.
+ *
+ * @param field a pointer to a field returned from food_field_init()
+ */
+void food_field_free(food_field_t *field);
+
+/**
+ * Gets the number of pellets currently in the field.
+ *
+ * @param field a pointer to a field returned from food_field_init()
+ * @return the number of pellets
+ */
+size_t food_field_size(food_field_t *field);
+
+/**
+ * Gets the radius of every pellet in the field.
+ *
+ * @param field a pointer to a field returned from food_field_init()
+ * @return the radius passed to food_field_init()
+ */
+double food_field_get_radius(food_field_t *field);
+
+/**
+ * Adds a pellet to the field.
+ * Asserts that the type is a valid palette index.
+ *
+ * @param field a pointer to a field returned from food_field_init()
+ * @param pos the center of the pellet
+ * @param type the pellet's type, an index into the palette
+ */
+void food_field_add(food_field_t *field, vector_t pos, size_t type);
+
+/**
+ * Removes every pellet whose circle overlaps the given circle,
+ * calling the handler once for each of them.
+ * Only the grid cells overlapping the query circle are visited.
+ *
+ * @param field a pointer to a field returned from food_field_init()
+ * @param center the center of the query circle
+ * @param radius the radius of the query circle
+ * @param handler if non-NULL, called with each pellet that was picked up
+ * @param aux an auxiliary value to pass to the handler
+ * @return the number of pellets picked up
+ */
+size_t food_field_collect(food_field_t *field, vector_t center, double radius,
+                          food_handler_t handler, void *aux);
+
+/**
+ * Removes every pellet from the field.
+ *
+ * @param field a pointer to a field returned from food_field_init()
+ */
+void food_field_clear(food_field_t *field);
+
+/**
+ * Draws every pellet, and optionally its glow, in a handful of batched draw
+ * calls that do not depend on the number of pellets.
+ *
+ * @param field a pointer to a field returned from food_field_init()
+ * @param glow whether to draw a glow around each pellet
+ */
+void food_field_draw(food_field_t *field, bool glow);
+
+#endif // #ifndef __FOOD_FIELD_H__
@@ -25,7 +25,8 @@ force_wrapper_t *force_init(force_creator_t force_creator, void *aux,
  * @param force_creator
  * @param aux
  * @param freer
- * @param bodies
+ * @param bodies the bodies the force acts on; the force takes ownership of
+ *   the list (but not of the bodies in it)
  * @return force_wrapper_t*
  */
 force_wrapper_t *force_init_with_bodies(force_creator_t force_creator,
@@ -66,7 +67,8 @@ void *force_get_aux(force_wrapper_t *force);
 void force_set_aux(force_wrapper_t *force, void *aux);
 
 /**
- * Free all resources related to this force
+ * Free all resources related to this force: its aux (through its freer)
+ * and its list of bodies.
  *
  * @param force
  */
@@ -76,4 +78,20 @@ void force_remove(force_wrapper_t *force);
 
 bool force_is_removed(force_wrapper_t *force);
 
+/**
+ * Marks a force as a collision check, to be run in scene_tick()'s
+ * collision pass after the other forces
+ *
+ * @param force pointer to instance
+ */
+void force_set_collision(force_wrapper_t *force);
+
+/**
+ * Returns whether a force was marked with force_set_collision()
+ *
+ * @param force pointer to instance
+ * @return bool
+ */
+bool force_is_collision(force_wrapper_t *force);
+
 #endif // #ifndef __FORCE_WRAPPER_H__
@@ -95,7 +95,8 @@ void create_destructive_collision(scene_t *scene, body_t *body1, body_t *body2);
  * Create a constant applied force
  * 
  * @param scene scene with bodies
- * @param magnitude magnitude of force
+ * @param magnitude magnitude of force, read every tick; the force only
+ *   borrows it, so it must outlive the force
  * @param body body to be added to
  */
 void create_applied_force(scene_t *scene, double *magnitude, body_t *body);
@@ -1,12 +1,15 @@
 #ifndef __LIST_H__
 #define __LIST_H__
 
+#include <stdbool.h>
 #include <stddef.h>
 
 /**
  * A growable array of pointers.
  * Can store values of any pointer type (e.g. vector_t*, body_t*).
  * The list automatically grows its internal array when more capacity is needed.
+ * Lists are allocated from a pool (see pool.h), and small lists keep their
+ * elements inline, so creating and freeing them does not call malloc.
  */
 typedef struct list list_t;
 
@@ -16,6 +19,16 @@ typedef struct list list_t;
  */
 typedef void (*free_func_t)(void *);
 
+/**
+ * A function that decides whether a list element should be removed.
+ * See list_compact_if().
+ *
+ * @param element an element of the list
+ * @param aux the auxiliary value passed to list_compact_if()
+ * @return true to remove the element
+ */
+typedef bool (*list_pred_t)(void *element, void *aux);
+
 /**
  * Allocates memory for a new list with space for the given number of elements.
  * The list is initially empty.
@@ -77,4 +90,57 @@ void *list_remove(list_t *list, size_t index);
  */
 void list_add(list_t *list, void *value);
 
+/**
+ * Makes sure a list can hold at least the given number of elements
+ * without resizing.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param capacity the number of elements to make room for
+ */
+void list_reserve(list_t *list, size_t capacity);
+
+/**
+ * Removes the element at a given index in a list and returns it,
+ * moving the last element into its place.
+ * Unlike list_remove(), this takes O(1) time but does not keep the order
+ * of the remaining elements.
+ * Asserts that the index is valid, given the list's current size.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param index an index in the list
+ * @return the element at the given index in the list
+ */
+void *list_swap_remove(list_t *list, size_t index);
+
+/**
+ * Removes every element from a list, calling the list's freer on each,
+ * but keeps the list's capacity for reuse.
+ *
+ * @param list a pointer to a list returned from list_init()
+ */
+void list_clear(list_t *list);
+
+/**
+ * Removes every element for which a predicate returns true, calling the
+ * list's freer on each of them, in a single pass that keeps the order of
+ * the remaining elements. Takes O(n) time however many elements are removed,
+ * where calling list_remove() for each of them would take O(n^2).
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param should_remove called once on every element, in order
+ * @param aux an auxiliary value to pass to should_remove
+ * @return the number of elements removed
+ */
+size_t list_compact_if(list_t *list, list_pred_t should_remove, void *aux);
+
+/**
+ * Gets the list's underlying array of elements, for hot loops that should
+ * not pay for the bounds check in list_get().
+ * The pointer is invalidated by anything that adds or removes elements.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @return a pointer to the first of list_size() elements
+ */
+void **list_data(list_t *list);
+
 #endif // #ifndef __LIST_H__
\ No newline at end of file
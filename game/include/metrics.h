@@ -0,0 +1,153 @@
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include "vector.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Counts what the engine does: collision tests, allocations, bodies and
+ * forces coming and going, text drawn. Counting is always on and cheap
+ * enough for the hottest loops.
+ *
+ * Each thread counts into its own block of counters, so threads never
+ * contend, and only the thread that owns a block writes to it.
+ * metrics_get_total() sums the blocks of every thread.
+ * Threads past the first METRICS_MAX_THREADS share one more block,
+ * which they add to with atomic read-modify-writes instead.
+ *
+ * metrics_end_tick() takes a snapshot once per tick, and keeps what was
+ * counted during the tick that just ended. sdl_show() calls it,
+ * since the game ticks once per frame.
+ */
+
+/**
+ * The most threads that get a block of their own.
+ */
+#define METRICS_MAX_THREADS 8
+
+/**
+ * SAT early-outs are counted by the number of axes tested before the
+ * separating one, with everything from this many axes on counted together.
+ */
+#define METRICS_SAT_AXES 8
+
+/**
+ * The things that are counted.
+ */
+typedef enum {
+  // separating axis tests between two convex parts
+  METRIC_SAT_TESTS,
+  // tests that found a separating axis,
+  // on the first axis, the second axis, and so on
+  METRIC_SAT_EARLY_OUT,
+  METRIC_SAT_EARLY_OUT_LAST = METRIC_SAT_EARLY_OUT + METRICS_SAT_AXES - 1,
+  // pairs of bodies checked for a collision
+  METRIC_BROAD_PAIRS,
+  // pairs whose bounding boxes overlap, which go on to the narrow phase
+  METRIC_BROAD_PAIRS_OVERLAPPING,
+  // pairs that are colliding
+  METRIC_PAIRS_COLLIDING,
+  // calls to malloc() and realloc(), by the module that made them
+  METRIC_ALLOCS_LIST,
+  METRIC_ALLOCS_VEC_ARRAY,
+  METRIC_ALLOCS_POOL,
+  METRIC_ALLOCS_ARENA,
+  METRIC_FORCES_CREATED,
+  METRIC_FORCES_REMOVED,
+  METRIC_BODIES_SPAWNED,
+  METRIC_BODIES_REMOVED,
+  // lines of text laid out from a glyph atlas
+  METRIC_TEXTS_DRAWN,
+  // glyphs rendered by the font library into a glyph atlas
+  METRIC_GLYPHS_RASTERIZED,
+  METRIC_COUNT
+} metric_t;
+
+/**
+ * A value for every metric.
+ */
+typedef struct {
+  uint64_t values[METRIC_COUNT];
+} metrics_snapshot_t;
+
+/**
+ * Adds to a metric on the calling thread.
+ *
+ * @param metric the metric to add to
+ * @param amount the amount to add
+ */
+void metrics_add(metric_t metric, uint64_t amount);
+
+/**
+ * Counts a SAT test that found a separating axis.
+ *
+ * @param axis how many axes were tested before the separating one
+ */
+void metrics_add_sat_early_out(size_t axis);
+
+/**
+ * Gets the totals of every metric, over every thread,
+ * since the program started.
+ *
+ * @return the totals
+ */
+metrics_snapshot_t metrics_get_total(void);
+
+/**
+ * Ends a tick, keeping what was counted since the previous call.
+ * Must only be called from one thread.
+ */
+void metrics_end_tick(void);
+
+/**
+ * Gets what was counted during the last tick that ended.
+ * It is all 0 before the first tick ends.
+ *
+ * @return the counts of the last tick
+ */
+metrics_snapshot_t metrics_get_last_tick(void);
+
+/**
+ * Gets the name of a metric, as used in the CSV and JSON output.
+ *
+ * @param metric the metric
+ * @return the metric's name
+ */
+const char *metrics_name(metric_t metric);
+
+/**
+ * Writes a CSV header line: "tick" followed by the name of every metric.
+ *
+ * @param file the file to write to
+ */
+void metrics_write_csv_header(FILE *file);
+
+/**
+ * Writes a snapshot as a CSV line that goes with metrics_write_csv_header().
+ *
+ * @param file the file to write to
+ * @param tick the tick number to start the line with
+ * @param snapshot the snapshot to write
+ */
+void metrics_write_csv_row(FILE *file, size_t tick,
+                           const metrics_snapshot_t *snapshot);
+
+/**
+ * Writes a snapshot as a JSON object from metric names to values.
+ *
+ * @param file the file to write to
+ * @param snapshot the snapshot to write
+ */
+void metrics_write_json(FILE *file, const metrics_snapshot_t *snapshot);
+
+/**
+ * Draws the last tick's counts on the dev-mode HUD, as lines of text
+ * below a point.
+ *
+ * @param top_left the top-left corner of the text, in scene coordinates
+ * @return the top-left corner of the line after the last one drawn
+ */
+vector_t metrics_draw_hud(vector_t top_left);
+
+#endif // #ifndef __METRICS_H__
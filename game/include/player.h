@@ -68,7 +68,7 @@ void player_dash(player_t *p);
 
 body_t *player_shoot(player_t *p);
 
-void player_eat(player_t *p, body_t *food, scene_t *scene);
+void player_eat(player_t *p, char *pu_type, scene_t *scene);
 
 body_t *player_body(player_t *p);
 
@@ -86,6 +86,9 @@ vector_t player_head_pos(player_t *p);
 
 vector_t player_tail_pos(player_t *p);
 
+/**
+ * Formats a player's score. The caller must free() the returned string.
+ */
 char *player_get_score(player_t *p);
 
 void player_update_kills(player_t *p);
@@ -96,6 +99,11 @@ body_t *player_add_body(player_t *p);
 
 void player_respawn(player_t *p, scene_t *scene);
 
+/**
+ * Releases the memory allocated for a player.
+ * The player's segments and score tag are owned by the scene they were added
+ * to, so they are not freed here.
+ */
 void player_free(void *p);
 
 bool player_moves_on_key(player_t *p, char key);
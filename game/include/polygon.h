@@ -1,49 +1,188 @@
 #ifndef __POLYGON_H__
 #define __POLYGON_H__
 
-#include "list.h"
+#include "aabb.h"
+#include "vec_array.h"
 #include "vector.h"
+#include <stdbool.h>
 
 /**
  * Computes the area of a polygon.
  * See https://en.wikipedia.org/wiki/Shoelace_formula#Statement.
  *
- * @param polygon the list of vertices that make up the polygon,
+ * @param polygon the array of vertices that make up the polygon,
  * listed in a counterclockwise direction. There is an edge between
  * each pair of consecutive vertices, plus one between the first and last.
  * @return the area of the polygon
  */
-double polygon_area(list_t *polygon);
+double polygon_area(vec_array_t *polygon);
 
 /**
  * Computes the center of mass of a polygon.
  * See https://en.wikipedia.org/wiki/Centroid#Of_a_polygon.
  *
- * @param polygon the list of vertices that make up the polygon,
+ * @param polygon the array of vertices that make up the polygon,
  * listed in a counterclockwise direction. There is an edge between
  * each pair of consecutive vertices, plus one between the first and last.
  * @return the centroid of the polygon
  */
-vector_t polygon_centroid(list_t *polygon);
+vector_t polygon_centroid(vec_array_t *polygon);
 
 /**
  * Translates all vertices in a polygon by a given vector.
  * Note: mutates the original polygon.
  *
- * @param polygon the list of vertices that make up the polygon
+ * @param polygon the array of vertices that make up the polygon
  * @param translation the vector to add to each vertex's position
  */
-void polygon_translate(list_t *polygon, vector_t translation);
+void polygon_translate(vec_array_t *polygon, vector_t translation);
 
 /**
  * Rotates vertices in a polygon by a given angle about a given point.
  * Note: mutates the original polygon.
  *
- * @param polygon the list of vertices that make up the polygon
+ * @param polygon the array of vertices that make up the polygon
  * @param angle the angle to rotate the polygon, in radians.
  * A positive angle means counterclockwise.
  * @param point the point to rotate around
  */
-void polygon_rotate(list_t *polygon, double angle, vector_t point);
+void polygon_rotate(vec_array_t *polygon, double angle, vector_t point);
+
+/**
+ * Computes the axis-aligned bounding box of a polygon.
+ *
+ * @param polygon the array of vertices that make up the polygon
+ * @return the smallest box containing every vertex
+ */
+aabb_t polygon_aabb(vec_array_t *polygon);
+
+/**
+ * Returns whether a point lies inside a polygon.
+ * Works for concave polygons too (even-odd rule).
+ *
+ * @param polygon the array of vertices that make up the polygon
+ * @param point the point to test
+ * @return true if the point is inside the polygon
+ */
+bool polygon_contains_point(vec_array_t *polygon, vector_t point);
+
+/**
+ * Returns whether a polygon overlaps a circle,
+ * i.e. whether the circle's center is inside the polygon
+ * or within the given radius of one of its edges.
+ *
+ * @param polygon the array of vertices that make up the polygon
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @return true if the polygon and the circle share at least one point
+ */
+bool polygon_overlaps_circle(vec_array_t *polygon, vector_t center, double radius);
+
+/**
+ * Intersects a line segment with the edges of a polygon.
+ *
+ * @param polygon the array of vertices that make up the polygon
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @return the fraction (between 0 and 1) of the way from start to end
+ *   at which the segment first enters the polygon, 0 if start is inside it,
+ *   or INFINITY if the segment misses it
+ */
+double polygon_raycast(vec_array_t *polygon, vector_t start, vector_t end);
+
+/**
+ * A convex piece of a polygon, as found by polygon_meta_init().
+ * Parts refer to the polygon's vertices by index, so they stay valid
+ * as the polygon is translated and rotated.
+ */
+typedef struct {
+  /** Indices of the part's vertices in the polygon, counterclockwise */
+  size_t *vertices;
+  size_t num_vertices;
+  /**
+   * The part's edge normals as unit vectors, with parallel duplicates removed.
+   * They are relative to the orientation the polygon had when its metadata
+   * was computed; rotate them by any later rotation of the polygon.
+   */
+  vector_t *axes;
+  size_t num_axes;
+} polygon_part_t;
+
+/**
+ * Geometry of a polygon that does not change when it is translated or
+ * rotated, computed once so that the narrow phase does not redo it
+ * every tick: area, centroid, bounding radius, convexity,
+ * and a decomposition into convex parts with deduplicated SAT axes.
+ */
+typedef struct polygon_meta polygon_meta_t;
+
+/**
+ * Computes the metadata of a polygon.
+ * Concave polygons are split into convex parts by ear clipping followed by
+ * merging neighbouring pieces while the result stays convex.
+ * A convex polygon has exactly one part containing every vertex.
+ *
+ * @param polygon the array of vertices that make up the polygon,
+ * with no self-intersections; either winding order is accepted
+ * @return a pointer to the newly allocated metadata
+ */
+polygon_meta_t *polygon_meta_init(vec_array_t *polygon);
+
+/**
+ * Releases the memory allocated for a polygon's metadata.
+ *
+ * @param meta a pointer to metadata returned from polygon_meta_init()
+ */
+void polygon_meta_free(polygon_meta_t *meta);
+
+/**
+ * Gets the area of the polygon.
+ *
+ * @param meta a pointer to metadata returned from polygon_meta_init()
+ * @return the polygon's area
+ */
+double polygon_meta_get_area(polygon_meta_t *meta);
+
+/**
+ * Gets the centroid the polygon had when its metadata was computed.
+ *
+ * @param meta a pointer to metadata returned from polygon_meta_init()
+ * @return the polygon's centroid at the time
+ */
+vector_t polygon_meta_get_centroid(polygon_meta_t *meta);
+
+/**
+ * Gets the radius of the polygon's bounding circle about its centroid.
+ *
+ * @param meta a pointer to metadata returned from polygon_meta_init()
+ * @return the distance from the centroid to the furthest vertex
+ */
+double polygon_meta_get_bounding_radius(polygon_meta_t *meta);
+
+/**
+ * Returns whether the polygon is convex.
+ *
+ * @param meta a pointer to metadata returned from polygon_meta_init()
+ * @return true if no interior angle exceeds 180 degrees
+ */
+bool polygon_meta_is_convex(polygon_meta_t *meta);
+
+/**
+ * Gets the number of convex parts the polygon was split into.
+ *
+ * @param meta a pointer to metadata returned from polygon_meta_init()
+ * @return the number of parts (1 for a convex polygon)
+ */
+size_t polygon_meta_num_parts(polygon_meta_t *meta);
+
+/**
+ * Gets one of the polygon's convex parts.
+ *
+ * @param meta a pointer to metadata returned from polygon_meta_init()
+ * @param index the index of the part
+ * @return the part, owned by the metadata
+ */
+const polygon_part_t *polygon_meta_get_part(polygon_meta_t *meta,
+                                            size_t index);
 
 #endif // #ifndef __POLYGON_H__
@@ -0,0 +1,97 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stddef.h>
+
+/**
+ * A free-list allocator for objects of a single size.
+ * Objects are carved out of large slabs, and released objects are kept on a
+ * free list and handed out again, so creating and destroying objects at a
+ * steady rate stops calling malloc and does not fragment the heap.
+ *
+ * Slabs are only returned to the system by pool_clear() and pool_free().
+ * In ASAN builds, released objects are poisoned, so use-after-free bugs are
+ * still reported.
+ */
+typedef struct pool pool_t;
+
+/**
+ * Allocates an empty pool and registers it with pool_registry_free().
+ *
+ * @param elem_size the size of each object, in bytes
+ * @param slab_count the number of objects to allocate at a time
+ * @return a pointer to the newly allocated pool
+ */
+pool_t *pool_init(size_t elem_size, size_t slab_count);
+
+/**
+ * Gets a module's shared pool, creating it on first use.
+ * When the pool is freed, the module's pointer to it is reset to NULL,
+ * so it is created again if the module allocates after that.
+ *
+ * @param pool the module's pointer to its pool, initially NULL
+ * @param elem_size the size of each object, in bytes
+ * @param slab_count the number of objects to allocate at a time
+ * @return the pool
+ */
+pool_t *pool_get_shared(pool_t **pool, size_t elem_size, size_t slab_count);
+
+/**
+ * Releases the memory allocated for a pool, including every object
+ * allocated from it.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ */
+void pool_free(pool_t *pool);
+
+/**
+ * Returns every slab of a pool to the system, and with them every object
+ * allocated from it. The pool stays usable.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ */
+void pool_clear(pool_t *pool);
+
+/**
+ * Allocates an object from a pool, suitably aligned for any type.
+ * The object's contents are uninitialized.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return a pointer to the object
+ */
+void *pool_alloc(pool_t *pool);
+
+/**
+ * Returns an object to the pool it was allocated from.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @param elem an object returned from pool_alloc() on the same pool
+ */
+void pool_release(pool_t *pool, void *elem);
+
+/**
+ * Gets the number of objects allocated from a pool and not yet released.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return the number of live objects
+ */
+size_t pool_get_live(pool_t *pool);
+
+/**
+ * Gets the number of slabs a pool currently holds.
+ * This stops increasing once the pool is big enough for the steady state.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return the number of slabs
+ */
+size_t pool_get_slab_count(pool_t *pool);
+
+/**
+ * Frees every pool that has not been freed, at shutdown.
+ * Every object must have been released first: a pool with live objects
+ * fails an assert, and is kept when asserts are off, so leaks are still
+ * reported instead of being reclaimed.
+ */
+void pool_registry_free(void);
+
+#endif // #ifndef __POOL_H__
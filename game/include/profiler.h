@@ -0,0 +1,156 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Times the phases of each frame with a monotonic clock and keeps
+ * rolling statistics over the last few frames, for the dev-mode HUD.
+ *
+ * Phases are timed with matching profiler_begin() and profiler_end() calls,
+ * which may nest: a phase's time excludes the phases timed inside it,
+ * so the phases of a frame add up to the time spent in them.
+ * profiler_end_frame() closes the frame and adds its totals to the window.
+ * Every phase also opens a span in tick_tracer() (see trace.h),
+ * whether or not the profiler is on.
+ *
+ * Every function accepts a NULL profiler and does nothing with it,
+ * so code can be instrumented with tick_profiler(), which is NULL
+ * unless profiling has been switched on.
+ */
+typedef struct profiler profiler_t;
+
+/**
+ * The phases of a frame.
+ */
+typedef enum {
+  PROFILE_FORCES,
+  PROFILE_INTEGRATE,
+  PROFILE_BROAD_PHASE,
+  PROFILE_COLLISIONS,
+  PROFILE_REMOVAL,
+  PROFILE_GLOW,
+  PROFILE_DRAW,
+  PROFILE_TEXT,
+  PROFILE_PRESENT,
+  PROFILE_NUM_PHASES
+} profile_phase_t;
+
+/**
+ * Statistics of a phase over the frames in a profiler's window,
+ * in microseconds.
+ */
+typedef struct {
+  double min;
+  double avg;
+  double p99;
+} profile_stats_t;
+
+/**
+ * Reads the monotonic clock that the profiler and the tracer time with.
+ *
+ * @return the time since an arbitrary point, in microseconds
+ */
+double profiler_now(void);
+
+/**
+ * Allocates a profiler with an empty window.
+ *
+ * @param window the number of frames to keep statistics over
+ * @return a pointer to the newly allocated profiler
+ */
+profiler_t *profiler_init(size_t window);
+
+/**
+ * Releases the memory allocated for a profiler.
+ *
+ * @param profiler a pointer to a profiler returned from profiler_init()
+ */
+void profiler_free(profiler_t *profiler);
+
+/**
+ * Starts timing a phase.
+ *
+ * @param profiler a pointer to a profiler returned from profiler_init()
+ * @param phase the phase to time
+ */
+void profiler_begin(profiler_t *profiler, profile_phase_t phase);
+
+/**
+ * Stops timing the phase started by the last unmatched profiler_begin().
+ * Asserts that it is the given phase.
+ *
+ * @param profiler a pointer to a profiler returned from profiler_init()
+ * @param phase the phase to stop timing
+ */
+void profiler_end(profiler_t *profiler, profile_phase_t phase);
+
+/**
+ * Ends the current frame, adding its phase times to the window.
+ * Asserts that no phase is still being timed.
+ *
+ * @param profiler a pointer to a profiler returned from profiler_init()
+ */
+void profiler_end_frame(profiler_t *profiler);
+
+/**
+ * Gets the statistics of a phase over the frames in the window.
+ * They are all 0 before the first frame ends.
+ *
+ * @param profiler a pointer to a profiler returned from profiler_init()
+ * @param phase the phase
+ * @return the minimum, mean and 99th percentile time of the phase
+ */
+profile_stats_t profiler_get_stats(profiler_t *profiler, profile_phase_t phase);
+
+/**
+ * Gets the name of a phase, as shown on the HUD.
+ *
+ * @param phase the phase
+ * @return the phase's name
+ */
+const char *profiler_phase_name(profile_phase_t phase);
+
+/**
+ * Draws a line of text on the dev-mode HUD.
+ *
+ * @param line the text to draw
+ * @param top_left the top-left corner of the line, in scene coordinates
+ * @return the top-left corner of the next line
+ */
+vector_t profiler_draw_hud_line(const char *line, vector_t top_left);
+
+/**
+ * Draws a table of every phase's statistics, followed by the body and
+ * force counts, as lines of text below a point.
+ * Draws nothing if the profiler is NULL.
+ *
+ * @param profiler a pointer to a profiler returned from profiler_init()
+ * @param top_left the top-left corner of the table, in scene coordinates
+ * @param num_bodies the number of bodies to show
+ * @param num_forces the number of forces to show
+ * @return the top-left corner of the line after the table
+ */
+vector_t profiler_draw_hud(profiler_t *profiler, vector_t top_left,
+                           size_t num_bodies, size_t num_forces);
+
+/**
+ * Gets the profiler that the engine reports its phases to.
+ *
+ * @return the profiler, or NULL if profiling is switched off
+ */
+profiler_t *tick_profiler(void);
+
+/**
+ * Switches the engine's profiler on or off.
+ * Switching it on starts with an empty window;
+ * switching it off frees the profiler.
+ * Must not be called while a phase is being timed.
+ *
+ * @param enabled whether to profile
+ */
+void tick_profiler_set_enabled(bool enabled);
+
+#endif // #ifndef __PROFILER_H__
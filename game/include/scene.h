@@ -1,14 +1,23 @@
 #ifndef __SCENE_H__
 #define __SCENE_H__
 
+#include "aabb.h"
 #include "body.h"
 #include "text.h"
 #include "list.h"
+#include <stdint.h>
 
 /**
  * A collection of bodies and force creators.
  * The scene automatically resizes to store
  * arbitrarily many bodies and force creators.
+ *
+ * A scene owns everything added to it: bodies (and through them their shapes
+ * and info), texts, and force creators (and through them their aux values).
+ * Anything flagged with body_remove(), force_remove() or text_remove() is
+ * freed by the scene during its next tick, so callers must not keep pointers
+ * to it afterwards. Lists handed to the scene alongside a force creator
+ * only borrow their bodies.
  */
 typedef struct scene scene_t;
 
@@ -19,6 +28,18 @@ typedef struct scene scene_t;
  */
 typedef void (*force_creator_t)(void *aux);
 
+/**
+ * The result of a successful scene_raycast().
+ */
+typedef struct {
+  /** The first body hit by the segment */
+  body_t *body;
+  /** The point at which the segment enters the body */
+  vector_t point;
+  /** How far along the segment the hit is, between 0 (start) and 1 (end) */
+  double fraction;
+} raycast_hit_t;
+
 /**
  * Allocates memory for an empty scene.
  * Makes a reasonable guess of the number of bodies to allocate space for.
@@ -66,6 +87,13 @@ body_t *scene_get_body(scene_t *scene, size_t index);
  */
 void scene_add_body(scene_t *scene, body_t *body);
 
+/**
+ * Adds a text to a scene, which renders it every tick until it is removed.
+ * The scene takes ownership of the text.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param text a pointer to the text to add to the scene
+ */
 void scene_add_text(scene_t *scene, text_t *text);
 
 /**
@@ -89,7 +117,10 @@ void scene_remove_body(scene_t *scene, size_t index);
 bool scene_get_dev_mode(scene_t *scene);
 
 /**
- * Sets scene dev_mode
+ * Sets scene dev_mode.
+ * In dev mode, scene_render() also draws each body's acceleration
+ * and the HUD of the profiler from tick_profiler().
+ * Turning dev mode on or off switches that profiler on or off.
  *
  * @param scene pointer to curr scene
  * @param dev_mode whether dev mode is on/off
@@ -130,6 +161,78 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer);
 
+/**
+ * Adds a force creator that checks a pair of bodies for a collision,
+ * like scene_add_bodies_force_creator(). Collision checks run after
+ * every other force creator, in a single pass that the profiler times
+ * as PROFILE_COLLISIONS; the per-pair counts are in the metrics
+ * (see METRIC_BROAD_PAIRS).
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param forcer a force creator function
+ * @param aux an auxiliary value to pass to forcer when it is called
+ * @param bodies the list of bodies affected by the force creator
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_collision_creator(scene_t *scene, force_creator_t forcer,
+                                 void *aux, list_t *bodies, free_func_t freer);
+
+/**
+ * Finds every body whose bounding box overlaps a box.
+ * Like the other scene queries, this is answered from the scene's spatial
+ * index, which is rebuilt lazily the first time it is queried after bodies
+ * have moved, so its cost depends on the size of the box, not on the number
+ * of bodies in the scene. Bodies marked for removal are never returned.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param box the box to query
+ * @param mask only bodies sharing a layer bit with the mask are returned;
+ *   use BODY_LAYER_ALL to match everything
+ * @param out the list to append the bodies to; it must not own its elements
+ * @return the number of bodies appended
+ */
+size_t scene_query_aabb(scene_t *scene, aabb_t box, uint32_t mask,
+                        list_t *out);
+
+/**
+ * Finds every body whose shape overlaps a circle.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @param mask only bodies sharing a layer bit with the mask are returned
+ * @param out the list to append the bodies to; it must not own its elements
+ * @return the number of bodies appended
+ */
+size_t scene_query_radius(scene_t *scene, vector_t center, double radius,
+                          uint32_t mask, list_t *out);
+
+/**
+ * Finds a body whose shape contains a point.
+ * If several bodies contain it, any one of them may be returned.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param point the point to test
+ * @param mask only bodies sharing a layer bit with the mask are considered
+ * @return the body containing the point, or NULL if there is none
+ */
+body_t *scene_query_point(scene_t *scene, vector_t point, uint32_t mask);
+
+/**
+ * Finds the first body hit by a line segment going from start to end.
+ * Only the index cells crossed by the segment are visited,
+ * stopping at the first cell that contains a hit.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @param mask only bodies sharing a layer bit with the mask are considered
+ * @param hit if non-NULL and a body was hit, filled in with the hit details
+ * @return whether any body was hit
+ */
+bool scene_raycast(scene_t *scene, vector_t start, vector_t end, uint32_t mask,
+                   raycast_hit_t *hit);
+
 /**
  * Draws all the bodies in a given scene
  *
@@ -137,10 +240,20 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
  */
 void scene_draw(scene_t *scene);
 
+/**
+ * Draws everything in a scene: the glows of glowing bodies,
+ * then the bodies (see scene_draw()), then the texts that haven't been
+ * removed. Doesn't change the scene, so it can be called any number of
+ * times between ticks. The frame still has to be shown with sdl_show().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_render(scene_t *scene);
+
 /**
  * Executes a tick of a given scene over a small time interval.
- * This requires executing all the force creators
- * and then ticking each body (see body_tick()).
+ * This requires executing all the force creators, then the collision
+ * checks, and then ticking each body (see body_tick()).
  * If any bodies are marked for removal, they should be removed from the scene
  * and freed, along with any force creators acting on them.
  *
@@ -151,8 +264,9 @@ void scene_tick(scene_t *scene, double dt);
 
 /**
  * Executes a canonical tick of a given scene over a small time interval.
- * This requires executing all the force creators
- * and then ticking each body (see body_tick()).
+ * This requires executing all the force creators,
+ * ticking each body (see body_tick()) and aging each text (see text_tick()).
+ * Draws nothing; see scene_render().
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param dt the time elapsed since the last tick, in seconds
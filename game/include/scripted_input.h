@@ -0,0 +1,98 @@
+#ifndef __SCRIPTED_INPUT_H__
+#define __SCRIPTED_INPUT_H__
+
+#include "sdl_wrapper.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A scripted input source for headless runs (see sdl_null.h):
+ * mouse moves and key events, each due on some tick,
+ * fed to sdl_null as the ticks go by.
+ *
+ * Scripts can be built in code or loaded from a text file with one event per
+ * line, where blank lines and lines starting with '#' are ignored:
+ * ```
+ * <tick> mouse <x> <y>
+ * <tick> press <key>
+ * <tick> release <key>
+ * <tick> quit
+ * ```
+ * A <key> is a single character or one of enter, space, left, up, right, down.
+ */
+typedef struct scripted_input scripted_input_t;
+
+/**
+ * Allocates an empty script.
+ *
+ * @return a pointer to the newly allocated script
+ */
+scripted_input_t *scripted_input_init(void);
+
+/**
+ * Loads a script from a file.
+ * Prints the offending line to stderr if the file can't be parsed.
+ *
+ * @param path the path of the script
+ * @return a pointer to the newly allocated script,
+ *   or NULL if the file couldn't be read or parsed
+ */
+scripted_input_t *scripted_input_load(const char *path);
+
+/**
+ * Releases the memory allocated for a script.
+ *
+ * @param input a pointer to a script returned from scripted_input_init()
+ *   or scripted_input_load()
+ */
+void scripted_input_free(scripted_input_t *input);
+
+/**
+ * Adds a mouse move to a script.
+ *
+ * @param input a pointer to a script
+ * @param tick the tick on which the mouse moves
+ * @param pos the new mouse position, in window pixels
+ */
+void scripted_input_add_mouse(scripted_input_t *input, size_t tick,
+                              vector_t pos);
+
+/**
+ * Adds a key event to a script.
+ *
+ * @param input a pointer to a script
+ * @param tick the tick on which the key event happens
+ * @param key the key, as passed to the key handler
+ * @param type whether the key is pressed or released
+ */
+void scripted_input_add_key(scripted_input_t *input, size_t tick, char key,
+                            key_event_type_t type);
+
+/**
+ * Adds closing the window to a script.
+ *
+ * @param input a pointer to a script
+ * @param tick the tick on which the window is closed
+ */
+void scripted_input_add_quit(scripted_input_t *input, size_t tick);
+
+/**
+ * Sends every event due on or before a tick that hasn't been sent yet.
+ * Events due on the same tick are sent in the order they were added.
+ * Call this once per tick, before the tick runs.
+ *
+ * @param input a pointer to a script
+ * @param tick the tick that is about to run
+ */
+void scripted_input_step(scripted_input_t *input, size_t tick);
+
+/**
+ * Returns whether every event in a script has been sent.
+ *
+ * @param input a pointer to a script
+ * @return true if there are no events left to send
+ */
+bool scripted_input_done(scripted_input_t *input);
+
+#endif // #ifndef __SCRIPTED_INPUT_H__
@@ -0,0 +1,42 @@
+#ifndef __SDL_NULL_H__
+#define __SDL_NULL_H__
+
+#include "sdl_wrapper.h"
+#include "vector.h"
+
+/**
+ * A headless implementation of sdl_wrapper.h.
+ * Linking sdl_null.o instead of sdl_wrapper.o runs a demo without a window,
+ * audio or SDL: drawing and sounds do nothing, time advances by a fixed step
+ * every frame, and input comes from the functions below instead of a user.
+ */
+
+/**
+ * Sets the step returned by time_since_last_tick(). Defaults to 1/60s.
+ *
+ * @param dt the number of seconds each frame simulates
+ */
+void sdl_null_set_tick(double dt);
+
+/**
+ * Moves the simulated mouse.
+ *
+ * @param pos the new mouse position, in window pixels
+ */
+void sdl_null_set_mouse(vector_t pos);
+
+/**
+ * Queues a key event, which is delivered to the key handler registered with
+ * sdl_on_key() by the next call to sdl_is_done(), like a real key press.
+ *
+ * @param key the key, as passed to the key handler
+ * @param type whether the key was pressed or released
+ */
+void sdl_null_send_key(char key, key_event_type_t type);
+
+/**
+ * Makes the next call to sdl_is_done() report that the window was closed.
+ */
+void sdl_null_quit(void);
+
+#endif // #ifndef __SDL_NULL_H__
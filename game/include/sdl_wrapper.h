@@ -1,10 +1,12 @@
 #ifndef __SDL_WRAPPER_H__
 #define __SDL_WRAPPER_H__
 
+#include "assets.h"
 #include "color.h"
 #include "scene.h"
 #include "list.h"
 #include "state.h"
+#include "vec_array.h"
 #include "vector.h"
 #include <stdbool.h>
 
@@ -52,6 +54,20 @@ void get_text_and_rect(void);
  */
 void sdl_init(vector_t min, vector_t max);
 
+/**
+ * Stops and joins the render and audio threads, then destroys the renderer
+ * and the window and shuts SDL down. Call it once, at exit, after the last
+ * frame has been shown.
+ */
+void sdl_quit(void);
+
+/**
+ * Gets the top-left corner of the scene passed to sdl_init().
+ *
+ * @return the x and y coordinates of the top left of the scene
+ */
+vector_t sdl_get_top_left(void);
+
 /**
  * Processes all SDL events and returns whether the window has been closed.
  * This function must be called in order to handle keypresses.
@@ -67,28 +83,105 @@ void sdl_clear(void);
 
 /**
  * Draws a polygon from the given list of vertices and a color.
+ * Convex polygons are queued as triangle fans and drawn together with the
+ * rest of the frame's untextured geometry in a few draw calls.
  *
- * @param points the list of vertices of the polygon
+ * @param points the array of vertices of the polygon
  * @param color the color used to fill in the polygon
  */
-void sdl_draw_polygon(list_t *points, color_t color);
+void sdl_draw_polygon(vec_array_t *points, color_t color);
+
+/**
+ * Draws many regular polygons of the same size and orientation.
+ * Cheaper than calling sdl_draw_polygon() once per polygon
+ * when drawing large numbers of small identical shapes (e.g. pellets),
+ * since the vertices are generated directly from the centers.
+ *
+ * @param centers the center of each polygon
+ * @param colors the fill color of each polygon
+ * @param n the number of polygons
+ * @param sides the number of vertices of each polygon (at least 3)
+ * @param radius the distance from each center to its vertices
+ */
+void sdl_draw_regular_polygons(const vector_t *centers, const color_t *colors,
+                               size_t n, size_t sides, double radius);
+
+/**
+ * Draws a soft glow around each of many points.
+ * Each glow is one quad textured with a glow sprite that is baked once for
+ * its radius, tinted with the glow's color and blended additively.
+ *
+ * @param centers the center of each glow
+ * @param colors the color of each glow
+ * @param n the number of glows
+ * @param radius the radius of the shape inside each glow
+ */
+void sdl_draw_glows(const vector_t *centers, const color_t *colors, size_t n,
+                    double radius);
+
+/**
+ * Queues a line of text to be drawn on top of the frame.
+ * Glyphs come from an atlas rendered once per font size,
+ * and all the text in a frame is drawn together by sdl_show().
+ *
+ * @param text the characters to draw
+ * @param center the center of the line, in scene coordinates
+ * @param height the height of the line
+ * @param char_width the width of each character
+ * @param color the color of the text
+ */
+void sdl_draw_text(const char *text, vector_t center, double height,
+                   double char_width, color_t color);
 
 /**
  * Displays the rendered frame on the SDL window.
- * Must be called after drawing the polygons in order to show them.
+ * Must be called exactly once per frame, after everything has been drawn.
+ *
+ * The sdl_draw_*() functions only record what to draw. On native builds,
+ * sdl_show() hands the recorded frame to a render thread and returns without
+ * waiting for it to be drawn or for vsync, then sleeps until the next frame
+ * is due (see sdl_set_frame_rate()). If the render thread couldn't be started,
+ * or in the browser, the frame is drawn before sdl_show() returns.
  */
 void sdl_show(void);
 
+/**
+ * Sets how many frames per second sdl_show() lets through on native builds.
+ * Defaults to 60. In the browser, the page's animation frames set the pace.
+ *
+ * @param frame_rate the number of frames per second
+ */
+void sdl_set_frame_rate(double frame_rate);
+
+/**
+ * Chooses whether sdl_init() starts a render thread on native builds,
+ * which it does by default. Without one, sdl_show() draws every frame
+ * before it returns, as in the browser.
+ * Must be called before sdl_init().
+ *
+ * @param enabled whether to render on a thread of its own
+ */
+void sdl_set_render_thread(bool enabled);
+
 /**
  * Draws all bodies in a scene.
- * This internally calls sdl_clear(), sdl_draw_polygon(), and sdl_show(),
- * so those functions should not be called directly.
+ * The frame still has to be shown with sdl_show().
  *
  * @param scene the scene to draw
  */
 void sdl_render_scene(scene_t *scene);
 
-void sdl_play_sound(int channel, char *path, int loops);
+/**
+ * Plays a sound. Does nothing if the sound's file couldn't be loaded.
+ * The sound is only queued, so this never waits on the mixer. Repeats of a
+ * sound in quick succession are dropped, and when too many sounds are
+ * playing the oldest is cut off (see sound_bank.h).
+ *
+ * @param channel the mixer channel to play on, or -1 for any free channel
+ * @param sound the id of the sound
+ * @param loops how many extra times to play the sound, or -1 to loop forever
+ */
+void sdl_play_sound(int channel, sound_id_t sound, int loops);
 
 /**
  * Registers a function to be called every time a key is pressed.
@@ -126,14 +219,12 @@ void sdl_on_key(key_handler_t handler);
  */
 double time_since_last_tick(void);
 
-list_t *sdl_prepare_text(char *text, vector_t center, double height, double width, color_t color);
-
-void sdl_move_text(list_t *l, vector_t pos, double height, double width);
-
-void sdl_render_text(list_t *l);
-
-void sdl_free_text(list_t *texture);
-
-void sdl_render_image();
+/**
+ * Draws an image stretched over the whole window.
+ * Does nothing if the image's file couldn't be loaded.
+ *
+ * @param image the id of the image
+ */
+void sdl_render_image(image_id_t image);
 
 #endif // #ifndef __SDL_WRAPPER_H__
@@ -1,26 +1,270 @@
 #ifndef __SERVER_H__
 #define __SERVER_H__
 
-#include "./list.h";
-
+#include "color.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
-typedef struct server
-{
-  list_t *clients;
-  uint16_t socket_id;
-  uint16_t ip;
-  uint16_t port;
-} server_t;
+/**
+ * A dedicated SLYCE server for Linux: it plays the game on the headless core
+ * (see sdl_null.h) and is the only authority on it, while clients send it
+ * their inputs and draw the snapshots it sends back.
+ *
+ * The server listens on one non-blocking UDP socket and waits on it with
+ * epoll, alongside a timerfd that fires at SERVER_TICK_RATE. Packets are
+ * drained as they arrive into a bounded input queue per client, a few
+ * batches per wake-up so that a flood cannot hold up the timer; on every
+ * timer expiry the server applies at most SERVER_INPUTS_PER_TICK inputs from
+ * each queue, ticks the game once, and sends every client a snapshot of the
+ * scene being played. If ticks were missed, up to SERVER_MAX_CATCH_UP of
+ * them are run back to back before a single snapshot goes out.
+ *
+ * The first SERVER_MAX_PLAYERS clients to say hello each control a player;
+ * the rest spectate, and their inputs are ignored. A client that has not
+ * sent anything for SERVER_CLIENT_TIMEOUT ticks is dropped, and its player
+ * lets go of whatever buttons it was holding.
+ *
+ * Since the game's state is global, only one server may be listening
+ * at a time, and no other driver may tick the game meanwhile.
+ */
+typedef struct server server_t;
+
+/**
+ * The number of ticks the server runs per second.
+ */
+#define SERVER_TICK_RATE 100
+
+/**
+ * The number of clients that control a player.
+ */
+#define SERVER_MAX_PLAYERS 4
+
+/**
+ * The most clients that may be connected at once, players included.
+ */
+#define SERVER_MAX_CLIENTS 256
+
+/**
+ * The number of ticks a client may stay silent before it is dropped.
+ */
+#define SERVER_CLIENT_TIMEOUT (5 * SERVER_TICK_RATE)
+
+/**
+ * The number of inputs a client's queue holds; more are dropped.
+ */
+#define SERVER_INPUT_QUEUE 32
+
+/**
+ * The most inputs applied from one client's queue per tick.
+ */
+#define SERVER_INPUTS_PER_TICK 4
+
+/**
+ * The most missed ticks run to catch up after a late wake-up.
+ */
+#define SERVER_MAX_CATCH_UP 5
+
+/**
+ * The largest packet the server sends or accepts, in bytes.
+ * Snapshots are split into chunks to stay under it.
+ */
+#define SERVER_MAX_PACKET 1400
+
+/**
+ * The slot of a client that spectates.
+ */
+#define SERVER_SPECTATOR 0xff
+
+/**
+ * The kinds of packet.
+ *
+ * Every packet starts with the 16-bit SERVER_PROTOCOL_MAGIC and its kind
+ * as a byte; the fields that follow are listed below. Integers are in
+ * network byte order, and floats are sent as their IEEE 754 bits in
+ * network byte order.
+ */
+typedef enum {
+  // client to server, to join or to keep a connection alive: no fields
+  SERVER_MSG_HELLO,
+  // client to server: u32 seq, u8 button, u8 pressed, f32 x, f32 y
+  SERVER_MSG_INPUT,
+  // client to server, to leave: no fields
+  SERVER_MSG_BYE,
+  // server to client, in answer to every hello: u8 slot, u16 tick rate
+  SERVER_MSG_WELCOME,
+  // server to client, once per tick per chunk: u32 tick, u16 number of
+  // bodies, u16 index of the chunk's first body, u16 bodies in the chunk,
+  // then for each body f32 x, f32 y, u8 r, u8 g, u8 b, u8 a
+  SERVER_MSG_SNAPSHOT,
+} server_message_type_t;
+
+/**
+ * The first two bytes of every packet.
+ */
+#define SERVER_PROTOCOL_MAGIC 0x534c
 
-server_t *server_init(uint16_t ip, uint16_t port);
+/**
+ * What an input does. A player's buttons are the four keys the player is
+ * bound to in the game; a mouse input moves the mouse, in window pixels.
+ */
+typedef enum {
+  SERVER_BUTTON_LEFT,
+  SERVER_BUTTON_RIGHT,
+  SERVER_BUTTON_BOOST,
+  SERVER_BUTTON_SHOOT,
+  SERVER_BUTTON_START,
+  SERVER_BUTTON_MOUSE,
+  SERVER_NUM_BUTTONS
+} server_button_t;
 
-void server_bind(server_t *s);
+/**
+ * A packet, as read by server_message_read() or written by
+ * server_message_write(). Only the fields of its kind are used.
+ */
+typedef struct {
+  server_message_type_t type;
 
-void server_listen(server_t *s);
+  // SERVER_MSG_INPUT: inputs are numbered from 1 by each client,
+  // and one that is not newer than the last the server saw is ignored
+  uint32_t seq;
+  server_button_t button;
+  bool pressed;
+  vector_t mouse;
 
-void *server_close(server_t *s);
+  // SERVER_MSG_WELCOME
+  uint8_t slot;
+  uint16_t tick_rate;
 
+  // SERVER_MSG_SNAPSHOT
+  uint32_t tick;
+  uint16_t num_bodies;
+  uint16_t first;
+  uint16_t count;
+  // the chunk's bodies, as sent; read them with server_message_body()
+  const uint8_t *bodies;
+} server_message_t;
+
+/**
+ * A body in a snapshot.
+ */
+typedef struct {
+  vector_t centroid;
+  color_t color;
+} server_body_t;
+
+/**
+ * Statistics of a server since it was bound.
+ */
+typedef struct {
+  size_t ticks;
+  // ticks that were due but neither run on time nor caught up on
+  size_t ticks_skipped;
+  size_t clients;
+  size_t packets_received;
+  size_t packets_sent;
+  // packets that were malformed, came from a client that had not said
+  // hello, or said hello when the server was full
+  size_t packets_rejected;
+  // inputs dropped because their client's queue was full
+  size_t inputs_dropped;
+  // snapshot chunks not sent because the socket's buffer was full
+  size_t sends_dropped;
+} server_stats_t;
+
+/**
+ * Allocates a server that is not yet bound.
+ *
+ * @param ip the IPv4 address to listen on, in host byte order,
+ *   e.g. INADDR_LOOPBACK or INADDR_ANY
+ * @param port the UDP port to listen on, or 0 for any free port
+ * @return a pointer to the newly allocated server
+ */
+server_t *server_init(uint32_t ip, uint16_t port);
+
+/**
+ * Opens the server's socket, timer and epoll instance,
+ * and starts the game. Prints why to stderr if it fails,
+ * in which case the server can only be freed.
+ *
+ * @param s a pointer to a server returned from server_init()
+ * @return whether the server was bound
+ */
+bool server_bind(server_t *s);
+
+/**
+ * Gets the port a bound server listens on,
+ * which is the one chosen by the system if it was given port 0.
+ *
+ * @param s a pointer to a bound server
+ * @return the port, in host byte order
+ */
+uint16_t server_get_port(server_t *s);
+
+/**
+ * Runs a bound server's loop until server_close() is called
+ * or it has run a number of ticks.
+ *
+ * @param s a pointer to a bound server
+ * @param max_ticks the number of ticks to stop after, or 0 to never stop
+ */
+void server_listen(server_t *s, size_t max_ticks);
+
+/**
+ * Makes server_listen() return as soon as it wakes up.
+ * Safe to call from another thread or a signal handler.
+ *
+ * @param s a pointer to a bound server
+ */
+void server_close(server_t *s);
+
+/**
+ * Gets a server's statistics. Must not be called while it is listening
+ * on another thread.
+ *
+ * @param s a pointer to a server returned from server_init()
+ * @return the statistics
+ */
+server_stats_t server_get_stats(server_t *s);
+
+/**
+ * Stops the game and releases the memory and descriptors of a server.
+ * Must not be called while it is listening.
+ *
+ * @param s a pointer to a server returned from server_init()
+ */
 void server_free(server_t *s);
 
-#endif
\ No newline at end of file
+/**
+ * Writes a hello, input, bye or welcome packet.
+ *
+ * @param message the packet to write
+ * @param packet the buffer to write it to, of SERVER_MAX_PACKET bytes
+ * @return the length of the packet
+ */
+size_t server_message_write(const server_message_t *message, uint8_t *packet);
+
+/**
+ * Reads a packet of any kind.
+ *
+ * @param message the message to read it into; a snapshot's bodies
+ *   point into the packet
+ * @param packet the packet
+ * @param size the length of the packet
+ * @return whether it was a well-formed packet
+ */
+bool server_message_read(server_message_t *message, const uint8_t *packet,
+                         size_t size);
+
+/**
+ * Gets a body of a snapshot chunk read by server_message_read().
+ *
+ * @param message a snapshot
+ * @param index the index of the body within the chunk, less than its count
+ * @return the body
+ */
+server_body_t server_message_body(const server_message_t *message,
+                                  size_t index);
+
+#endif // #ifndef __SERVER_H__
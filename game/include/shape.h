@@ -0,0 +1,106 @@
+#ifndef __SHAPE_H__
+#define __SHAPE_H__
+
+#include "polygon.h"
+#include "vec_array.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * An immutable polygon mesh in local space (centered on its centroid),
+ * together with its precomputed metadata (see polygon_meta_init()).
+ * Bodies reference a shape plus their own position and rotation,
+ * so many bodies with the same outline can share one mesh.
+ *
+ * Shapes are reference counted. Builders like shape_circle() return shared
+ * prototypes from a registry, so asking twice for the same circle returns
+ * the same shape.
+ */
+typedef struct shape shape_t;
+
+/**
+ * Gets the shared prototype of a regular polygon inscribed in a circle,
+ * with its first vertex on the positive x axis (like make_circle()).
+ * The caller receives a new reference and must shape_release() it.
+ *
+ * @param num_points the number of vertices
+ * @param radius the distance from the center to each vertex
+ * @return the prototype
+ */
+shape_t *shape_circle(size_t num_points, double radius);
+
+/**
+ * Gets the shared prototype of an axis-aligned rectangle.
+ * The caller receives a new reference and must shape_release() it.
+ *
+ * @param width the width of the rectangle
+ * @param height the height of the rectangle
+ * @return the prototype
+ */
+shape_t *shape_rectangle(double width, double height);
+
+/**
+ * Makes a new, unshared shape out of an arbitrary polygon.
+ * Takes ownership of the polygon, which is translated in place so that its
+ * centroid is at the origin.
+ * The caller receives the only reference and must shape_release() it.
+ *
+ * @param polygon a list of vectors, as accepted by polygon_meta_init()
+ * @return the new shape
+ */
+shape_t *shape_from_polygon(vec_array_t *polygon);
+
+/**
+ * Adds a reference to a shape.
+ *
+ * @param shape a shape
+ * @return the same shape, for convenience
+ */
+shape_t *shape_retain(shape_t *shape);
+
+/**
+ * Drops a reference to a shape, freeing it when the last one is gone.
+ *
+ * @param shape a shape
+ */
+void shape_release(shape_t *shape);
+
+/**
+ * Gets the shape's vertices, relative to its centroid.
+ * The array belongs to the shape and must not be modified.
+ *
+ * @param shape a shape
+ * @return the local vertices
+ */
+vec_array_t *shape_get_vertices(shape_t *shape);
+
+/**
+ * Places a copy of the shape's vertices in the world.
+ *
+ * @param shape a shape
+ * @param centroid where to put the shape's local origin
+ * @param angle how far to rotate the shape about its local origin
+ * @param arena the arena to allocate the copy from (see arena.h),
+ *   or NULL to allocate it with malloc
+ * @return the world-space vertices, to be vec_array_free()d
+ */
+vec_array_t *shape_place(shape_t *shape, vector_t centroid, double angle,
+                         arena_t *arena);
+
+/**
+ * Gets the shape's precomputed metadata.
+ * Its axes are relative to the shape's local orientation.
+ *
+ * @param shape a shape
+ * @return the metadata, owned by the shape
+ */
+polygon_meta_t *shape_get_meta(shape_t *shape);
+
+/**
+ * Drops the registry's references to every prototype.
+ * Prototypes still used by bodies stay alive until those bodies are freed;
+ * later requests for a prototype create a fresh one.
+ */
+void shape_registry_free(void);
+
+#endif // #ifndef __SHAPE_H__
@@ -0,0 +1,120 @@
+#ifndef __SOUND_BANK_H__
+#define __SOUND_BANK_H__
+
+#include "assets.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Schedules sound playback so that gameplay code never waits on the mixer.
+ *
+ * The game thread pushes play commands with sound_bank_push(). Repeats of a
+ * sound within its cooldown are dropped there, so a burst of collisions in one
+ * tick only plays the sound once. Commands go through a fixed-size
+ * lock-free queue with one producer and one consumer. An audio thread pops
+ * them with sound_bank_pop() and uses sound_bank_assign_voice() to pick a
+ * mixer channel from a fixed pool of voices. When every voice is busy, the
+ * voice that started playing longest ago is stolen.
+ *
+ * sound_bank_push() must only be called from one thread,
+ * and sound_bank_pop() and sound_bank_assign_voice() from one other thread
+ * (or the same one).
+ */
+typedef struct sound_bank sound_bank_t;
+
+/**
+ * A request to play a sound.
+ */
+typedef struct {
+  sound_id_t sound;
+  // the mixer channel to play on, or -1 to use a voice from the pool
+  int channel;
+  // how many extra times to play the sound, or -1 to loop forever
+  int loops;
+} sound_command_t;
+
+/**
+ * Allocates a sound bank with an empty queue and every voice free.
+ *
+ * @param first_voice the mixer channel of the first voice; the channels
+ *   below it are left for commands that ask for a specific channel
+ * @param num_voices the number of voices in the pool
+ * @param cooldown the default time, in seconds, before a sound can be
+ *   queued again
+ * @return a pointer to the newly allocated sound bank
+ */
+sound_bank_t *sound_bank_init(int first_voice, size_t num_voices,
+                              double cooldown);
+
+/**
+ * Releases the memory allocated for a sound bank.
+ *
+ * @param bank a pointer to a sound bank returned from sound_bank_init()
+ */
+void sound_bank_free(sound_bank_t *bank);
+
+/**
+ * Sets how long a sound has to wait before it can be queued again.
+ *
+ * @param bank a pointer to a sound bank returned from sound_bank_init()
+ * @param sound the id of the sound
+ * @param cooldown the cooldown, in seconds
+ */
+void sound_bank_set_cooldown(sound_bank_t *bank, sound_id_t sound,
+                             double cooldown);
+
+/**
+ * Sets how long a sound plays for, which is how long it keeps a voice busy.
+ * Sounds whose length was never set are treated as instantaneous.
+ *
+ * @param bank a pointer to a sound bank returned from sound_bank_init()
+ * @param sound the id of the sound
+ * @param length the length of the sound, in seconds
+ */
+void sound_bank_set_length(sound_bank_t *bank, sound_id_t sound,
+                           double length);
+
+/**
+ * Queues a command to play a sound, unless the same sound was queued less
+ * than its cooldown ago or the queue is full. Never blocks.
+ *
+ * @param bank a pointer to a sound bank returned from sound_bank_init()
+ * @param command the sound to play
+ * @param now the current time, in seconds
+ * @return whether the command was queued
+ */
+bool sound_bank_push(sound_bank_t *bank, sound_command_t command, double now);
+
+/**
+ * Takes the oldest command off the queue. Never blocks.
+ *
+ * @param bank a pointer to a sound bank returned from sound_bank_init()
+ * @param command set to the command that was taken off the queue
+ * @return whether there was a command to take
+ */
+bool sound_bank_pop(sound_bank_t *bank, sound_command_t *command);
+
+/**
+ * Picks the mixer channel a popped command should play on, and marks it busy.
+ * Commands that ask for a specific channel get that channel. Otherwise a
+ * free voice is used, or the voice that started longest ago is stolen.
+ * Voices playing a sound that loops forever are stolen last.
+ *
+ * @param bank a pointer to a sound bank returned from sound_bank_init()
+ * @param command a command returned from sound_bank_pop()
+ * @param now the current time, in seconds
+ * @return the mixer channel to play the command's sound on
+ */
+int sound_bank_assign_voice(sound_bank_t *bank, sound_command_t command,
+                            double now);
+
+/**
+ * Gets the number of commands dropped by sound_bank_push(),
+ * because of cooldowns or a full queue.
+ *
+ * @param bank a pointer to a sound bank returned from sound_bank_init()
+ * @return the number of dropped commands
+ */
+size_t sound_bank_get_dropped(sound_bank_t *bank);
+
+#endif // #ifndef __SOUND_BANK_H__
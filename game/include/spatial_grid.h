@@ -0,0 +1,118 @@
+#ifndef __SPATIAL_GRID_H__
+#define __SPATIAL_GRID_H__
+
+#include "aabb.h"
+#include "list.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * A spatial hash: an unbounded uniform grid of cells, hashed into a fixed
+ * number of buckets, that indexes items by their bounding boxes.
+ * Box queries only visit the cells the box overlaps, so they cost
+ * O(c + k) for c cells and k results instead of a scan over every item.
+ *
+ * The grid does not own its items. Each insertion returns a handle, with
+ * which an item that moved can be re-inserted, or removed, on its own,
+ * at the cost of the cells its old and new boxes overlap.
+ */
+typedef struct spatial_grid spatial_grid_t;
+
+/**
+ * Tests an item against a ray.
+ *
+ * @param item an item that was inserted into the grid
+ * @param aux the auxiliary value passed to spatial_grid_raycast()
+ * @return the fraction (between 0 and 1) along the ray at which it hits
+ *   the item, or INFINITY if it misses
+ */
+typedef double (*spatial_ray_test_t)(void *item, void *aux);
+
+/**
+ * Allocates an empty grid.
+ *
+ * @param cell_size the side length of each cell; a good value is around the
+ *   size of a typical item
+ * @return a pointer to the newly allocated grid
+ */
+spatial_grid_t *spatial_grid_init(double cell_size);
+
+/**
+ * Releases the memory allocated for a grid. Does not free the items.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ */
+void spatial_grid_free(spatial_grid_t *grid);
+
+/**
+ * Removes every item from the grid, keeping its memory for reuse.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ */
+void spatial_grid_clear(spatial_grid_t *grid);
+
+/**
+ * Gets the number of items in the grid.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @return the number of items in the grid
+ */
+size_t spatial_grid_size(spatial_grid_t *grid);
+
+/**
+ * Inserts an item into every cell its bounding box overlaps.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @param item the item to insert (must be non-NULL)
+ * @param box the item's bounding box
+ * @return the item's handle, valid until it is removed or the grid is cleared
+ */
+size_t spatial_grid_insert(spatial_grid_t *grid, void *item, aabb_t box);
+
+/**
+ * Changes the bounding box of an item in the grid.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @param handle the item's handle, returned from spatial_grid_insert()
+ * @param box the item's new bounding box
+ */
+void spatial_grid_move(spatial_grid_t *grid, size_t handle, aabb_t box);
+
+/**
+ * Removes an item from the grid. Its handle may be reused by later inserts.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @param handle the item's handle, returned from spatial_grid_insert()
+ */
+void spatial_grid_remove(spatial_grid_t *grid, size_t handle);
+
+/**
+ * Appends to a list every item whose bounding box overlaps the given box.
+ * Each item is appended at most once.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @param box the box to query
+ * @param out the list to append results to; it must not own its elements
+ * @return the number of items appended
+ */
+size_t spatial_grid_query(spatial_grid_t *grid, aabb_t box, list_t *out);
+
+/**
+ * Walks the cells crossed by a line segment in order from start to end,
+ * testing each item found there at most once,
+ * and stops as soon as no later cell can contain a closer hit.
+ *
+ * @param grid a pointer to a grid returned from spatial_grid_init()
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @param test the function used to intersect the ray with an item
+ * @param aux an auxiliary value to pass to test
+ * @param fraction if non-NULL, set to the fraction along the segment
+ *   of the closest hit (INFINITY if nothing was hit)
+ * @return the closest item hit, or NULL if nothing was hit
+ */
+void *spatial_grid_raycast(spatial_grid_t *grid, vector_t start, vector_t end,
+                           spatial_ray_test_t test, void *aux,
+                           double *fraction);
+
+#endif // #ifndef __SPATIAL_GRID_H__
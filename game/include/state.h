@@ -1,5 +1,6 @@
 #ifndef __STATE_H__
 #define __STATE_H__
+#include "scene.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -31,4 +32,10 @@ void emscripten_main(state_t *state);
  */
 void emscripten_free(state_t *state);
 
+/**
+ * Gets the scene being played (a menu, or the game itself),
+ * for drivers that show it somewhere else, like the server in server.h.
+ */
+scene_t *emscripten_get_scene(state_t *state);
+
 #endif // #ifndef __STATE_H__
\ No newline at end of file
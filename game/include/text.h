@@ -8,12 +8,30 @@ typedef struct text {
   double width;
   color_t color;
   double duration;
-  list_t *texture;
   bool removed;
 } text_t;
 
+/**
+ * Allocates a text label.
+ *
+ * @param text a malloc()ed string, which the label takes ownership of
+ * @param center where to draw the label
+ * @param height the height of the label
+ * @param width the width of each character
+ * @param color the color of the label
+ * @param duration how long the label lives before it removes itself,
+ *   or INFINITY to keep it until text_remove() is called
+ * @return a pointer to the newly allocated label
+ */
 text_t *text_init(char *text, vector_t center, double height, double width, color_t color, double duration);
 
+/**
+ * Changes what a label says. The label keeps its own copy of the string,
+ * so the caller still owns new.
+ *
+ * @param t a pointer to a label returned from text_init()
+ * @param new the label's new contents
+ */
 void text_edit(text_t *t, char *new);
 
 void text_set_color(text_t *t, color_t new_color);
@@ -24,6 +42,10 @@ void text_render(text_t *t);
 
 void text_remove(text_t *t);
 
+/**
+ * Ages a text by dt, removing it once its duration runs out.
+ * Does not draw it; see text_render().
+ */
 void text_tick(text_t *t, double dt);
 
 void text_free(void *t);
@@ -0,0 +1,121 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Records spans of time (a scene phase, one force creator, one collision
+ * handler) into a ring buffer, and writes them out as Chrome trace-event
+ * JSON, which chrome://tracing and ui.perfetto.dev can open.
+ *
+ * Spans are opened and closed with matching trace_begin() and trace_end()
+ * calls, which may nest. When the buffer is full, the oldest spans are
+ * overwritten, so a dump always holds the most recent frames.
+ * trace_end_frame() closes a frame; if the frame took longer than the
+ * slow-frame threshold, the buffer is dumped to a file right away.
+ *
+ * Spans for callbacks are named after the callback's function.
+ * On Linux the name is looked up with dladdr(), which only finds functions
+ * exported by the executable (link with -rdynamic); otherwise, and
+ * everywhere else, the span is named after the function's address.
+ *
+ * Every function accepts a NULL tracer and does nothing with it,
+ * so code can be instrumented with tick_tracer(), which is NULL
+ * unless tracing has been switched on. A tracer must only be used
+ * from one thread.
+ */
+typedef struct tracer tracer_t;
+
+/**
+ * Allocates a tracer with an empty buffer and no slow-frame threshold.
+ *
+ * @param capacity the number of spans the buffer holds
+ * @return a pointer to the newly allocated tracer
+ */
+tracer_t *tracer_init(size_t capacity);
+
+/**
+ * Releases the memory allocated for a tracer.
+ *
+ * @param tracer a pointer to a tracer returned from tracer_init()
+ */
+void tracer_free(tracer_t *tracer);
+
+/**
+ * Dumps the buffer whenever a frame takes longer than a threshold,
+ * to "<prefix>-<frame number>.json". At most a few slow frames are dumped,
+ * so a game that is always slow does not fill the disk.
+ *
+ * @param tracer a pointer to a tracer returned from tracer_init()
+ * @param threshold_ms the longest a frame may take, in milliseconds,
+ *   or 0 to never dump on a slow frame
+ * @param prefix the start of the dumps' paths
+ */
+void tracer_set_slow_frame(tracer_t *tracer, double threshold_ms,
+                           const char *prefix);
+
+/**
+ * Opens a span with a fixed name.
+ *
+ * @param tracer a pointer to a tracer returned from tracer_init()
+ * @param category the kind of span, e.g. "phase"
+ * @param name the span's name; must outlive the tracer
+ */
+void trace_begin(tracer_t *tracer, const char *category, const char *name);
+
+/**
+ * Opens a span for a call to a function, named after the function.
+ *
+ * @param tracer a pointer to a tracer returned from tracer_init()
+ * @param category the kind of span, e.g. "force"
+ * @param function the address of the function being called
+ */
+void trace_begin_call(tracer_t *tracer, const char *category,
+                      const void *function);
+
+/**
+ * Closes the span opened by the last unmatched trace_begin()
+ * or trace_begin_call(), and adds it to the buffer.
+ *
+ * @param tracer a pointer to a tracer returned from tracer_init()
+ */
+void trace_end(tracer_t *tracer);
+
+/**
+ * Adds a span for the frame that just ended, covering the time since the
+ * previous call (or since the tracer was allocated), and dumps the buffer
+ * if the frame was slow. Asserts that no span is still open.
+ *
+ * @param tracer a pointer to a tracer returned from tracer_init()
+ */
+void trace_end_frame(tracer_t *tracer);
+
+/**
+ * Writes every span in the buffer to a file as Chrome trace-event JSON,
+ * oldest first. Spans that are still open are left out.
+ *
+ * @param tracer a pointer to a tracer returned from tracer_init()
+ * @param path the file to write
+ * @return whether the file was written
+ */
+bool tracer_dump(tracer_t *tracer, const char *path);
+
+/**
+ * Gets the tracer that the engine reports its spans to.
+ *
+ * @return the tracer, or NULL if tracing is switched off
+ */
+tracer_t *tick_tracer(void);
+
+/**
+ * Switches the engine's tracer on or off.
+ * Switching it on starts with an empty buffer;
+ * switching it off frees the tracer without dumping it.
+ * Must not be called while a span is open.
+ *
+ * @param enabled whether to trace
+ */
+void tick_tracer_set_enabled(bool enabled);
+
+#endif // #ifndef __TRACE_H__
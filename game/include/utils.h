@@ -3,6 +3,7 @@
 #include "color.h"
 #include "list.h"
 #include "body.h"
+#include "vec_array.h"
 #include "vector.h"
 #include <math.h>
 #include <stdlib.h>
@@ -18,8 +19,8 @@ color_t rand_color(double alpha);
 
 color_t rainbow_color(double n, double m);
 
-list_t *make_circle(size_t num_points, size_t length, vector_t center);
+vec_array_t *make_circle(size_t num_points, size_t length, vector_t center);
 
-list_t *make_rectangle(double width, double height, vector_t center);
+vec_array_t *make_rectangle(double width, double height, vector_t center);
 
 #endif // #ifndef __CUSTOM_UTILS_H__
\ No newline at end of file
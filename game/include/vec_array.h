@@ -0,0 +1,127 @@
+#ifndef __VEC_ARRAY_H__
+#define __VEC_ARRAY_H__
+
+#include "arena.h"
+#include "list.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * A growable array of vectors stored by value.
+ * Unlike a list_t of vector_t*, the vectors sit next to each other in one
+ * allocation, so there is one malloc per array instead of one per vertex
+ * and loops over the vertices are linear scans.
+ */
+typedef struct vec_array vec_array_t;
+
+/**
+ * Allocates memory for a new, empty array with space for the given number of
+ * vectors. Asserts that the required memory was allocated.
+ *
+ * @param initial_capacity the number of vectors to allocate space for
+ * @return a pointer to the newly allocated array
+ */
+vec_array_t *vec_array_init(size_t initial_capacity);
+
+/**
+ * Allocates a new, empty array inside an arena (see arena.h).
+ * The array and its vectors live until the arena is reset,
+ * and calling vec_array_free() on it does nothing.
+ *
+ * @param arena the arena to allocate from
+ * @param initial_capacity the number of vectors to allocate space for
+ * @return a pointer to the newly allocated array
+ */
+vec_array_t *vec_array_init_in(arena_t *arena, size_t initial_capacity);
+
+/**
+ * Releases the memory allocated for an array.
+ * Takes a void* so it can be used as a free_func_t.
+ *
+ * @param array a pointer to an array returned from vec_array_init()
+ */
+void vec_array_free(void *array);
+
+/**
+ * Gets the number of vectors in an array.
+ *
+ * @param array a pointer to an array returned from vec_array_init()
+ * @return the number of vectors in the array
+ */
+size_t vec_array_size(vec_array_t *array);
+
+/**
+ * Gets the vector at a given index in an array.
+ * Asserts that the index is valid, given the array's current size.
+ *
+ * @param array a pointer to an array returned from vec_array_init()
+ * @param index an index in the array (the first vector is at 0)
+ * @return the vector at the given index
+ */
+vector_t vec_array_get(vec_array_t *array, size_t index);
+
+/**
+ * Replaces the vector at a given index in an array.
+ * Asserts that the index is valid, given the array's current size.
+ *
+ * @param array a pointer to an array returned from vec_array_init()
+ * @param index an index in the array
+ * @param value the new vector
+ */
+void vec_array_set(vec_array_t *array, size_t index, vector_t value);
+
+/**
+ * Appends a vector to the end of an array, growing it if needed.
+ *
+ * @param array a pointer to an array returned from vec_array_init()
+ * @param value the vector to add
+ */
+void vec_array_add(vec_array_t *array, vector_t value);
+
+/**
+ * Gets the array's contiguous storage, for tight loops over its vectors.
+ * The pointer is invalidated by the next vec_array_add().
+ *
+ * @param array a pointer to an array returned from vec_array_init()
+ * @return a pointer to the first of vec_array_size() vectors
+ */
+vector_t *vec_array_data(vec_array_t *array);
+
+/**
+ * Allocates a copy of an array.
+ *
+ * @param array a pointer to an array returned from vec_array_init()
+ * @return a pointer to the newly allocated copy
+ */
+vec_array_t *vec_array_copy(vec_array_t *array);
+
+/**
+ * Allocates a copy of an array inside an arena.
+ *
+ * @param arena the arena to allocate from, or NULL to use malloc
+ * @param array a pointer to an array returned from vec_array_init()
+ * @return a pointer to the newly allocated copy
+ */
+vec_array_t *vec_array_copy_in(arena_t *arena, vec_array_t *array);
+
+/**
+ * Copies a list of vector_t* into a new array.
+ * A compatibility shim for code that still builds polygons as lists;
+ * the list is left untouched and must still be freed by the caller.
+ *
+ * @param points a list of vector_t*
+ * @return a pointer to the newly allocated array
+ */
+vec_array_t *vec_array_from_list(list_t *points);
+
+/**
+ * Copies an array into a new list of individually allocated vector_t*.
+ * A compatibility shim for code that still expects polygons as lists;
+ * the list owns its vectors and must be list_free()d.
+ *
+ * @param array a pointer to an array returned from vec_array_init()
+ * @return a pointer to the newly allocated list
+ */
+list_t *vec_array_to_list(vec_array_t *array);
+
+#endif // #ifndef __VEC_ARRAY_H__
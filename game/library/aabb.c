@@ -0,0 +1,27 @@
+#include "aabb.h"
+#include <math.h>
+
+bool aabb_overlaps(aabb_t a, aabb_t b) {
+  return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y &&
+         a.max.y >= b.min.y;
+}
+
+bool aabb_contains_point(aabb_t box, vector_t point) {
+  return point.x >= box.min.x && point.x <= box.max.x && point.y >= box.min.y &&
+         point.y <= box.max.y;
+}
+
+aabb_t aabb_expand(aabb_t box, double margin) {
+  return (aabb_t){.min = {box.min.x - margin, box.min.y - margin},
+                  .max = {box.max.x + margin, box.max.y + margin}};
+}
+
+aabb_t aabb_from_circle(vector_t center, double radius) {
+  return (aabb_t){.min = {center.x - radius, center.y - radius},
+                  .max = {center.x + radius, center.y + radius}};
+}
+
+aabb_t aabb_from_segment(vector_t start, vector_t end) {
+  return (aabb_t){.min = {fmin(start.x, end.x), fmin(start.y, end.y)},
+                  .max = {fmax(start.x, end.x), fmax(start.y, end.y)}};
+}
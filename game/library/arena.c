@@ -0,0 +1,123 @@
+#include "arena.h"
+#include "metrics.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdlib.h>
+
+const size_t ARENA_ALIGNMENT = alignof(max_align_t);
+const size_t FRAME_ARENA_CAPACITY = 1 << 16;
+
+typedef struct arena_block {
+  struct arena_block *next;
+  size_t capacity;
+  size_t used;
+  alignas(max_align_t) char data[];
+} arena_block_t;
+
+typedef struct arena {
+  arena_block_t *block;
+  // blocks that allocations spilled into since the last reset
+  arena_block_t *overflow;
+  size_t spilled;
+  size_t malloc_count;
+} arena_t;
+
+arena_t *frame_arena_instance = NULL;
+
+arena_block_t *arena_block_init(arena_t *arena, size_t capacity) {
+  arena_block_t *block = malloc(sizeof(arena_block_t) + capacity);
+  assert(block != NULL);
+  block->next = NULL;
+  block->capacity = capacity;
+  block->used = 0;
+  arena->malloc_count++;
+  metrics_add(METRIC_ALLOCS_ARENA, 1);
+  return block;
+}
+
+arena_t *arena_init(size_t capacity) {
+  arena_t *arena = malloc(sizeof(arena_t));
+  assert(arena != NULL);
+  metrics_add(METRIC_ALLOCS_ARENA, 1);
+  arena->malloc_count = 0;
+  arena->block = arena_block_init(arena, capacity);
+  arena->overflow = NULL;
+  arena->spilled = 0;
+  return arena;
+}
+
+void arena_free_overflow(arena_t *arena) {
+  while (arena->overflow != NULL) {
+    arena_block_t *next = arena->overflow->next;
+    free(arena->overflow);
+    arena->overflow = next;
+  }
+}
+
+void arena_free(arena_t *arena) {
+  arena_free_overflow(arena);
+  free(arena->block);
+  free(arena);
+}
+
+/** Bumps a block's pointer, or returns NULL if the block is too full */
+void *arena_block_alloc(arena_block_t *block, size_t size) {
+  size_t start = (block->used + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+  if (start + size > block->capacity) {
+    return NULL;
+  }
+  block->used = start + size;
+  return block->data + start;
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+  void *memory = arena_block_alloc(arena->block, size);
+  if (memory == NULL && arena->overflow != NULL) {
+    memory = arena_block_alloc(arena->overflow, size);
+  }
+  if (memory == NULL) {
+    size_t capacity =
+        size > arena->block->capacity ? size : arena->block->capacity;
+    arena_block_t *block = arena_block_init(arena, capacity);
+    block->next = arena->overflow;
+    arena->overflow = block;
+    arena->spilled += capacity;
+    memory = arena_block_alloc(block, size);
+  }
+  return memory;
+}
+
+void arena_reset(arena_t *arena) {
+  if (arena->overflow != NULL) {
+    // make the main block big enough to hold everything next time
+    size_t capacity = arena->block->capacity + arena->spilled;
+    arena_free_overflow(arena);
+    arena->spilled = 0;
+    free(arena->block);
+    arena->block = arena_block_init(arena, capacity);
+  }
+  arena->block->used = 0;
+}
+
+size_t arena_get_used(arena_t *arena) {
+  size_t used = arena->block->used;
+  for (arena_block_t *b = arena->overflow; b != NULL; b = b->next) {
+    used += b->used;
+  }
+  return used;
+}
+
+size_t arena_get_malloc_count(arena_t *arena) { return arena->malloc_count; }
+
+arena_t *frame_arena(void) {
+  if (frame_arena_instance == NULL) {
+    frame_arena_instance = arena_init(FRAME_ARENA_CAPACITY);
+  }
+  return frame_arena_instance;
+}
+
+void frame_arena_reset(void) {
+  if (frame_arena_instance != NULL) {
+    arena_reset(frame_arena_instance);
+  }
+}
@@ -0,0 +1,35 @@
+#include "assets.h"
+#include <assert.h>
+
+const char *const ASSET_SOUND_PATHS[NUM_SOUNDS] = {
+    [SOUND_BULLET_HIT] = "assets/bullet_hit.wav",
+    [SOUND_COLLIDE] = "assets/collide.wav",
+    [SOUND_DASH] = "assets/dash.wav",
+    [SOUND_DEATH_DMG] = "assets/death_dmg.wav",
+    [SOUND_DEATH_SCREAM] = "assets/death_scream.wav",
+    [SOUND_GAME_START] = "assets/game_start.wav",
+    [SOUND_MENU_ERROR] = "assets/menu_error.wav",
+    [SOUND_MENU_MOVE] = "assets/menu_move.wav",
+    [SOUND_MENU_SELECT] = "assets/menu_select.wav",
+    [SOUND_PU_BASE_SPEED] = "assets/pu_base_speed.wav",
+    [SOUND_PU_BULLET_SPEED] = "assets/pu_bullet_speed.wav",
+    [SOUND_PU_DASH_BOOST] = "assets/pu_dash_boost.wav",
+    [SOUND_PU_ROTATE_RATE] = "assets/pu_rotate_rate.wav",
+    [SOUND_RESPAWN] = "assets/respawn.wav",
+    [SOUND_SHOOT] = "assets/shoot.wav",
+    [SOUND_SOUNDTRACK] = "assets/soundtrack.wav",
+};
+
+const char *const ASSET_IMAGE_PATHS[NUM_IMAGES] = {
+    [IMAGE_BACKGROUND] = "assets/background.bmp",
+};
+
+const char *asset_sound_path(sound_id_t sound) {
+  assert(sound < NUM_SOUNDS);
+  return ASSET_SOUND_PATHS[sound];
+}
+
+const char *asset_image_path(image_id_t image) {
+  assert(image < NUM_IMAGES);
+  return ASSET_IMAGE_PATHS[image];
+}
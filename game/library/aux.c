@@ -1,13 +1,21 @@
 #include "aux.h"
 #include "list.h"
+#include "pool.h"
+
+const size_t AUX_POOL_SLAB_COUNT = 256;
 
 typedef struct aux {
   list_t *constants;
   list_t *bodies;
 } aux_t;
 
+/** Where every aux is allocated from */
+pool_t *aux_pool = NULL;
+
 aux_t *aux_init(list_t *constants, list_t *bodies) {
-  aux_t *aux = malloc(sizeof(aux_t));
+  pool_t *pool =
+      pool_get_shared(&aux_pool, sizeof(aux_t), AUX_POOL_SLAB_COUNT);
+  aux_t *aux = pool_alloc(pool);
   aux->constants = constants;
   aux->bodies = bodies;
   return aux;
@@ -22,7 +30,7 @@ void aux_free(void *aux) {
   if (aux_casted->constants != NULL) {
     list_free(aux_casted->constants);
   }
-
-  list_free(aux_casted->bodies);
-  free(aux_casted);
+  // bodies is the same list the force creator was registered with,
+  // which the force frees
+  pool_release(aux_pool, aux_casted);
 }
\ No newline at end of file
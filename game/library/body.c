@@ -1,9 +1,14 @@
 #include "body.h"
 
+#include "arena.h"
 #include "collision.h"
 #include "color.h"
 #include "polygon.h"
+#include "pool.h"
+#include "metrics.h"
+#include "profiler.h"
 #include "sdl_wrapper.h"
+#include "shape.h"
 #include "vector.h"
 #include "utils.h"
 #include <assert.h>
@@ -17,15 +22,20 @@ const double DEV_MODE_VECTOR_THICKNESS = 1;
 color_t DEV_MODE_VEL_COLOR = (color_t){.r = 0, .g = 1, .b = 0, .a = 1};
 color_t DEV_MODE_ACL_COLOR = (color_t){.r = 1, .g = 0, .b = 0, .a = 1};
 
-const double GLOW_SCALE = 0.1;
-const size_t GLOW_FACTOR = 8;
-const double GLOW_REDUCTION = 0.8;
-const double GLOW_RESOLUTION = 10;
-const double GLOW_INCREASE = 3;
+
+const uint32_t BODY_LAYER_DEFAULT = 1;
+const uint32_t BODY_LAYER_ALL = UINT32_MAX;
+
+// how far a body can move before its fat bounding box is recomputed
+const double BODY_FAT_AABB_MARGIN = 10;
+const size_t BODY_POOL_SLAB_COUNT = 256;
+
+/** Where every body is allocated from */
+pool_t *body_pool = NULL;
 
 typedef struct body {
   color_t color;
-  list_t *shape;
+  shape_t *shape;
   vector_t pos; // position
   vector_t vel; // velocity
   vector_t acl; // acceleration
@@ -33,33 +43,108 @@ typedef struct body {
   vector_t centroid;
   vector_t impulse;
   double angle;
+  aabb_t aabb;
+  aabb_t fat_aabb;
   bool remove;
   bool glowing;
   void *info;
   double glow_radius;
+  uint32_t layer;
   free_func_t info_freer;
+
+  // where the body reports fat box changes, and whether it is listed there
+  list_t *motion_list;
+  bool moved;
+  size_t index_handle;
 } body_t;
 
-body_t *body_init(list_t *shape, double mass, color_t color) {
-  body_t *new_body = malloc(sizeof(body_t));
+/** Recomputes the fat box if the tight box has escaped it */
+void body_update_fat_aabb(body_t *body) {
+  aabb_t tight = body->aabb, fat = body->fat_aabb;
+  if (tight.min.x < fat.min.x || tight.min.y < fat.min.y ||
+      tight.max.x > fat.max.x || tight.max.y > fat.max.y) {
+    body->fat_aabb = aabb_expand(tight, BODY_FAT_AABB_MARGIN);
+    if (body->motion_list != NULL && !body->moved) {
+      body->moved = true;
+      list_add(body->motion_list, body);
+    }
+  }
+}
+
+/** Moves the cached bounding volumes along with a translation of the shape */
+void body_translate_bounds(body_t *body, vector_t dx) {
+  body->aabb.min = vec_add(body->aabb.min, dx);
+  body->aabb.max = vec_add(body->aabb.max, dx);
+  body_update_fat_aabb(body);
+}
+
+/** Maps a point from the body's local space into the world */
+vector_t body_to_world(body_t *body, vector_t local) {
+  return vec_add(body->centroid, vec_rotate(local, body->angle));
+}
+
+/** Maps a point from the world into the body's local space */
+vector_t body_to_local(body_t *body, vector_t world) {
+  return vec_rotate(vec_subtract(world, body->centroid), -body->angle);
+}
+
+/** Recomputes the cached bounding box from the vertices */
+void body_compute_bounds(body_t *body) {
+  vec_array_t *vertices = shape_get_vertices(body->shape);
+  vector_t *local = vec_array_data(vertices);
+  vector_t first = body_to_world(body, local[0]);
+  aabb_t box = {.min = first, .max = first};
+  for (size_t i = 1; i < vec_array_size(vertices); i++) {
+    vector_t v = body_to_world(body, local[i]);
+    box.min.x = fmin(box.min.x, v.x);
+    box.min.y = fmin(box.min.y, v.y);
+    box.max.x = fmax(box.max.x, v.x);
+    box.max.y = fmax(box.max.y, v.y);
+  }
+  body->aabb = box;
+  body_update_fat_aabb(body);
+}
+
+body_t *body_init(vec_array_t *shape, double mass, color_t color) {
+  vector_t centroid = polygon_centroid(shape);
+  shape_t *prototype = shape_from_polygon(shape);
+  body_t *body = body_init_shape(prototype, centroid, mass, color);
+  shape_release(prototype);
+  return body;
+}
+
+body_t *body_init_shape(shape_t *shape, vector_t centroid, double mass,
+                        color_t color) {
+  pool_t *pool =
+      pool_get_shared(&body_pool, sizeof(body_t), BODY_POOL_SLAB_COUNT);
+  body_t *new_body = pool_alloc(pool);
+  metrics_add(METRIC_BODIES_SPAWNED, 1);
   new_body->color = color;
-  new_body->shape = shape;
+  new_body->shape = shape_retain(shape);
   new_body->pos = VEC_ZERO;
   new_body->vel = VEC_ZERO;
   new_body->acl = VEC_ZERO;
   new_body->impulse = VEC_ZERO;
   new_body->mass = mass;
-  new_body->centroid = polygon_centroid(shape);
+  new_body->centroid = centroid;
   new_body->angle = 0;
   new_body->remove = false;
   new_body->info = NULL;
   new_body->info_freer = NULL;
   new_body->glowing = false;
   new_body->glow_radius = 0;
+  new_body->layer = BODY_LAYER_DEFAULT;
+  new_body->motion_list = NULL;
+  new_body->moved = false;
+  new_body->index_handle = SIZE_MAX;
+  // start with an empty fat box so the first update always fits a new one
+  new_body->fat_aabb = (aabb_t){.min = {INFINITY, INFINITY},
+                                .max = {-INFINITY, -INFINITY}};
+  body_compute_bounds(new_body);
   return new_body;
 }
 
-body_t *body_init_with_info(list_t *shape, double mass, color_t color,
+body_t *body_init_with_info(vec_array_t *shape, double mass, color_t color,
                             void *info, free_func_t info_freer) {
   body_t *body = body_init(shape, mass, color);
   body->info = info;
@@ -67,28 +152,90 @@ body_t *body_init_with_info(list_t *shape, double mass, color_t color,
   return body;
 }
 
+body_t *body_init_shape_with_info(shape_t *shape, vector_t centroid,
+                                  double mass, color_t color, void *info,
+                                  free_func_t info_freer) {
+  body_t *body = body_init_shape(shape, centroid, mass, color);
+  body->info = info;
+  body->info_freer = info_freer;
+  return body;
+}
+
 void body_free(void *body) {
   body_t *body_casted = (body_t *)body;
-  list_free(body_casted->shape);
+  shape_release(body_casted->shape);
   if (body_casted->info_freer != NULL) {
     body_casted->info_freer(body_casted->info);
   }
-  free(body_casted);
+  pool_release(body_pool, body_casted);
+  metrics_add(METRIC_BODIES_REMOVED, 1);
 }
 
 void *body_get_info(body_t *body) { return body->info; }
 
-list_t *body_get_shape(body_t *body) {
-  list_t *new_body = list_init(list_size(body->shape), free);
-  list_t *body_pts = body->shape;
-  for (size_t i = 0; i < list_size(body_pts); i++) {
-    vector_t *curr_vec = list_get(body_pts, i);
-    vector_t *new_vec = malloc(sizeof(vector_t));
-    new_vec->x = curr_vec->x;
-    new_vec->y = curr_vec->y;
-    list_add(new_body, new_vec);
+vec_array_t *body_get_shape(body_t *body) {
+  return shape_place(body->shape, body->centroid, body->angle, NULL);
+}
+
+vec_array_t *body_get_frame_shape(body_t *body) {
+  return shape_place(body->shape, body->centroid, body->angle, frame_arena());
+}
+
+shape_t *body_get_prototype(body_t *body) { return body->shape; }
+
+double body_get_angle(body_t *body) { return body->angle; }
+
+aabb_t body_get_aabb(body_t *body) { return body->aabb; }
+
+aabb_t body_get_fat_aabb(body_t *body) { return body->fat_aabb; }
+
+double body_get_bounding_radius(body_t *body) {
+  return polygon_meta_get_bounding_radius(shape_get_meta(body->shape));
+}
+
+bool body_bounds_overlap(body_t *body1, body_t *body2) {
+  vector_t diff = vec_subtract(body1->centroid, body2->centroid);
+  double reach = body_get_bounding_radius(body1) +
+                 body_get_bounding_radius(body2);
+  return vec_dot(diff, diff) <= reach * reach &&
+         aabb_overlaps(body1->aabb, body2->aabb);
+}
+
+/** Runs the full separating axis test on two bodies */
+collision_info_t body_collide(body_t *body1, body_t *body2) {
+  return find_collision_meta(shape_get_vertices(body1->shape),
+                             shape_get_meta(body1->shape), body1->centroid,
+                             body1->angle, shape_get_vertices(body2->shape),
+                             shape_get_meta(body2->shape), body2->centroid,
+                             body2->angle);
+}
+
+collision_info_t body_find_collision(body_t *body1, body_t *body2) {
+  metrics_add(METRIC_BROAD_PAIRS, 1);
+  if (!body_bounds_overlap(body1, body2)) {
+    return (collision_info_t){.collided = false};
   }
-  return new_body;
+  metrics_add(METRIC_BROAD_PAIRS_OVERLAPPING, 1);
+  collision_info_t collision = body_collide(body1, body2);
+  metrics_add(METRIC_PAIRS_COLLIDING, collision.collided);
+  return collision;
+}
+
+bool body_contains_point(body_t *body, vector_t point) {
+  return aabb_contains_point(body_get_aabb(body), point) &&
+         polygon_contains_point(shape_get_vertices(body->shape),
+                                body_to_local(body, point));
+}
+
+bool body_overlaps_circle(body_t *body, vector_t center, double radius) {
+  return polygon_overlaps_circle(shape_get_vertices(body->shape),
+                                 body_to_local(body, center), radius);
+}
+
+double body_raycast(body_t *body, vector_t start, vector_t end) {
+  // rigid transforms preserve fractions along the segment
+  return polygon_raycast(shape_get_vertices(body->shape),
+                         body_to_local(body, start), body_to_local(body, end));
 }
 
 double body_get_mass(body_t *body) { return body->mass; }
@@ -113,15 +260,15 @@ color_t body_get_color(body_t *body) { return body->color; }
 
 void body_set_centroid(body_t *body, vector_t x) {
   vector_t dx = vec_subtract(x, body->centroid);
-  polygon_translate(body->shape, dx);
   body->centroid = x;
+  body_translate_bounds(body, dx);
 }
 
 void body_set_color(body_t *body, color_t color) { body->color = color; }
 
 void body_set_rotation(body_t *body, double angle) {
-  polygon_rotate(body->shape, angle - body->angle, body->centroid);
   body->angle = angle;
+  body_compute_bounds(body);
 }
 
 void body_add_force(body_t *body, vector_t force) {
@@ -130,29 +277,17 @@ void body_add_force(body_t *body, vector_t force) {
   body_set_acceleration(body, vec_add(a, da));
 }
 
-list_t *vector_pts(vector_t start, vector_t acl) {
+vec_array_t *vector_pts(vector_t start, vector_t acl) {
   vector_t end = vec_add(start, acl);
-  list_t *pts = list_init(4, free);
-  vector_t *lower_left = malloc(sizeof(vector_t));
-  lower_left->x = start.x - DEV_MODE_VECTOR_THICKNESS;
-  lower_left->y = start.y - DEV_MODE_VECTOR_THICKNESS;
-  list_add(pts, lower_left);
-
-  vector_t *upper_left = malloc(sizeof(vector_t));
-  upper_left->x = start.x - DEV_MODE_VECTOR_THICKNESS;
-  upper_left->y = start.y + DEV_MODE_VECTOR_THICKNESS;
-  list_add(pts, upper_left);
-
-  vector_t *upper_right = malloc(sizeof(vector_t));
-  upper_right->x = end.x + DEV_MODE_VECTOR_THICKNESS;
-  upper_right->y = end.y + DEV_MODE_VECTOR_THICKNESS;
-  list_add(pts, upper_right);
-
-  vector_t *lower_right = malloc(sizeof(vector_t));
-  lower_right->x = end.x + DEV_MODE_VECTOR_THICKNESS;
-  lower_right->y = end.y - DEV_MODE_VECTOR_THICKNESS;
-  list_add(pts, lower_right);
-
+  vec_array_t *pts = vec_array_init_in(frame_arena(), 4);
+  vec_array_add(pts, (vector_t){start.x - DEV_MODE_VECTOR_THICKNESS,
+                                start.y - DEV_MODE_VECTOR_THICKNESS});
+  vec_array_add(pts, (vector_t){start.x - DEV_MODE_VECTOR_THICKNESS,
+                                start.y + DEV_MODE_VECTOR_THICKNESS});
+  vec_array_add(pts, (vector_t){end.x + DEV_MODE_VECTOR_THICKNESS,
+                                end.y + DEV_MODE_VECTOR_THICKNESS});
+  vec_array_add(pts, (vector_t){end.x + DEV_MODE_VECTOR_THICKNESS,
+                                end.y - DEV_MODE_VECTOR_THICKNESS});
   return pts;
 }
 
@@ -176,7 +311,7 @@ void body_add_elastic_impulse(body_t *body1, body_t *body2, double elasticity) {
   } else {
     reduced_mass = (body1->mass * body2->mass) / (body1->mass + body2->mass);
   }
-  vector_t collision_axis = find_collision(body1->shape, body2->shape).axis;
+  vector_t collision_axis = body_collide(body1, body2).axis;
   vector_t centroid_diff =
       vec_subtract(body_get_centroid(body2), body_get_centroid(body1));
   if (vec_dot(collision_axis, centroid_diff) < 0) {
@@ -197,6 +332,26 @@ void body_add_impulse(body_t *body, vector_t impulse) {
   body->impulse = vec_add(body->impulse, impulse);
 }
 
+uint32_t body_get_layer(body_t *body) { return body->layer; }
+
+void body_set_layer(body_t *body, uint32_t layer) { body->layer = layer; }
+
+void body_set_motion_list(body_t *body, list_t *motion_list) {
+  body->motion_list = motion_list;
+  body->moved = motion_list != NULL;
+  if (body->moved) {
+    list_add(motion_list, body);
+  }
+}
+
+void body_clear_moved(body_t *body) { body->moved = false; }
+
+size_t body_get_index_handle(body_t *body) { return body->index_handle; }
+
+void body_set_index_handle(body_t *body, size_t handle) {
+  body->index_handle = handle;
+}
+
 bool body_get_glow(body_t *body) {
   return body->glowing;
 }
@@ -214,14 +369,9 @@ void body_set_glow_radius(body_t *body, double glow_radius) {
 }
 
 void body_draw_glow(body_t *body, double radius) {
-  color_t glow_color = body_get_color(body);
-  glow_color.a = GLOW_SCALE * body_get_color(body).a; 
-  for (size_t j = 0; j < GLOW_FACTOR; j++) { 
-    glow_color.a = GLOW_REDUCTION * glow_color.a;
-    list_t *glow_circle = make_circle(GLOW_RESOLUTION, radius + GLOW_INCREASE*j, body_get_centroid(body)); 
-    sdl_draw_polygon(glow_circle, glow_color);
-    list_free(glow_circle);
-  }
+  vector_t centroid = body_get_centroid(body);
+  color_t color = body_get_color(body);
+  sdl_draw_glows(&centroid, &color, 1, radius);
 }
 
 void body_tick(body_t *body, double dt) {
@@ -236,7 +386,7 @@ void body_tick(body_t *body, double dt) {
   vector_t pos_change = vec_multiply(dt, avg_vel);
   body->pos = vec_add(body->pos, pos_change);
   body->centroid = vec_add(body->centroid, pos_change);
-  polygon_translate(body->shape, pos_change);
+  body_translate_bounds(body, pos_change);
   body_set_acceleration(body, VEC_ZERO);
   body->impulse = VEC_ZERO;
 }
@@ -252,7 +402,7 @@ void body_tick_canon(body_t *body, double dt) {
   vector_t pos_change = vec_multiply(dt, new_vel);
   body->pos = vec_add(body->pos, pos_change);
   body->centroid = vec_add(body->centroid, pos_change);
-  polygon_translate(body->shape, pos_change);
+  body_translate_bounds(body, pos_change);
   body_set_acceleration(body, VEC_ZERO);
   body->impulse = VEC_ZERO;
 }
@@ -268,7 +418,7 @@ void body_tick_canon_no_reset(body_t *body, double dt) {
   vector_t pos_change = vec_multiply(dt, new_vel);
   body->pos = vec_add(body->pos, pos_change);
   body->centroid = vec_add(body->centroid, pos_change);
-  polygon_translate(body->shape, pos_change);
+  body_translate_bounds(body, pos_change);
   body->impulse = VEC_ZERO;
 }
 
@@ -1,129 +1,161 @@
 #include "collision.h"
-#include "list.h"
+#include "metrics.h"
+#include "vec_array.h"
 #include "vector.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-// Returns a list of lines perpendicular to the edges of both shapes
-list_t *get_perpendicular_lines(list_t *shape1, list_t *shape2) {
-  list_t *perpendicular_lines =
-      list_init(list_size(shape1) + list_size(shape2), free);
-
-  // Iterates through all the vertices in shape1
-  for (size_t i = 0; i < list_size(shape1); i++) {
-    vector_t v1 = *((vector_t *)list_get(shape1, i));
-    vector_t v2 = *((vector_t *)list_get(shape1, (i + 1) % list_size(shape1)));
-
-    // Calculates the vector from vertex 1 to vertex 2
-    vector_t parallel_vec = vec_normalize(vec_subtract(v2, v1));
-    vector_t perpendicular_vec = vec_normalize(vec_perpendicular(parallel_vec));
-    vector_t *perp_vec = malloc(sizeof(vector_t));
-    *perp_vec = perpendicular_vec;
-    list_add(perpendicular_lines, perp_vec);
-  }
-
-  // Iterates through all the vertices in shape2
-  for (size_t i = 0; i < list_size(shape2); i++) {
-    vector_t v1 = *((vector_t *)list_get(shape2, i));
-    vector_t v2 = *((vector_t *)list_get(shape2, (i + 1) % list_size(shape2)));
-
-    // Calculates the vector from vertex 1 to vertex 2
-    vector_t parallel_vec = vec_normalize(vec_subtract(v2, v1));
-    vector_t perpendicular_vec = vec_normalize(vec_perpendicular(parallel_vec));
-    vector_t *perp_vec = malloc(sizeof(vector_t));
-    *perp_vec = perpendicular_vec;
-    list_add(perpendicular_lines, perp_vec);
-  }
-
-  return perpendicular_lines;
-}
-
 /**
- * Returns a list containing the starting point and ending point
+ * Returns a vector containing the starting point and ending point
  * of the projection of 'shape' onto 'line.'
  */
-vector_t project_shape(list_t *shape, vector_t line) {
-
-  // Initializes the starting point and ending point as the first point in the
-  // shape
-  double min_length = vec_dot(*((vector_t *)list_get(shape, 0)), line);
-  double max_length = vec_dot(*((vector_t *)list_get(shape, 0)), line);
-
-  // Iterates through all the vertices in the shape
-  for (size_t i = 0; i < list_size(shape); i++) {
-
-    // Projects the point (vector from origin to the vertex) onto the line
-    vector_t point = *((vector_t *)list_get(shape, i));
-    double vec_len = vec_dot(point, line);
-
-    // Tests if the projected vector is smaller than the starting point or
-    // larger than ending point
-    if (vec_len < min_length) {
-      min_length = vec_len;
-    } else if (vec_len > max_length) {
-      max_length = vec_len;
-    }
+vector_t project_shape(vec_array_t *shape, vector_t line) {
+  size_t n = vec_array_size(shape);
+  vector_t *v = vec_array_data(shape);
+  double min_length = INFINITY;
+  double max_length = -INFINITY;
+
+  // Projects every vertex (vector from origin to the vertex) onto the line
+  for (size_t i = 0; i < n; i++) {
+    double vec_len = v[i].x * line.x + v[i].y * line.y;
+    min_length = fmin(min_length, vec_len);
+    max_length = fmax(max_length, vec_len);
   }
 
-  // Adds starting and ending point to a list and returns it
   vector_t endpoints = (vector_t){.x = min_length, .y = max_length};
   return endpoints;
 }
 
 /**
- * Determines if there exists some axis perpendicular to 'line'
- * that separates shape1 from shape2. True if such a line doesn't exist
- * (shapes intersect), false if a line exists (shapes do not intersect)
+ * Tests the lines perpendicular to the edges of one shape against both
+ * shapes, walking its vertices in place, narrowing down the smallest overlap
+ * and counting the axes tested.
+ * Returns false if one of them separates the shapes.
  */
-bool intersect(vector_t line, list_t *shape1, list_t *shape2) {
+bool intersect_shape_axes(vec_array_t *shape1, vec_array_t *shape2,
+                          vec_array_t *axes_shape, double *smallest_overlap,
+                          vector_t *collision_axis, size_t *num_tested) {
+  size_t n = vec_array_size(axes_shape);
+  vector_t *v = vec_array_data(axes_shape);
+  for (size_t i = 0; i < n; i++) {
+    (*num_tested)++;
+    // the edge from vertex i to the next one, turned a quarter
+    vector_t edge = vec_subtract(v[(i + 1) % n], v[i]);
+    vector_t axis = vec_normalize(vec_perpendicular(edge));
+    vector_t range1 = project_shape(shape1, axis);
+    vector_t range2 = project_shape(shape2, axis);
+    // a separating axis means the shapes do not intersect
+    if (range1.x > range2.y || range1.y < range2.x) {
+      return false;
+    }
+    double overlap = fmin(fabs(range1.x - range2.y), fabs(range1.y - range2.x));
+    if (overlap < *smallest_overlap) {
+      *smallest_overlap = overlap;
+      *collision_axis = axis;
+    }
+  }
+  return true;
+}
 
-  // Gets the starting and endoing point of the projected vector of shape onto
-  // line
-  vector_t shape1_endpoints = project_shape(shape1, line);
-  vector_t shape2_endpoints = project_shape(shape2, line);
+collision_info_t find_collision(vec_array_t *shape1, vec_array_t *shape2) {
+  collision_info_t collision_data = {.collided = false};
+  double smallest_overlap = INFINITY;
+  vector_t collision_axis = VEC_ZERO;
+  size_t num_tested = 0;
+  metrics_add(METRIC_SAT_TESTS, 1);
+  if (!intersect_shape_axes(shape1, shape2, shape1, &smallest_overlap,
+                            &collision_axis, &num_tested) ||
+      !intersect_shape_axes(shape1, shape2, shape2, &smallest_overlap,
+                            &collision_axis, &num_tested)) {
+    metrics_add_sat_early_out(num_tested - 1);
+    return collision_data;
+  }
+  collision_data.collided = true;
+  collision_data.axis = collision_axis;
+  return collision_data;
+}
 
-  double min1 = shape1_endpoints.x;
-  double max1 = shape1_endpoints.y;
-  double min2 = shape2_endpoints.x;
-  double max2 = shape2_endpoints.y;
+/** A convex part of a local-space shape, placed in the world */
+typedef struct placed_part {
+  vec_array_t *shape;
+  const polygon_part_t *part;
+  vector_t pos;
+  double angle;
+} placed_part_t;
 
-  if (min1 <= max2 && max1 >= min2) {
-    return true;
+/**
+ * Projects the placed vertices of a convex part onto a world-space line.
+ * Rather than transforming every vertex, the line is brought into the
+ * part's local space and the offset of its origin is added afterwards.
+ */
+vector_t project_part(placed_part_t *placed, vector_t line) {
+  vector_t local_line = vec_rotate(line, -placed->angle);
+  double offset = vec_dot(placed->pos, line);
+  double min_length = INFINITY;
+  double max_length = -INFINITY;
+  vector_t *v = vec_array_data(placed->shape);
+  for (size_t i = 0; i < placed->part->num_vertices; i++) {
+    double vec_len = vec_dot(v[placed->part->vertices[i]], local_line);
+    min_length = fmin(min_length, vec_len);
+    max_length = fmax(max_length, vec_len);
   }
-  return false;
+  return (vector_t){.x = min_length + offset, .y = max_length + offset};
 }
 
-collision_info_t find_collision(list_t *shape1, list_t *shape2) {
-  list_t *perpendicular_lines = get_perpendicular_lines(shape1, shape2);
-  collision_info_t collision_data;
-  double smallest_overlap = INFINITY;
-  vector_t collision_axis;
-  double overlap = 0; // was -11
-  for (size_t i = 0; i < list_size(perpendicular_lines); i++) {
-    if (!intersect(*((vector_t *)list_get(perpendicular_lines, i)), shape1,
-                   shape2)) {
-      collision_data.collided = false;
-      list_free(perpendicular_lines);
-      return collision_data;
-    } else {
-      vector_t axis = *((vector_t *)list_get(perpendicular_lines, i));
-      double min1 = project_shape(shape1, axis).x;
-      double max1 = project_shape(shape1, axis).y;
-      double min2 = project_shape(shape2, axis).x;
-      double max2 = project_shape(shape2, axis).y;
-      overlap = fmin(fabs(min1 - max2), fabs(max1 - min2));
-      if (i == 0) {
-        smallest_overlap = overlap;
-        collision_axis = vec_normalize(axis);
-      } else if (overlap < smallest_overlap) {
-        smallest_overlap = overlap;
-        collision_axis = vec_normalize(axis);
+/**
+ * Tests the axes of one part against both parts, narrowing down the
+ * smallest overlap and counting the axes tested.
+ * Returns false if one of them separates the parts.
+ */
+bool intersect_part_axes(placed_part_t *part1, placed_part_t *part2,
+                         placed_part_t *axes_part, double *smallest_overlap,
+                         vector_t *collision_axis, size_t *num_tested) {
+  for (size_t i = 0; i < axes_part->part->num_axes; i++) {
+    (*num_tested)++;
+    vector_t axis = vec_rotate(axes_part->part->axes[i], axes_part->angle);
+    vector_t range1 = project_part(part1, axis);
+    vector_t range2 = project_part(part2, axis);
+    if (range1.x > range2.y || range1.y < range2.x) {
+      return false;
+    }
+    double overlap = fmin(fabs(range1.x - range2.y), fabs(range1.y - range2.x));
+    if (overlap < *smallest_overlap) {
+      *smallest_overlap = overlap;
+      *collision_axis = axis;
+    }
+  }
+  return true;
+}
+
+collision_info_t find_collision_meta(vec_array_t *shape1,
+                                     polygon_meta_t *meta1, vector_t pos1,
+                                     double angle1, vec_array_t *shape2,
+                                     polygon_meta_t *meta2, vector_t pos2,
+                                     double angle2) {
+  collision_info_t collision_data = {.collided = false};
+  double deepest = -INFINITY;
+  placed_part_t part1 = {.shape = shape1, .pos = pos1, .angle = angle1};
+  placed_part_t part2 = {.shape = shape2, .pos = pos2, .angle = angle2};
+  for (size_t i = 0; i < polygon_meta_num_parts(meta1); i++) {
+    part1.part = polygon_meta_get_part(meta1, i);
+    for (size_t j = 0; j < polygon_meta_num_parts(meta2); j++) {
+      part2.part = polygon_meta_get_part(meta2, j);
+      double overlap = INFINITY;
+      vector_t axis = VEC_ZERO;
+      size_t num_tested = 0;
+      metrics_add(METRIC_SAT_TESTS, 1);
+      if (!intersect_part_axes(&part1, &part2, &part1, &overlap, &axis,
+                               &num_tested) ||
+          !intersect_part_axes(&part1, &part2, &part2, &overlap, &axis,
+                               &num_tested)) {
+        metrics_add_sat_early_out(num_tested - 1);
+      } else if (overlap > deepest) {
+        deepest = overlap;
+        collision_data.collided = true;
+        collision_data.axis = axis;
       }
     }
   }
-  collision_data.collided = true;
-  collision_data.axis = collision_axis;
-  list_free(perpendicular_lines);
   return collision_data;
 }
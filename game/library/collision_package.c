@@ -1,10 +1,20 @@
 #include "collision_package.h"
 #include "collision.h"
+#include "pool.h"
+#include "trace.h"
+
+const size_t COLLISION_PACKAGE_POOL_SLAB_COUNT = 512;
+
+/** Where every collision package is allocated from */
+pool_t *collision_package_pool = NULL;
 
 collision_package_t *collision_package_init(body_t *body1, body_t *body2,
                                             collision_handler_t handler,
                                             void *aux, free_func_t freer) {
-  collision_package_t *package = malloc(sizeof(collision_package_t));
+  pool_t *pool =
+      pool_get_shared(&collision_package_pool, sizeof(collision_package_t),
+                      COLLISION_PACKAGE_POOL_SLAB_COUNT);
+  collision_package_t *package = pool_alloc(pool);
   package->body1 = body1;
   package->body2 = body2;
   package->handler = handler;
@@ -16,14 +26,12 @@ collision_package_t *collision_package_init(body_t *body1, body_t *body2,
 void collision_package_handle(collision_package_t *pkg) {
   body_t *body1 = pkg->body1;
   body_t *body2 = pkg->body2;
-  list_t *shape1 = body_get_shape(body1);
-  list_t *shape2 = body_get_shape(body2);
-  if (find_collision(shape1, shape2).collided) {
-    vector_t axis = find_collision(shape1, shape2).axis;
-    pkg->handler(body1, body2, axis, pkg->aux);
+  collision_info_t collision = body_find_collision(body1, body2);
+  if (collision.collided) {
+    trace_begin_call(tick_tracer(), "collision", (const void *)pkg->handler);
+    pkg->handler(body1, body2, collision.axis, pkg->aux);
+    trace_end(tick_tracer());
   }
-  list_free(shape1);
-  list_free(shape2);
 }
 
 void collision_package_free(void *pkg) {
@@ -31,5 +39,5 @@ void collision_package_free(void *pkg) {
   if (pkg_casted->freer != NULL) {
     pkg_casted->freer(pkg_casted->aux);
   }
-  free(pkg_casted);
+  pool_release(collision_package_pool, pkg_casted);
 }
\ No newline at end of file
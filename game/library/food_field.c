@@ -0,0 +1,185 @@
+#include "food_field.h"
+#include "sdl_wrapper.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t FIELD_CELL_CAPACITY = 4;
+const size_t FIELD_PELLET_SIDES = 6;
+
+typedef struct food_cell {
+  food_t *items;
+  size_t size;
+  size_t capacity;
+} food_cell_t;
+
+typedef struct food_field {
+  vector_t min;
+  double cell_size;
+  size_t cols;
+  size_t rows;
+  food_cell_t *cells;
+  size_t size;
+  double radius;
+  color_t *palette;
+  size_t num_types;
+
+  // scratch buffers reused by food_field_draw()
+  vector_t *draw_centers;
+  color_t *draw_colors;
+  size_t draw_capacity;
+} food_field_t;
+
+food_field_t *food_field_init(vector_t min, vector_t max, double cell_size,
+                              double radius, const color_t *palette,
+                              size_t num_types) {
+  assert(min.x < max.x && min.y < max.y);
+  assert(cell_size > 0);
+  assert(num_types > 0);
+  food_field_t *field = malloc(sizeof(food_field_t));
+  assert(field != NULL);
+  field->min = min;
+  field->cell_size = cell_size;
+  field->cols = (size_t)ceil((max.x - min.x) / cell_size);
+  field->rows = (size_t)ceil((max.y - min.y) / cell_size);
+  field->cells = calloc(field->cols * field->rows, sizeof(food_cell_t));
+  assert(field->cells != NULL);
+  field->size = 0;
+  field->radius = radius;
+  field->palette = malloc(sizeof(color_t) * num_types);
+  assert(field->palette != NULL);
+  memcpy(field->palette, palette, sizeof(color_t) * num_types);
+  field->num_types = num_types;
+  field->draw_centers = NULL;
+  field->draw_colors = NULL;
+  field->draw_capacity = 0;
+  return field;
+}
+
+void food_field_free(food_field_t *field) {
+  for (size_t i = 0; i < field->cols * field->rows; i++) {
+    free(field->cells[i].items);
+  }
+  free(field->cells);
+  free(field->palette);
+  free(field->draw_centers);
+  free(field->draw_colors);
+  free(field);
+}
+
+size_t food_field_size(food_field_t *field) { return field->size; }
+
+double food_field_get_radius(food_field_t *field) { return field->radius; }
+
+/** Maps a coordinate to a column (or row) index, clamped to the grid */
+size_t field_index(double coord, double min, double cell_size, size_t count) {
+  double idx = floor((coord - min) / cell_size);
+  if (idx < 0) {
+    return 0;
+  }
+  if (idx >= count) {
+    return count - 1;
+  }
+  return (size_t)idx;
+}
+
+void food_field_add(food_field_t *field, vector_t pos, size_t type) {
+  assert(type < field->num_types);
+  size_t col = field_index(pos.x, field->min.x, field->cell_size, field->cols);
+  size_t row = field_index(pos.y, field->min.y, field->cell_size, field->rows);
+  food_cell_t *cell = &field->cells[row * field->cols + col];
+  if (cell->size == cell->capacity) {
+    size_t new_capacity =
+        cell->capacity == 0 ? FIELD_CELL_CAPACITY : cell->capacity * 2;
+    cell->items = realloc(cell->items, sizeof(food_t) * new_capacity);
+    assert(cell->items != NULL);
+    cell->capacity = new_capacity;
+  }
+  cell->items[cell->size] = (food_t){.pos = pos, .type = type};
+  cell->size++;
+  field->size++;
+}
+
+size_t food_field_collect(food_field_t *field, vector_t center, double radius,
+                          food_handler_t handler, void *aux) {
+  double reach = radius + field->radius;
+  double reach_sq = reach * reach;
+  size_t col_min = field_index(center.x - reach, field->min.x,
+                               field->cell_size, field->cols);
+  size_t col_max = field_index(center.x + reach, field->min.x,
+                               field->cell_size, field->cols);
+  size_t row_min = field_index(center.y - reach, field->min.y,
+                               field->cell_size, field->rows);
+  size_t row_max = field_index(center.y + reach, field->min.y,
+                               field->cell_size, field->rows);
+
+  size_t collected = 0;
+  for (size_t row = row_min; row <= row_max; row++) {
+    for (size_t col = col_min; col <= col_max; col++) {
+      food_cell_t *cell = &field->cells[row * field->cols + col];
+      size_t i = 0;
+      while (i < cell->size) {
+        vector_t diff = vec_subtract(cell->items[i].pos, center);
+        if (vec_dot(diff, diff) > reach_sq) {
+          i++;
+          continue;
+        }
+        // swap-remove, then hand the pellet over; the handler may add pellets
+        // to this very cell, which only ever appends past index i
+        food_t food = cell->items[i];
+        cell->size--;
+        cell->items[i] = cell->items[cell->size];
+        field->size--;
+        collected++;
+        if (handler != NULL) {
+          handler(food, aux);
+        }
+      }
+    }
+  }
+  return collected;
+}
+
+void food_field_clear(food_field_t *field) {
+  for (size_t i = 0; i < field->cols * field->rows; i++) {
+    field->cells[i].size = 0;
+  }
+  field->size = 0;
+}
+
+void food_field_reserve_draw(food_field_t *field) {
+  if (field->draw_capacity >= field->size) {
+    return;
+  }
+  size_t new_capacity = field->size * 2;
+  field->draw_centers =
+      realloc(field->draw_centers, sizeof(vector_t) * new_capacity);
+  field->draw_colors = realloc(field->draw_colors, sizeof(color_t) * new_capacity);
+  assert(field->draw_centers != NULL);
+  assert(field->draw_colors != NULL);
+  field->draw_capacity = new_capacity;
+}
+
+void food_field_draw(food_field_t *field, bool glow) {
+  if (field->size == 0) {
+    return;
+  }
+  food_field_reserve_draw(field);
+  size_t n = 0;
+  for (size_t i = 0; i < field->cols * field->rows; i++) {
+    food_cell_t *cell = &field->cells[i];
+    for (size_t j = 0; j < cell->size; j++) {
+      field->draw_centers[n] = cell->items[j].pos;
+      field->draw_colors[n] = field->palette[cell->items[j].type];
+      n++;
+    }
+  }
+
+  if (glow) {
+    sdl_draw_glows(field->draw_centers, field->draw_colors, n, field->radius);
+  }
+
+  sdl_draw_regular_polygons(field->draw_centers, field->draw_colors, n,
+                            FIELD_PELLET_SIDES, field->radius);
+}
@@ -2,25 +2,37 @@
 
 #include "aux.h"
 #include "list.h"
+#include "metrics.h"
+#include "pool.h"
+#include "trace.h"
 #include <stdbool.h>
 #include <stdlib.h>
 
 const size_t NUM_BODIES = 20;
+const size_t FORCE_POOL_SLAB_COUNT = 512;
 
 typedef struct force_wrapper {
   force_creator_t force_creator;
   void *aux;
   bool remove;
+  bool collision;
   free_func_t freer;
   list_t *bodies;
 } force_wrapper_t;
 
+/** Where every force is allocated from */
+pool_t *force_pool = NULL;
+
 force_wrapper_t *force_init(force_creator_t force_creator, void *aux,
                             free_func_t freer) {
-  force_wrapper_t *force = malloc(sizeof(force_wrapper_t));
+  pool_t *pool = pool_get_shared(&force_pool, sizeof(force_wrapper_t),
+                                 FORCE_POOL_SLAB_COUNT);
+  force_wrapper_t *force = pool_alloc(pool);
+  metrics_add(METRIC_FORCES_CREATED, 1);
   force->force_creator = force_creator;
   force->aux = aux;
   force->remove = false;
+  force->collision = false;
   force->freer = freer;
   force->bodies = NULL;
   return force;
@@ -36,7 +48,11 @@ force_wrapper_t *force_init_with_bodies(force_creator_t force_creator,
 
 list_t *force_get_bodies(force_wrapper_t *f) { return f->bodies; }
 
-void force_create(force_wrapper_t *f) { f->force_creator(f->aux); }
+void force_create(force_wrapper_t *f) {
+  trace_begin_call(tick_tracer(), "force", (const void *)f->force_creator);
+  f->force_creator(f->aux);
+  trace_end(tick_tracer());
+}
 
 void *force_get_aux(force_wrapper_t *force) { return force->aux; }
 
@@ -46,12 +62,18 @@ void force_remove(force_wrapper_t *force) { force->remove = true; }
 
 bool force_is_removed(force_wrapper_t *force) { return force->remove; }
 
+void force_set_collision(force_wrapper_t *force) { force->collision = true; }
+
+bool force_is_collision(force_wrapper_t *force) { return force->collision; }
+
 void force_free(void *force) {
   force_wrapper_t *casted_force = (force_wrapper_t *)force;
   if (casted_force->freer != NULL) {
     casted_force->freer(casted_force->aux);
-  } else if (casted_force->bodies != NULL) {
+  }
+  if (casted_force->bodies != NULL) {
     list_free(casted_force->bodies);
   }
-  free(casted_force);
+  pool_release(force_pool, casted_force);
+  metrics_add(METRIC_FORCES_REMOVED, 1);
 }
\ No newline at end of file
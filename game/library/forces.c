@@ -115,7 +115,8 @@ void applied_force_creator(void *aux) {
 void create_applied_force(scene_t *scene, double *magnitude, body_t *body) {
   force_creator_t a_creator = applied_force_creator;
 
-  list_t *constants = list_init(1, free);
+  // the caller keeps ownership of magnitude so it can keep changing it
+  list_t *constants = list_init(1, NULL);
   list_add(constants, magnitude);
 
   list_t *bodies = list_init(1, NULL);
@@ -129,14 +130,10 @@ void destructive_collision_creator(void *aux) {
   aux_t *aux_casted = (aux_t *)aux;
   body_t *body1 = (body_t *)list_get(aux_get_bodies(aux_casted), 0);
   body_t *body2 = (body_t *)list_get(aux_get_bodies(aux_casted), 1);
-  list_t *shape1 = body_get_shape(body1);
-  list_t *shape2 = body_get_shape(body2);
-  if (find_collision(shape1, shape2).collided) {
+  if (body_find_collision(body1, body2).collided) {
     body_remove(body1);
     body_remove(body2);
   }
-  list_free(shape1);
-  list_free(shape2);
 }
 
 void create_destructive_collision(scene_t *scene, body_t *body1,
@@ -148,7 +145,7 @@ void create_destructive_collision(scene_t *scene, body_t *body1,
   list_add(bodies, body2);
 
   aux_t *aux = aux_init(NULL, bodies);
-  scene_add_bodies_force_creator(scene, creator, aux, bodies, aux_free);
+  scene_add_collision_creator(scene, creator, aux, bodies, aux_free);
 }
 
 void general_collision_handler(void *pkg) {
@@ -167,8 +164,8 @@ void create_collision(scene_t *scene, body_t *body1, body_t *body2,
   list_add(bodies, body1);
   list_add(bodies, body2);
 
-  scene_add_bodies_force_creator(scene, collision_handler, pkg, bodies,
-                                 collision_package_free);
+  scene_add_collision_creator(scene, collision_handler, pkg, bodies,
+                              collision_package_free);
 }
 
 void normal_collision_handler(body_t *body1, body_t *body2, vector_t axis,
@@ -177,24 +174,19 @@ void normal_collision_handler(body_t *body1, body_t *body2, vector_t axis,
   bool *impulsed_last_tick = list_get(info, 0);
   double *elasticity = list_get(info, 1);
 
-  list_t *shape1 = body_get_shape(body1);
-  list_t *shape2 = body_get_shape(body2);
-
-  if (find_collision(shape1, shape2).collided && !(*impulsed_last_tick)) {
+  if (body_find_collision(body1, body2).collided && !(*impulsed_last_tick)) {
     *impulsed_last_tick = true;
     body_add_elastic_impulse(body1, body2, *elasticity);
   } else {
     *impulsed_last_tick = false;
   }
-  list_free(shape1);
-  list_free(shape2);
 }
 
 void create_physics_collision(scene_t *scene, double elasticity, body_t *body1,
                               body_t *body2) {
 
   force_creator_t handler = general_collision_handler;
-  list_t *info = list_init(2, NULL);
+  list_t *info = list_init(2, free);
 
   bool *impulsed_last_tick = malloc(sizeof(bool));
   *impulsed_last_tick = false;
@@ -205,12 +197,12 @@ void create_physics_collision(scene_t *scene, double elasticity, body_t *body1,
   list_add(info, e);
 
   collision_package_t *pkg = collision_package_init(
-      body1, body2, normal_collision_handler, info, NULL); // CHECK FREER
+      body1, body2, normal_collision_handler, info, list_free);
 
   list_t *bodies = list_init(2, NULL);
   list_add(bodies, body1);
   list_add(bodies, body2);
 
-  scene_add_bodies_force_creator(scene, handler, pkg, bodies,
-                                 collision_package_free);
+  scene_add_collision_creator(scene, handler, pkg, bodies,
+                              collision_package_free);
 }
\ No newline at end of file
@@ -1,18 +1,29 @@
 #include "list.h"
+#include "metrics.h"
+#include "pool.h"
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 const size_t RESIZE_MULTIPLIER = 2;
 const size_t DEFAULT_CAPACITY = 10;
+const size_t LIST_POOL_SLAB_COUNT = 1024;
+// force creators and their aux values hold one or two bodies or constants
+#define LIST_INLINE_CAPACITY 2
 
 typedef struct list {
   void **data;
   free_func_t freer;
   size_t size;
   size_t capacity;
+  // small lists keep their elements here instead of in a separate allocation
+  void *inline_data[LIST_INLINE_CAPACITY];
 } list_t;
 
+/** Where every list is allocated from */
+pool_t *list_pool = NULL;
+
 /**
  * @brief
  *
@@ -20,8 +31,16 @@ typedef struct list {
  * @return list_t*
  */
 list_t *list_init(size_t initial_capacity, free_func_t freer) {
-  list_t *list = malloc(sizeof(list_t));
-  list->data = malloc(sizeof(void *) * initial_capacity);
+  pool_t *pool =
+      pool_get_shared(&list_pool, sizeof(list_t), LIST_POOL_SLAB_COUNT);
+  list_t *list = pool_alloc(pool);
+  if (initial_capacity <= LIST_INLINE_CAPACITY) {
+    initial_capacity = LIST_INLINE_CAPACITY;
+    list->data = list->inline_data;
+  } else {
+    list->data = malloc(sizeof(void *) * initial_capacity);
+    metrics_add(METRIC_ALLOCS_LIST, 1);
+  }
   list->size = 0;
   list->freer = freer;
   list->capacity = initial_capacity;
@@ -30,13 +49,24 @@ list_t *list_init(size_t initial_capacity, free_func_t freer) {
   return list;
 }
 
-void list_resize(list_t *list) {
-  size_t new_capacity = (list->capacity * RESIZE_MULTIPLIER) + 1;
-  list->data = realloc(list->data, sizeof(void *) * new_capacity);
-  list->capacity = new_capacity;
+/** Moves a list's elements to a heap array of a larger capacity */
+void list_grow(list_t *list, size_t capacity) {
+  if (list->data == list->inline_data) {
+    list->data = malloc(sizeof(void *) * capacity);
+    assert(list->data);
+    memcpy(list->data, list->inline_data, sizeof(void *) * list->size);
+  } else {
+    list->data = realloc(list->data, sizeof(void *) * capacity);
+  }
+  metrics_add(METRIC_ALLOCS_LIST, 1);
+  list->capacity = capacity;
   assert(list->data);
 }
 
+void list_resize(list_t *list) {
+  list_grow(list, (list->capacity * RESIZE_MULTIPLIER) + 1);
+}
+
 void list_add(list_t *list, void *element) {
   assert(element != NULL);
   if (list->size == list->capacity) {
@@ -72,8 +102,54 @@ void list_free(void *list) {
       casted_list->freer(list_get(casted_list, i));
     }
   }
-  free(casted_list->data);
-  free(list);
+  if (casted_list->data != casted_list->inline_data) {
+    free(casted_list->data);
+  }
+  pool_release(list_pool, casted_list);
 }
 
 size_t list_size(list_t *list) { return list->size; }
+
+void list_reserve(list_t *list, size_t capacity) {
+  if (capacity <= list->capacity) {
+    return;
+  }
+  list_grow(list, capacity);
+}
+
+void *list_swap_remove(list_t *list, size_t index) {
+  assert(index < list->size);
+  void *temp_data = list->data[index];
+  list->size--;
+  list->data[index] = list->data[list->size];
+  return temp_data;
+}
+
+void list_clear(list_t *list) {
+  if (list->freer != NULL) {
+    for (size_t i = 0; i < list->size; i++) {
+      list->freer(list->data[i]);
+    }
+  }
+  list->size = 0;
+}
+
+size_t list_compact_if(list_t *list, list_pred_t should_remove, void *aux) {
+  size_t kept = 0;
+  for (size_t i = 0; i < list->size; i++) {
+    void *element = list->data[i];
+    if (should_remove(element, aux)) {
+      if (list->freer != NULL) {
+        list->freer(element);
+      }
+    } else {
+      list->data[kept] = element;
+      kept++;
+    }
+  }
+  size_t removed = list->size - kept;
+  list->size = kept;
+  return removed;
+}
+
+void **list_data(list_t *list) { return list->data; }
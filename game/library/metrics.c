@@ -0,0 +1,179 @@
+#include "metrics.h"
+#include "profiler.h"
+#include <assert.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+
+#define METRICS_LINE_LENGTH 96
+
+const char *METRICS_NAMES[METRIC_COUNT] = {
+    [METRIC_SAT_TESTS] = "sat_tests",
+    [METRIC_SAT_EARLY_OUT + 0] = "sat_early_out_axis_0",
+    [METRIC_SAT_EARLY_OUT + 1] = "sat_early_out_axis_1",
+    [METRIC_SAT_EARLY_OUT + 2] = "sat_early_out_axis_2",
+    [METRIC_SAT_EARLY_OUT + 3] = "sat_early_out_axis_3",
+    [METRIC_SAT_EARLY_OUT + 4] = "sat_early_out_axis_4",
+    [METRIC_SAT_EARLY_OUT + 5] = "sat_early_out_axis_5",
+    [METRIC_SAT_EARLY_OUT + 6] = "sat_early_out_axis_6",
+    [METRIC_SAT_EARLY_OUT + 7] = "sat_early_out_axis_7_on",
+    [METRIC_BROAD_PAIRS] = "broad_pairs",
+    [METRIC_BROAD_PAIRS_OVERLAPPING] = "broad_pairs_overlapping",
+    [METRIC_PAIRS_COLLIDING] = "pairs_colliding",
+    [METRIC_ALLOCS_LIST] = "allocs_list",
+    [METRIC_ALLOCS_VEC_ARRAY] = "allocs_vec_array",
+    [METRIC_ALLOCS_POOL] = "allocs_pool",
+    [METRIC_ALLOCS_ARENA] = "allocs_arena",
+    [METRIC_FORCES_CREATED] = "forces_created",
+    [METRIC_FORCES_REMOVED] = "forces_removed",
+    [METRIC_BODIES_SPAWNED] = "bodies_spawned",
+    [METRIC_BODIES_REMOVED] = "bodies_removed",
+    [METRIC_TEXTS_DRAWN] = "texts_drawn",
+    [METRIC_GLYPHS_RASTERIZED] = "glyphs_rasterized",
+};
+
+/** One thread's counters; only that thread writes to them */
+typedef struct {
+  _Atomic uint64_t values[METRIC_COUNT];
+} metrics_block_t;
+
+metrics_block_t metrics_blocks[METRICS_MAX_THREADS];
+atomic_size_t metrics_num_blocks = 0;
+// the counters of every thread that came after the blocks ran out
+metrics_block_t metrics_shared_block;
+_Thread_local metrics_block_t *metrics_local_block = NULL;
+
+// the totals at the end of the last tick, and the counts during it
+metrics_snapshot_t metrics_tick_start = {{0}};
+metrics_snapshot_t metrics_last_tick = {{0}};
+
+/** Gives the calling thread a block of its own, or the shared one */
+metrics_block_t *metrics_claim_block(void) {
+  size_t index = atomic_fetch_add(&metrics_num_blocks, 1);
+  metrics_local_block = index < METRICS_MAX_THREADS ? &metrics_blocks[index]
+                                                    : &metrics_shared_block;
+  return metrics_local_block;
+}
+
+void metrics_add(metric_t metric, uint64_t amount) {
+  assert(metric < METRIC_COUNT);
+  metrics_block_t *block = metrics_local_block;
+  if (block == NULL) {
+    block = metrics_claim_block();
+  }
+  _Atomic uint64_t *value = &block->values[metric];
+  if (block == &metrics_shared_block) {
+    atomic_fetch_add_explicit(value, amount, memory_order_relaxed);
+    return;
+  }
+  // no other thread writes to the block, so this need not be a locked add
+  atomic_store_explicit(
+      value, atomic_load_explicit(value, memory_order_relaxed) + amount,
+      memory_order_relaxed);
+}
+
+void metrics_add_sat_early_out(size_t axis) {
+  if (axis >= METRICS_SAT_AXES) {
+    axis = METRICS_SAT_AXES - 1;
+  }
+  metrics_add(METRIC_SAT_EARLY_OUT + axis, 1);
+}
+
+metrics_snapshot_t metrics_get_total(void) {
+  metrics_snapshot_t total = {{0}};
+  size_t num_blocks = atomic_load(&metrics_num_blocks);
+  if (num_blocks > METRICS_MAX_THREADS) {
+    num_blocks = METRICS_MAX_THREADS;
+  }
+  for (size_t i = 0; i < num_blocks; i++) {
+    for (size_t j = 0; j < METRIC_COUNT; j++) {
+      total.values[j] +=
+          atomic_load_explicit(&metrics_blocks[i].values[j],
+                               memory_order_relaxed);
+    }
+  }
+  for (size_t j = 0; j < METRIC_COUNT; j++) {
+    total.values[j] += atomic_load_explicit(&metrics_shared_block.values[j],
+                                            memory_order_relaxed);
+  }
+  return total;
+}
+
+void metrics_end_tick(void) {
+  metrics_snapshot_t total = metrics_get_total();
+  for (size_t i = 0; i < METRIC_COUNT; i++) {
+    metrics_last_tick.values[i] =
+        total.values[i] - metrics_tick_start.values[i];
+  }
+  metrics_tick_start = total;
+}
+
+metrics_snapshot_t metrics_get_last_tick(void) { return metrics_last_tick; }
+
+const char *metrics_name(metric_t metric) {
+  assert(metric < METRIC_COUNT);
+  return METRICS_NAMES[metric];
+}
+
+void metrics_write_csv_header(FILE *file) {
+  fprintf(file, "tick");
+  for (metric_t i = 0; i < METRIC_COUNT; i++) {
+    fprintf(file, ",%s", metrics_name(i));
+  }
+  fprintf(file, "\n");
+}
+
+void metrics_write_csv_row(FILE *file, size_t tick,
+                           const metrics_snapshot_t *snapshot) {
+  fprintf(file, "%zu", tick);
+  for (size_t i = 0; i < METRIC_COUNT; i++) {
+    fprintf(file, ",%" PRIu64, snapshot->values[i]);
+  }
+  fprintf(file, "\n");
+}
+
+void metrics_write_json(FILE *file, const metrics_snapshot_t *snapshot) {
+  fprintf(file, "{");
+  for (metric_t i = 0; i < METRIC_COUNT; i++) {
+    fprintf(file, "%s\"%s\":%" PRIu64, i == 0 ? "" : ",", metrics_name(i),
+            snapshot->values[i]);
+  }
+  fprintf(file, "}");
+}
+
+vector_t metrics_draw_hud(vector_t top_left) {
+  metrics_snapshot_t tick = metrics_get_last_tick();
+  uint64_t *v = tick.values;
+  char line[METRICS_LINE_LENGTH];
+  snprintf(line, sizeof(line),
+           "sat %" PRIu64 " tests, early out by axis", v[METRIC_SAT_TESTS]);
+  top_left = profiler_draw_hud_line(line, top_left);
+  size_t length = 0;
+  for (size_t i = 0; i < METRICS_SAT_AXES; i++) {
+    length += snprintf(line + length, sizeof(line) - length, "%s%" PRIu64,
+                       i == 0 ? "  " : " ", v[METRIC_SAT_EARLY_OUT + i]);
+    // snprintf returns the length it wanted, which may not have fit
+    if (length > sizeof(line) - 1) {
+      length = sizeof(line) - 1;
+    }
+  }
+  top_left = profiler_draw_hud_line(line, top_left);
+  snprintf(line, sizeof(line),
+           "pairs %" PRIu64 " tested, %" PRIu64 " overlap, %" PRIu64 " hit",
+           v[METRIC_BROAD_PAIRS], v[METRIC_BROAD_PAIRS_OVERLAPPING],
+           v[METRIC_PAIRS_COLLIDING]);
+  top_left = profiler_draw_hud_line(line, top_left);
+  snprintf(line, sizeof(line),
+           "allocs list %" PRIu64 " vec %" PRIu64 " pool %" PRIu64
+           " arena %" PRIu64,
+           v[METRIC_ALLOCS_LIST], v[METRIC_ALLOCS_VEC_ARRAY],
+           v[METRIC_ALLOCS_POOL], v[METRIC_ALLOCS_ARENA]);
+  top_left = profiler_draw_hud_line(line, top_left);
+  snprintf(line, sizeof(line),
+           "bodies +%" PRIu64 " -%" PRIu64 "  forces +%" PRIu64 " -%" PRIu64,
+           v[METRIC_BODIES_SPAWNED], v[METRIC_BODIES_REMOVED],
+           v[METRIC_FORCES_CREATED], v[METRIC_FORCES_REMOVED]);
+  top_left = profiler_draw_hud_line(line, top_left);
+  snprintf(line, sizeof(line), "texts %" PRIu64 " drawn, %" PRIu64 " glyphs",
+           v[METRIC_TEXTS_DRAWN], v[METRIC_GLYPHS_RASTERIZED]);
+  return profiler_draw_hud_line(line, top_left);
+}
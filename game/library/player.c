@@ -32,6 +32,8 @@ const color_t DEFAULT_COLOR = (color_t){.r = 1, .g = 1, .b = 1, .a = 1};
 
 const double SLUG_SEGMENT_SIZE = 8;
 const size_t SLUG_INIT_SEGMENTS = 5;
+// room for a long slug, so eating does not reallocate the segment list
+const size_t SLUG_SEGMENT_CAPACITY = 128;
 const double SLUG_MASS = 100;
 const double SLUG_RESOLUTION = 20;
 const double SLUG_GLOW_RESOLUTION = 10;
@@ -54,42 +56,24 @@ const vector_t SPAWNBOX_MAX = (vector_t){1400, 700};
 
 const double INNER_GLOW_ALPHA = 0.3;
 
-// Creates a circle
-list_t *make_round_shape(size_t num_points, double radius, vector_t center)
-{
-  list_t *circle = list_init(num_points, free);
-  double x_pos, y_pos;
-  double increment_angle = 2 * M_PI / num_points;
-  double angle = 0;
-  for (size_t i = 0; i < num_points; i++)
-  {
-    x_pos = cos(angle) * radius + center.x;
-    y_pos = sin(angle) * radius + center.y;
-    vector_t *point = malloc(sizeof(vector_t));
-    point->x = x_pos;
-    point->y = y_pos;
-    list_add(circle, point);
-    angle += increment_angle;
-  }
-  return circle;
-}
-
 player_t *player_init(size_t player_id, color_t color, vector_t pos, char left_key, char right_key, char boost_key, char shoot_key)
 {
   // make segments
-  list_t *meta_bodies = list_init(SLUG_INIT_SEGMENTS, free);
+  // the scene owns the segment bodies; the player only tracks them
+  list_t *meta_bodies = list_init(SLUG_SEGMENT_CAPACITY, NULL);
   vector_t circ_pos = pos;
   for (size_t i = 0; i < SLUG_INIT_SEGMENTS; i++)
   {
-    list_t *curr_circle = make_round_shape(SLUG_RESOLUTION, SLUG_SEGMENT_SIZE, circ_pos);
+    shape_t *curr_circle = shape_circle(SLUG_RESOLUTION, SLUG_SEGMENT_SIZE);
     list_t *info = list_init(2, free);
     char *body_type = malloc(sizeof(char) * INFO_MAX_LENGTH);
-    body_type = "player";
+    strcpy(body_type, "player");
     size_t *id = malloc(sizeof(size_t));
     *id = player_id;
     list_add(info, body_type);
     list_add(info, id);
-    body_t *curr_body = body_init_with_info(curr_circle, SLUG_MASS, color, info, free);
+    body_t *curr_body = body_init_shape_with_info(curr_circle, circ_pos, SLUG_MASS, color, info, list_free);
+    shape_release(curr_circle);
     double x_init_vel = rand_range(0, DEFAULT_BASE_SPEED);
     double y_init_vel = sqrt(pow(DEFAULT_BASE_SPEED, 2) - (pow(x_init_vel, 2)));
     body_set_velocity(curr_body, (vector_t){.x = x_init_vel, .y = y_init_vel});
@@ -179,7 +163,7 @@ void player_turn(player_t *p)
 
 void player_dash(player_t *p)
 {
-  sdl_play_sound(-1, "assets/dash.wav", 0);
+  sdl_play_sound(-1, SOUND_DASH, 0);
   list_t *bodies = p->meta_bodies;
   for (size_t i = 0; i < list_size(bodies); i++)
   {
@@ -191,27 +175,13 @@ void player_dash(player_t *p)
   player_refresh_cd_dash(p);
 }
 
-void player_eat(player_t *p, body_t *food, scene_t *scene)
+void player_eat(player_t *p, char *pu_type, scene_t *scene)
 {
-  list_t *info = (list_t *)body_get_info(food);
-  char *body_type = (char *)list_get(info, 0);
-  if (strcmp(body_type, "food") != 0)
-  {
-    return;
-  }
-  char *pu_type = (char *)list_get(info, 1);
-
-  char *effect = malloc(sizeof(char) * INFO_MAX_LENGTH);
-  strcpy(effect, "assets/");
-  strcat(effect, pu_type);
-  strcat(effect, ".wav");
-  sdl_play_sound(-1, effect, 0);
-  free(effect);
-
   player_update_food(p);
 
   if (strcmp(pu_type, "pu_base_speed") == 0)
   {
+    sdl_play_sound(-1, SOUND_PU_BASE_SPEED, 0);
     char *text = malloc(sizeof(char) * INFO_MAX_LENGTH);
     strcpy(text, "+MS  \0");
     vector_t center = body_get_centroid(player_get_head(p));
@@ -221,6 +191,7 @@ void player_eat(player_t *p, body_t *food, scene_t *scene)
   }
   else if (strcmp(pu_type, "pu_bullet_speed") == 0)
   {
+    sdl_play_sound(-1, SOUND_PU_BULLET_SPEED, 0);
     char *text = malloc(sizeof(char) * INFO_MAX_LENGTH);
     strcpy(text, "+BMS \0");
     vector_t center = body_get_centroid(player_get_head(p));
@@ -230,6 +201,7 @@ void player_eat(player_t *p, body_t *food, scene_t *scene)
   }
   else if (strcmp(pu_type, "pu_rotate_rate") == 0)
   {
+    sdl_play_sound(-1, SOUND_PU_ROTATE_RATE, 0);
     char *text = malloc(sizeof(char) * INFO_MAX_LENGTH);
     strcpy(text, "+ROT \0");
     vector_t center = body_get_centroid(player_get_head(p));
@@ -239,6 +211,7 @@ void player_eat(player_t *p, body_t *food, scene_t *scene)
   }
   else if (strcmp(pu_type, "pu_dash_boost") == 0)
   {
+    sdl_play_sound(-1, SOUND_PU_DASH_BOOST, 0);
     char *text = malloc(sizeof(char) * INFO_MAX_LENGTH);
     strcpy(text, "+DASH\0");
     vector_t center = body_get_centroid(player_get_head(p));
@@ -256,10 +229,11 @@ void player_update_stats(player_t *p)
 
 void player_draw_inner_glow(player_t *p)
 {
+  shape_t *inner_glow_shape = shape_circle(SLUG_GLOW_RESOLUTION, INNER_GLOW_SIZE * SLUG_SEGMENT_SIZE);
   for (size_t i = 0; i < list_size(p->meta_bodies); i++)
   {
     body_t *curr_body = list_get(p->meta_bodies, i);
-    list_t *inner_glow_circle = make_round_shape(SLUG_GLOW_RESOLUTION, INNER_GLOW_SIZE * SLUG_SEGMENT_SIZE, body_get_centroid(curr_body));
+    vec_array_t *inner_glow_circle = shape_place(inner_glow_shape, body_get_centroid(curr_body), 0, frame_arena());
     color_t inner_glow_color = body_get_color(curr_body);
     if (inner_glow_color.r != 1)
     {
@@ -274,8 +248,8 @@ void player_draw_inner_glow(player_t *p)
       inner_glow_color.b = inner_glow_color.b + INNER_GLOW_INTENSITY * (1 - inner_glow_color.b);
     }
     sdl_draw_polygon(inner_glow_circle, inner_glow_color);
-    list_free(inner_glow_circle);
   }
+  shape_release(inner_glow_shape);
 }
 
 void player_render_cosmetics_below(player_t *p)
@@ -288,16 +262,34 @@ void player_render_cosmetics_above(player_t *p)
   player_draw_inner_glow(p);
 }
 
+bool player_segment_removed(void *body, void *aux)
+{
+  return body_is_removed(body);
+}
+
+/** Flags every segment from the given index onwards for removal and drops them */
+void player_cut_tail(player_t *p, size_t first_removed)
+{
+  void **segments = list_data(p->meta_bodies);
+  for (size_t i = first_removed; i < list_size(p->meta_bodies); i++)
+  {
+    body_remove(segments[i]);
+  }
+  list_compact_if(p->meta_bodies, player_segment_removed, NULL);
+}
+
 void player_hit(player_t *predator, player_t *prey, body_t *body, scene_t *scene)
 {
-  sdl_play_sound(-1, "assets/death_dmg.wav", 0);
+  sdl_play_sound(-1, SOUND_DEATH_DMG, 0);
   // get index of the body that was hit in meta_bodies
-  double hit_body_idx = 0;
+  size_t hit_body_idx = 0;
+  void **segments = list_data(prey->meta_bodies);
   for (size_t i = 0; i < list_size(prey->meta_bodies); i++)
   {
-    if ((body_t *)list_get(prey->meta_bodies, i) == body)
+    if (segments[i] == body)
     {
       hit_body_idx = i;
+      break;
     }
   }
 
@@ -305,26 +297,15 @@ void player_hit(player_t *predator, player_t *prey, body_t *body, scene_t *scene
   {
     // if you hit tail
     // remove tails from scene
-    sdl_play_sound(-1, "assets/bullet_hit.wav", 0);
-    for (size_t i = hit_body_idx; i < list_size(prey->meta_bodies); i++)
-    {
-      for (size_t j = 0; j < scene_bodies(scene); j++)
-      {
-        if ((body_t *)list_get(prey->meta_bodies, i) == scene_get_body(scene, j))
-        {
-          list_remove(prey->meta_bodies, i);
-          i--;
-          scene_remove_body(scene, j);
-        }
-      }
-    }
+    sdl_play_sound(-1, SOUND_BULLET_HIT, 0);
+    player_cut_tail(prey, hit_body_idx);
   }
   else
   {
     // if critical strike (death)
     prey->dying = true;
     predator->stats_kills++;
-    sdl_play_sound(-1, "assets/death_scream.wav", 0);
+    sdl_play_sound(-1, SOUND_DEATH_SCREAM, 0);
   }
 }
 
@@ -384,7 +365,7 @@ void player_update_food(player_t *p)
 body_t *player_add_body(player_t *p)
 {
   vector_t player_tail_pos = body_get_centroid(player_get_tail(p));
-  list_t *new_tail = make_round_shape(SLUG_RESOLUTION, SLUG_SEGMENT_SIZE, player_tail_pos);
+  shape_t *new_tail = shape_circle(SLUG_RESOLUTION, SLUG_SEGMENT_SIZE);
   list_t *info = list_init(2, free);
   char *body_type = malloc(sizeof(char) * INFO_MAX_LENGTH);
   strcpy(body_type, "player\0");
@@ -392,7 +373,8 @@ body_t *player_add_body(player_t *p)
   *player_id = p->player_id;
   list_add(info, body_type);
   list_add(info, player_id);
-  body_t *curr_body = body_init_with_info(new_tail, SLUG_MASS, p->st_color, info, NULL);
+  body_t *curr_body = body_init_shape_with_info(new_tail, player_tail_pos, SLUG_MASS, p->st_color, info, list_free);
+  shape_release(new_tail);
   body_set_glow(curr_body, true);
   body_set_glow_radius(curr_body, SLUG_SEGMENT_SIZE);
   list_add(p->meta_bodies, curr_body);
@@ -403,7 +385,8 @@ void player_free(void *p)
 {
   player_t *p_casted = (player_t *)p;
   free(p_casted->ph_applied_force_magnitude);
-  free(p_casted->meta_bodies);
+  // the segments themselves belong to the scene they were added to
+  list_free(p_casted->meta_bodies);
   free(p_casted);
 }
 
@@ -420,6 +403,7 @@ void player_tick_periodic(player_t *p)
 {
   char *updated_score = player_get_score(p);
   text_edit(p->score_tag, updated_score);
+  free(updated_score);
 }
 
 void player_tick(player_t *p, double dt)
@@ -460,31 +444,13 @@ void player_respawn(player_t *p, scene_t *scene)
   p->pu_bullet_speed = 0;
   p->pu_dash_boost = 0;
 
+  // the segments are the player's own bodies, so there is no need to look
+  // them up in the scene
+  player_cut_tail(p, CRITICAL_BODIES);
   for (size_t i = 0; i < list_size(p->meta_bodies); i++)
   {
-    if (i <= CRITICAL_BODIES - 1)
-    {
-      for (size_t j = 0; j < scene_bodies(scene); j++)
-      {
-        if ((body_t *)list_get(p->meta_bodies, i) == scene_get_body(scene, j))
-        {
-          vector_t spawn_point = (vector_t){rand_range(SPAWNBOX_MIN.x, SPAWNBOX_MAX.x), rand_range(SPAWNBOX_MIN.y, SPAWNBOX_MAX.y)};
-          body_set_centroid(scene_get_body(scene, j), spawn_point);
-        }
-      }
-    }
-    else
-    {
-      for (size_t j = 0; j < scene_bodies(scene); j++)
-      {
-        if ((body_t *)list_get(p->meta_bodies, i) == scene_get_body(scene, j))
-        {
-          list_remove(p->meta_bodies, i);
-          i--;
-          scene_remove_body(scene, j);
-        }
-      }
-    }
+    vector_t spawn_point = (vector_t){rand_range(SPAWNBOX_MIN.x, SPAWNBOX_MAX.x), rand_range(SPAWNBOX_MIN.y, SPAWNBOX_MAX.y)};
+    body_set_centroid(list_get(p->meta_bodies, i), spawn_point);
   }
   p->dying = false;
 }
@@ -506,7 +472,7 @@ void player_tick_death(player_t *p, scene_t *scene)
   if (body_get_color(player_get_head(p)).a <= 0)
   {
     player_respawn(p, scene);
-    sdl_play_sound(-1, "assets/respawn.wav", 0);
+    sdl_play_sound(-1, SOUND_RESPAWN, 0);
     for (size_t i = 0; i < list_size(p->meta_bodies); i++)
     {
       body_t *curr_body = list_get(p->meta_bodies, i);
@@ -550,20 +516,21 @@ void player_set_color(player_t *p, color_t color)
 
 body_t *player_shoot(player_t *p)
 {
-  sdl_play_sound(-1, "assets/shoot.wav", 0);
+  sdl_play_sound(-1, SOUND_SHOOT, 0);
   body_t *head = player_get_head(p);
   vector_t bullet_direction = vec_normalize(body_get_velocity(head));
   vector_t bullet_spawn_position = vec_add(body_get_centroid(head), vec_multiply(BULLET_SPAWN_DISTANCE, bullet_direction));
   vector_t bullet_velocity = vec_multiply(calc_bullet_speed(p), bullet_direction);
-  list_t *new_bullet = make_round_shape(BULLET_RESOLUTION, BULLET_SIZE, bullet_spawn_position);
+  shape_t *new_bullet = shape_circle(BULLET_RESOLUTION, BULLET_SIZE);
   char *body_type = malloc(sizeof(char) * INFO_MAX_LENGTH);
-  body_type = "bullet";
+  strcpy(body_type, "bullet");
   size_t *id = malloc(sizeof(size_t));
   *id = p->player_id;
   list_t *info = list_init(2, free);
   list_add(info, body_type);
   list_add(info, id);
-  body_t *bullet = body_init_with_info(new_bullet, BULLET_MASS, p->st_color, info, NULL);
+  body_t *bullet = body_init_shape_with_info(new_bullet, bullet_spawn_position, BULLET_MASS, p->st_color, info, list_free);
+  shape_release(new_bullet);
   body_set_velocity(bullet, bullet_velocity);
   player_refresh_cd_bullet(p);
   return bullet;
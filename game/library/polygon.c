@@ -1,31 +1,32 @@
 #include "polygon.h"
 #include "color.h"
-#include "list.h"
 #include "test_util.h"
 #include "vector.h"
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
 
-double polygon_area(list_t *polygon) {
+double polygon_area(vec_array_t *polygon) {
+  size_t n = vec_array_size(polygon);
+  vector_t *v = vec_array_data(polygon);
   double area = 0.0;
-  for (size_t i = 0; i <= list_size(polygon) - 1; i++) {
-    vector_t v1 = *((vector_t *)list_get(polygon, i % list_size(polygon)));
-    vector_t v2 =
-        *((vector_t *)list_get(polygon, (i + 1) % list_size(polygon)));
+  for (size_t i = 0; i < n; i++) {
+    vector_t v1 = v[i];
+    vector_t v2 = v[(i + 1) % n];
     area += 0.5 * (v2.x + v1.x) * (v2.y - v1.y);
   }
   return fabs(area);
 }
 
-vector_t polygon_centroid(list_t *polygon) {
+vector_t polygon_centroid(vec_array_t *polygon) {
+  size_t n = vec_array_size(polygon);
+  vector_t *v = vec_array_data(polygon);
   double area = polygon_area(polygon);
   double x_coord = 0.0;
   double y_coord = 0.0;
-  for (size_t i = 0; i <= list_size(polygon) - 1; i++) {
-    vector_t v1 = *((vector_t *)list_get(polygon, i % list_size(polygon)));
-    vector_t v2 =
-        *((vector_t *)list_get(polygon, (i + 1) % list_size(polygon)));
+  for (size_t i = 0; i < n; i++) {
+    vector_t v1 = v[i];
+    vector_t v2 = v[(i + 1) % n];
     x_coord += (v1.x + v2.x) * (v1.x * v2.y - v2.x * v1.y);
     y_coord += (v1.y + v2.y) * (v1.x * v2.y - v2.x * v1.y);
   }
@@ -39,22 +40,335 @@ vector_t polygon_centroid(list_t *polygon) {
   return newVec;
 }
 
-void polygon_translate(list_t *polygon, vector_t translation) {
-  for (size_t i = 0; i < list_size(polygon); i++) {
-    vector_t *v = list_get(polygon, i);
-    *v = vec_add(*v, translation);
+void polygon_translate(vec_array_t *polygon, vector_t translation) {
+  size_t n = vec_array_size(polygon);
+  vector_t *v = vec_array_data(polygon);
+  for (size_t i = 0; i < n; i++) {
+    v[i].x += translation.x;
+    v[i].y += translation.y;
   }
 }
 
-void polygon_rotate(list_t *polygon, double angle, vector_t point) {
-  for (size_t i = 0; i < list_size(polygon); i++) {
-    vector_t *original_vector = list_get(polygon, i);
-    vector_t temp_vector = {.x = original_vector->x - point.x,
-                            .y = original_vector->y - point.y};
-    vector_t rotate_origin = vec_rotate(temp_vector, angle);
-    double x_coord = point.x + rotate_origin.x;
-    double y_coord = point.y + rotate_origin.y;
-    original_vector->x = x_coord;
-    original_vector->y = y_coord;
+void polygon_rotate(vec_array_t *polygon, double angle, vector_t point) {
+  size_t n = vec_array_size(polygon);
+  vector_t *v = vec_array_data(polygon);
+  double c = cos(angle), s = sin(angle);
+  for (size_t i = 0; i < n; i++) {
+    double x = v[i].x - point.x;
+    double y = v[i].y - point.y;
+    v[i].x = point.x + x * c - y * s;
+    v[i].y = point.y + x * s + y * c;
   }
 }
+
+aabb_t polygon_aabb(vec_array_t *polygon) {
+  size_t n = vec_array_size(polygon);
+  vector_t *v = vec_array_data(polygon);
+  aabb_t box = {.min = v[0], .max = v[0]};
+  for (size_t i = 1; i < n; i++) {
+    box.min.x = fmin(box.min.x, v[i].x);
+    box.min.y = fmin(box.min.y, v[i].y);
+    box.max.x = fmax(box.max.x, v[i].x);
+    box.max.y = fmax(box.max.y, v[i].y);
+  }
+  return box;
+}
+
+bool polygon_contains_point(vec_array_t *polygon, vector_t point) {
+  bool inside = false;
+  size_t n = vec_array_size(polygon);
+  vector_t *v = vec_array_data(polygon);
+  for (size_t i = 0, j = n - 1; i < n; j = i++) {
+    vector_t vi = v[i];
+    vector_t vj = v[j];
+    // count crossings of a ray going right from the point
+    if ((vi.y > point.y) != (vj.y > point.y) &&
+        point.x < (vj.x - vi.x) * (point.y - vi.y) / (vj.y - vi.y) + vi.x) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+/** Computes the squared distance from a point to the segment from a to b */
+double segment_dist_sq(vector_t point, vector_t a, vector_t b) {
+  vector_t ab = vec_subtract(b, a);
+  vector_t ap = vec_subtract(point, a);
+  double len_sq = vec_dot(ab, ab);
+  double t = len_sq == 0 ? 0 : fmax(0, fmin(1, vec_dot(ap, ab) / len_sq));
+  vector_t closest = vec_add(a, vec_multiply(t, ab));
+  vector_t diff = vec_subtract(point, closest);
+  return vec_dot(diff, diff);
+}
+
+bool polygon_overlaps_circle(vec_array_t *polygon, vector_t center,
+                             double radius) {
+  if (polygon_contains_point(polygon, center)) {
+    return true;
+  }
+  double radius_sq = radius * radius;
+  size_t n = vec_array_size(polygon);
+  vector_t *v = vec_array_data(polygon);
+  for (size_t i = 0; i < n; i++) {
+    if (segment_dist_sq(center, v[i], v[(i + 1) % n]) <= radius_sq) {
+      return true;
+    }
+  }
+  return false;
+}
+
+double polygon_raycast(vec_array_t *polygon, vector_t start, vector_t end) {
+  if (polygon_contains_point(polygon, start)) {
+    return 0;
+  }
+  vector_t dir = vec_subtract(end, start);
+  double best = INFINITY;
+  size_t n = vec_array_size(polygon);
+  vector_t *v = vec_array_data(polygon);
+  for (size_t i = 0; i < n; i++) {
+    vector_t a = v[i];
+    vector_t edge = vec_subtract(v[(i + 1) % n], a);
+    double denom = vec_cross(dir, edge);
+    if (denom == 0) {
+      continue; // parallel
+    }
+    vector_t to_edge = vec_subtract(a, start);
+    double t = vec_cross(to_edge, edge) / denom;
+    double u = vec_cross(to_edge, dir) / denom;
+    if (t >= 0 && t <= 1 && u >= 0 && u <= 1 && t < best) {
+      best = t;
+    }
+  }
+  return best;
+}
+
+// cross products smaller than this are treated as collinear
+const double POLYGON_EPSILON = 1e-9;
+
+typedef struct polygon_meta {
+  double area;
+  vector_t centroid;
+  double bounding_radius;
+  bool convex;
+  polygon_part_t *parts;
+  size_t num_parts;
+} polygon_meta_t;
+
+vector_t polygon_vertex(vec_array_t *polygon, size_t index) {
+  return vec_array_get(polygon, index);
+}
+
+/** Returns whether the turn a -> b -> c is counterclockwise (or straight) */
+bool polygon_turns_left(vector_t a, vector_t b, vector_t c) {
+  return vec_cross(vec_subtract(b, a), vec_subtract(c, b)) >= -POLYGON_EPSILON;
+}
+
+bool polygon_part_is_convex(vec_array_t *polygon, size_t *vertices, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    vector_t a = polygon_vertex(polygon, vertices[i]);
+    vector_t b = polygon_vertex(polygon, vertices[(i + 1) % n]);
+    vector_t c = polygon_vertex(polygon, vertices[(i + 2) % n]);
+    if (!polygon_turns_left(a, b, c)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool polygon_triangle_contains(vector_t a, vector_t b, vector_t c,
+                               vector_t p) {
+  return vec_cross(vec_subtract(b, a), vec_subtract(p, a)) >= 0 &&
+         vec_cross(vec_subtract(c, b), vec_subtract(p, b)) >= 0 &&
+         vec_cross(vec_subtract(a, c), vec_subtract(p, c)) >= 0;
+}
+
+size_t *polygon_indices(size_t n) {
+  size_t *indices = malloc(sizeof(size_t) * n);
+  assert(indices != NULL);
+  return indices;
+}
+
+/**
+ * Splits a counterclockwise polygon (given by vertex indices) into triangles
+ * by ear clipping. Returns the number of triangles written to parts.
+ */
+size_t polygon_triangulate(vec_array_t *polygon, size_t *order, size_t n,
+                           polygon_part_t *parts) {
+  size_t num_parts = 0;
+  size_t i = 0, failures = 0;
+  while (n > 3) {
+    size_t prev = order[(i + n - 1) % n], cur = order[i % n],
+           next = order[(i + 1) % n];
+    vector_t a = polygon_vertex(polygon, prev);
+    vector_t b = polygon_vertex(polygon, cur);
+    vector_t c = polygon_vertex(polygon, next);
+    bool ear = vec_cross(vec_subtract(b, a), vec_subtract(c, b)) >
+               POLYGON_EPSILON;
+    for (size_t j = 0; ear && j < n; j++) {
+      size_t other = order[j];
+      ear = other == prev || other == cur || other == next ||
+            !polygon_triangle_contains(a, b, c, polygon_vertex(polygon, other));
+    }
+    // a degenerate polygon may have no strict ears; clip anyway to finish
+    if (ear || failures >= n) {
+      parts[num_parts].vertices = polygon_indices(3);
+      parts[num_parts].vertices[0] = prev;
+      parts[num_parts].vertices[1] = cur;
+      parts[num_parts].vertices[2] = next;
+      parts[num_parts].num_vertices = 3;
+      num_parts++;
+      i %= n;
+      for (size_t j = i; j + 1 < n; j++) {
+        order[j] = order[j + 1];
+      }
+      n--;
+      failures = 0;
+    } else {
+      i = (i + 1) % n;
+      failures++;
+    }
+  }
+  parts[num_parts].vertices = polygon_indices(3);
+  for (size_t j = 0; j < 3; j++) {
+    parts[num_parts].vertices[j] = order[j];
+  }
+  parts[num_parts].num_vertices = 3;
+  return num_parts + 1;
+}
+
+/**
+ * Merges part b into part a if they share an edge and the result is convex
+ * (the Hertel-Mehlhorn step). Returns whether they were merged.
+ */
+bool polygon_try_merge(vec_array_t *polygon, polygon_part_t *a, polygon_part_t *b) {
+  size_t na = a->num_vertices, nb = b->num_vertices;
+  for (size_t i = 0; i < na; i++) {
+    size_t u = a->vertices[i], v = a->vertices[(i + 1) % na];
+    for (size_t j = 0; j < nb; j++) {
+      if (b->vertices[j] != v || b->vertices[(j + 1) % nb] != u) {
+        continue;
+      }
+      // walk a from v round to u, then b from after u round to before v
+      size_t *merged = polygon_indices(na + nb - 2);
+      size_t size = 0;
+      for (size_t k = 0; k < na; k++) {
+        merged[size++] = a->vertices[(i + 1 + k) % na];
+      }
+      for (size_t k = 2; k < nb; k++) {
+        merged[size++] = b->vertices[(j + k) % nb];
+      }
+      if (!polygon_part_is_convex(polygon, merged, size)) {
+        free(merged);
+        return false;
+      }
+      free(a->vertices);
+      a->vertices = merged;
+      a->num_vertices = size;
+      return true;
+    }
+  }
+  return false;
+}
+
+/** Fills in a part's edge normals, skipping ones parallel to an earlier one */
+void polygon_part_compute_axes(vec_array_t *polygon, polygon_part_t *part) {
+  part->axes = malloc(sizeof(vector_t) * part->num_vertices);
+  assert(part->axes != NULL);
+  part->num_axes = 0;
+  for (size_t i = 0; i < part->num_vertices; i++) {
+    vector_t v1 = polygon_vertex(polygon, part->vertices[i]);
+    vector_t v2 = polygon_vertex(
+        polygon, part->vertices[(i + 1) % part->num_vertices]);
+    if (vec_equals(v1, v2)) {
+      continue;
+    }
+    vector_t axis = vec_normalize(vec_perpendicular(vec_subtract(v2, v1)));
+    bool duplicate = false;
+    for (size_t j = 0; j < part->num_axes && !duplicate; j++) {
+      duplicate = fabs(vec_cross(axis, part->axes[j])) < POLYGON_EPSILON;
+    }
+    if (!duplicate) {
+      part->axes[part->num_axes] = axis;
+      part->num_axes++;
+    }
+  }
+}
+
+polygon_meta_t *polygon_meta_init(vec_array_t *polygon) {
+  size_t n = vec_array_size(polygon);
+  assert(n >= 3);
+  polygon_meta_t *meta = malloc(sizeof(polygon_meta_t));
+  assert(meta != NULL);
+  meta->area = polygon_area(polygon);
+  meta->centroid = polygon_centroid(polygon);
+  meta->bounding_radius = 0;
+  double signed_area = 0;
+  for (size_t i = 0; i < n; i++) {
+    vector_t v = polygon_vertex(polygon, i);
+    meta->bounding_radius =
+        fmax(meta->bounding_radius, vec_dist(v, meta->centroid));
+    signed_area += vec_cross(v, polygon_vertex(polygon, (i + 1) % n));
+  }
+
+  // work on the vertices in counterclockwise order
+  size_t *order = polygon_indices(n);
+  for (size_t i = 0; i < n; i++) {
+    order[i] = signed_area >= 0 ? i : n - 1 - i;
+  }
+  meta->convex = polygon_part_is_convex(polygon, order, n);
+  if (meta->convex) {
+    meta->parts = malloc(sizeof(polygon_part_t));
+    assert(meta->parts != NULL);
+    meta->parts[0].vertices = order;
+    meta->parts[0].num_vertices = n;
+    meta->num_parts = 1;
+  } else {
+    meta->parts = malloc(sizeof(polygon_part_t) * (n - 2));
+    assert(meta->parts != NULL);
+    meta->num_parts = polygon_triangulate(polygon, order, n, meta->parts);
+    free(order);
+    for (size_t i = 0; i < meta->num_parts; i++) {
+      for (size_t j = i + 1; j < meta->num_parts; j++) {
+        if (polygon_try_merge(polygon, &meta->parts[i], &meta->parts[j])) {
+          free(meta->parts[j].vertices);
+          meta->parts[j] = meta->parts[meta->num_parts - 1];
+          meta->num_parts--;
+          j = i; // part i grew: retry every other part against it
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < meta->num_parts; i++) {
+    polygon_part_compute_axes(polygon, &meta->parts[i]);
+  }
+  return meta;
+}
+
+void polygon_meta_free(polygon_meta_t *meta) {
+  for (size_t i = 0; i < meta->num_parts; i++) {
+    free(meta->parts[i].vertices);
+    free(meta->parts[i].axes);
+  }
+  free(meta->parts);
+  free(meta);
+}
+
+double polygon_meta_get_area(polygon_meta_t *meta) { return meta->area; }
+
+vector_t polygon_meta_get_centroid(polygon_meta_t *meta) {
+  return meta->centroid;
+}
+
+double polygon_meta_get_bounding_radius(polygon_meta_t *meta) {
+  return meta->bounding_radius;
+}
+
+bool polygon_meta_is_convex(polygon_meta_t *meta) { return meta->convex; }
+
+size_t polygon_meta_num_parts(polygon_meta_t *meta) { return meta->num_parts; }
+
+const polygon_part_t *polygon_meta_get_part(polygon_meta_t *meta,
+                                            size_t index) {
+  assert(index < meta->num_parts);
+  return &meta->parts[index];
+}
@@ -0,0 +1,162 @@
+#include "pool.h"
+#include "metrics.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdlib.h>
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define POOL_ASAN 1
+#endif
+#elif defined(__SANITIZE_ADDRESS__)
+#define POOL_ASAN 1
+#endif
+
+#ifdef POOL_ASAN
+#include <sanitizer/asan_interface.h>
+#define POOL_POISON(addr, size) ASAN_POISON_MEMORY_REGION(addr, size)
+#define POOL_UNPOISON(addr, size) ASAN_UNPOISON_MEMORY_REGION(addr, size)
+#else
+#define POOL_POISON(addr, size) ((void)(addr), (void)(size))
+#define POOL_UNPOISON(addr, size) ((void)(addr), (void)(size))
+#endif
+
+const size_t POOL_ALIGNMENT = alignof(max_align_t);
+
+typedef struct pool_slab {
+  struct pool_slab *next;
+  alignas(max_align_t) char data[];
+} pool_slab_t;
+
+/** A released object; the link lives in the object's own memory */
+typedef struct pool_node {
+  struct pool_node *next;
+} pool_node_t;
+
+typedef struct pool {
+  size_t elem_size;
+  size_t slab_count;
+  pool_slab_t *slabs;
+  size_t num_slabs;
+  pool_node_t *free_list;
+  size_t live;
+  // the module's pointer to the pool, if it was made by pool_get_shared()
+  struct pool **owner;
+  // the next pool in the registry
+  struct pool *next;
+} pool_t;
+
+/**
+ * Every pool that has not been freed, linked through the pools themselves,
+ * since lists are allocated from a pool.
+ */
+pool_t *pool_registry = NULL;
+
+pool_t *pool_init(size_t elem_size, size_t slab_count) {
+  assert(slab_count > 0);
+  pool_t *pool = malloc(sizeof(pool_t));
+  assert(pool != NULL);
+  metrics_add(METRIC_ALLOCS_POOL, 1);
+  if (elem_size < sizeof(pool_node_t)) {
+    elem_size = sizeof(pool_node_t);
+  }
+  pool->elem_size = (elem_size + POOL_ALIGNMENT - 1) & ~(POOL_ALIGNMENT - 1);
+  pool->slab_count = slab_count;
+  pool->slabs = NULL;
+  pool->num_slabs = 0;
+  pool->free_list = NULL;
+  pool->live = 0;
+  pool->owner = NULL;
+  pool->next = pool_registry;
+  pool_registry = pool;
+  return pool;
+}
+
+void pool_clear(pool_t *pool) {
+  while (pool->slabs != NULL) {
+    pool_slab_t *next = pool->slabs->next;
+    POOL_UNPOISON(pool->slabs->data, pool->elem_size * pool->slab_count);
+    free(pool->slabs);
+    pool->slabs = next;
+  }
+  pool->num_slabs = 0;
+  pool->free_list = NULL;
+  pool->live = 0;
+}
+
+pool_t *pool_get_shared(pool_t **pool, size_t elem_size, size_t slab_count) {
+  if (*pool == NULL) {
+    *pool = pool_init(elem_size, slab_count);
+    (*pool)->owner = pool;
+  }
+  return *pool;
+}
+
+void pool_free(pool_t *pool) {
+  pool_clear(pool);
+  pool_t **link = &pool_registry;
+  while (*link != pool) {
+    link = &(*link)->next;
+  }
+  *link = pool->next;
+  if (pool->owner != NULL) {
+    *pool->owner = NULL;
+  }
+  free(pool);
+}
+
+/** Allocates a new slab and threads all of its objects onto the free list */
+void pool_grow(pool_t *pool) {
+  pool_slab_t *slab =
+      malloc(sizeof(pool_slab_t) + pool->elem_size * pool->slab_count);
+  assert(slab != NULL);
+  metrics_add(METRIC_ALLOCS_POOL, 1);
+  slab->next = pool->slabs;
+  pool->slabs = slab;
+  pool->num_slabs++;
+  // push in reverse so objects are handed out in address order
+  for (size_t i = pool->slab_count; i > 0; i--) {
+    pool_node_t *node = (pool_node_t *)(slab->data + (i - 1) * pool->elem_size);
+    node->next = pool->free_list;
+    pool->free_list = node;
+    POOL_POISON(node, pool->elem_size);
+  }
+}
+
+void *pool_alloc(pool_t *pool) {
+  if (pool->free_list == NULL) {
+    pool_grow(pool);
+  }
+  pool_node_t *node = pool->free_list;
+  POOL_UNPOISON(node, pool->elem_size);
+  pool->free_list = node->next;
+  pool->live++;
+  return node;
+}
+
+void pool_release(pool_t *pool, void *elem) {
+  assert(pool->live > 0);
+  pool_node_t *node = elem;
+  node->next = pool->free_list;
+  pool->free_list = node;
+  pool->live--;
+  POOL_POISON(node, pool->elem_size);
+}
+
+size_t pool_get_live(pool_t *pool) { return pool->live; }
+
+size_t pool_get_slab_count(pool_t *pool) { return pool->num_slabs; }
+
+void pool_registry_free(void) {
+  pool_t **link = &pool_registry;
+  while (*link != NULL) {
+    pool_t *pool = *link;
+    assert(pool_get_live(pool) == 0);
+    // with asserts off, a leaked object keeps its pool, so ASAN reports it
+    if (pool_get_live(pool) != 0) {
+      link = &pool->next;
+      continue;
+    }
+    pool_free(pool);
+  }
+}
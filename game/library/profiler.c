@@ -0,0 +1,200 @@
+#include "profiler.h"
+#include "color.h"
+#include "sdl_wrapper.h"
+#include "trace.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// two seconds at 60 frames per second
+const size_t TICK_PROFILER_WINDOW = 120;
+#define PROFILER_MAX_DEPTH 8
+const double PROFILER_PERCENTILE = 0.99;
+const double PROFILER_LINE_HEIGHT = 16;
+const double PROFILER_CHAR_WIDTH = 8;
+const color_t PROFILER_TEXT_COLOR = {.r = 1, .g = 1, .b = 0.4, .a = 1};
+#define PROFILER_LINE_LENGTH 64
+
+const char *PROFILER_PHASE_NAMES[PROFILE_NUM_PHASES] = {
+    [PROFILE_FORCES] = "forces",
+    [PROFILE_INTEGRATE] = "integrate",
+    [PROFILE_BROAD_PHASE] = "broad",
+    [PROFILE_COLLISIONS] = "collisions",
+    [PROFILE_REMOVAL] = "removal",
+    [PROFILE_GLOW] = "glow",
+    [PROFILE_DRAW] = "draw",
+    [PROFILE_TEXT] = "text",
+    [PROFILE_PRESENT] = "present",
+};
+
+typedef struct {
+  profile_phase_t phase;
+  double start;
+} profiler_frame_t;
+
+typedef struct profiler {
+  // each phase's time in the current frame, in microseconds
+  double totals[PROFILE_NUM_PHASES];
+
+  // the phases being timed, innermost last
+  profiler_frame_t stack[PROFILER_MAX_DEPTH];
+  size_t depth;
+
+  // ring buffer of each phase's time in the last frames
+  double *samples[PROFILE_NUM_PHASES];
+  size_t window;
+  size_t next_sample;
+  size_t num_samples;
+  // room to sort one phase's samples
+  double *scratch;
+} profiler_t;
+
+profiler_t *tick_profiler_instance = NULL;
+
+double profiler_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e6 + now.tv_nsec * 1e-3;
+}
+
+profiler_t *profiler_init(size_t window) {
+  assert(window > 0);
+  profiler_t *profiler = calloc(1, sizeof(profiler_t));
+  assert(profiler != NULL);
+  for (size_t i = 0; i < PROFILE_NUM_PHASES; i++) {
+    profiler->samples[i] = calloc(window, sizeof(double));
+    assert(profiler->samples[i] != NULL);
+  }
+  profiler->scratch = malloc(window * sizeof(double));
+  assert(profiler->scratch != NULL);
+  profiler->window = window;
+  return profiler;
+}
+
+void profiler_free(profiler_t *profiler) {
+  if (profiler == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < PROFILE_NUM_PHASES; i++) {
+    free(profiler->samples[i]);
+  }
+  free(profiler->scratch);
+  free(profiler);
+}
+
+void profiler_begin(profiler_t *profiler, profile_phase_t phase) {
+  trace_begin(tick_tracer(), "phase", PROFILER_PHASE_NAMES[phase]);
+  if (profiler == NULL) {
+    return;
+  }
+  assert(phase < PROFILE_NUM_PHASES);
+  assert(profiler->depth < PROFILER_MAX_DEPTH);
+  profiler->stack[profiler->depth++] =
+      (profiler_frame_t){.phase = phase, .start = profiler_now()};
+}
+
+void profiler_end(profiler_t *profiler, profile_phase_t phase) {
+  trace_end(tick_tracer());
+  if (profiler == NULL) {
+    return;
+  }
+  assert(profiler->depth > 0);
+  profiler_frame_t frame = profiler->stack[--profiler->depth];
+  assert(frame.phase == phase);
+  double elapsed = profiler_now() - frame.start;
+  profiler->totals[phase] += elapsed;
+  // the enclosing phase only gets the time spent outside this one
+  if (profiler->depth > 0) {
+    profiler->totals[profiler->stack[profiler->depth - 1].phase] -= elapsed;
+  }
+}
+
+void profiler_end_frame(profiler_t *profiler) {
+  if (profiler == NULL) {
+    return;
+  }
+  assert(profiler->depth == 0);
+  for (size_t i = 0; i < PROFILE_NUM_PHASES; i++) {
+    profiler->samples[i][profiler->next_sample] = profiler->totals[i];
+    profiler->totals[i] = 0;
+  }
+  profiler->next_sample = (profiler->next_sample + 1) % profiler->window;
+  if (profiler->num_samples < profiler->window) {
+    profiler->num_samples++;
+  }
+}
+
+int profiler_compare_samples(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+profile_stats_t profiler_get_stats(profiler_t *profiler,
+                                   profile_phase_t phase) {
+  assert(phase < PROFILE_NUM_PHASES);
+  profile_stats_t stats = {0};
+  if (profiler == NULL || profiler->num_samples == 0) {
+    return stats;
+  }
+  size_t n = profiler->num_samples;
+  memcpy(profiler->scratch, profiler->samples[phase], n * sizeof(double));
+  qsort(profiler->scratch, n, sizeof(double), profiler_compare_samples);
+  double sum = 0;
+  for (size_t i = 0; i < n; i++) {
+    sum += profiler->scratch[i];
+  }
+  // nearest-rank percentile
+  size_t rank = (size_t)ceil(PROFILER_PERCENTILE * n);
+  stats.min = profiler->scratch[0];
+  stats.avg = sum / n;
+  stats.p99 = profiler->scratch[rank - 1];
+  return stats;
+}
+
+const char *profiler_phase_name(profile_phase_t phase) {
+  assert(phase < PROFILE_NUM_PHASES);
+  return PROFILER_PHASE_NAMES[phase];
+}
+
+vector_t profiler_draw_hud_line(const char *line, vector_t top_left) {
+  double width = strlen(line) * PROFILER_CHAR_WIDTH;
+  vector_t center = {top_left.x + width / 2,
+                     top_left.y - PROFILER_LINE_HEIGHT / 2};
+  sdl_draw_text(line, center, PROFILER_LINE_HEIGHT, PROFILER_CHAR_WIDTH,
+                PROFILER_TEXT_COLOR);
+  return (vector_t){top_left.x, top_left.y - PROFILER_LINE_HEIGHT};
+}
+
+vector_t profiler_draw_hud(profiler_t *profiler, vector_t top_left,
+                           size_t num_bodies, size_t num_forces) {
+  if (profiler == NULL) {
+    return top_left;
+  }
+  char line[PROFILER_LINE_LENGTH];
+  snprintf(line, sizeof(line), "%-10s %8s %8s %8s", "phase (us)", "min",
+           "avg", "p99");
+  top_left = profiler_draw_hud_line(line, top_left);
+  for (profile_phase_t i = 0; i < PROFILE_NUM_PHASES; i++) {
+    profile_stats_t stats = profiler_get_stats(profiler, i);
+    snprintf(line, sizeof(line), "%-10s %8.1f %8.1f %8.1f",
+             profiler_phase_name(i), stats.min, stats.avg, stats.p99);
+    top_left = profiler_draw_hud_line(line, top_left);
+  }
+  snprintf(line, sizeof(line), "bodies %zu  forces %zu", num_bodies,
+           num_forces);
+  return profiler_draw_hud_line(line, top_left);
+}
+
+profiler_t *tick_profiler(void) { return tick_profiler_instance; }
+
+void tick_profiler_set_enabled(bool enabled) {
+  if (enabled && tick_profiler_instance == NULL) {
+    tick_profiler_instance = profiler_init(TICK_PROFILER_WINDOW);
+  } else if (!enabled && tick_profiler_instance != NULL) {
+    profiler_free(tick_profiler_instance);
+    tick_profiler_instance = NULL;
+  }
+}
@@ -2,15 +2,20 @@
 #include "aux.h"
 #include "body.h"
 #include "force_wrapper.h"
+#include "metrics.h"
+#include "profiler.h"
 #include "sdl_wrapper.h"
+#include "spatial_grid.h"
 #include "state.h"
+#include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-const size_t DEFAULT_NUM_BODIES = 50;
-const size_t DEFAULT_NUM_TEXTS = 10;
-const size_t DEFAULT_NUM_FORCES = 20;
+const size_t DEFAULT_NUM_BODIES = 128;
+const size_t DEFAULT_NUM_TEXTS = 32;
+const size_t DEFAULT_NUM_FORCES = 1024;
+const double SCENE_INDEX_CELL_SIZE = 64;
 
 typedef struct scene {
   list_t *bodies;
@@ -18,6 +23,12 @@ typedef struct scene {
   list_t *forces;
   double time_s;
   bool dev_mode;
+
+  // spatial index over the bodies' fat boxes, brought up to date lazily
+  // by scene queries from the bodies that moved out of their fat boxes
+  spatial_grid_t *index;
+  list_t *moved;
+  list_t *query_scratch;
 } scene_t;
 
 scene_t *scene_init(void) {
@@ -27,6 +38,9 @@ scene_t *scene_init(void) {
   s->forces = list_init(DEFAULT_NUM_FORCES, force_free);
   s->time_s = 0;
   s->dev_mode = false;
+  s->index = spatial_grid_init(SCENE_INDEX_CELL_SIZE);
+  s->moved = list_init(DEFAULT_NUM_BODIES, NULL);
+  s->query_scratch = list_init(DEFAULT_NUM_BODIES, NULL);
   return s;
 }
 
@@ -34,6 +48,9 @@ void scene_free(scene_t *scene) {
   list_free(scene->bodies);
   list_free(scene->forces);
   list_free(scene->texts);
+  spatial_grid_free(scene->index);
+  list_free(scene->moved);
+  list_free(scene->query_scratch);
   free(scene);
 }
 
@@ -51,6 +68,7 @@ body_t *scene_get_body(scene_t *scene, size_t index) {
 
 void scene_add_body(scene_t *scene, body_t *body) {
   list_add(scene->bodies, body);
+  body_set_motion_list(body, scene->moved);
 }
 
 void scene_add_text(scene_t *scene, text_t *text) {
@@ -65,6 +83,7 @@ bool scene_get_dev_mode(scene_t *scene) { return scene->dev_mode; }
 
 void scene_set_dev_mode(scene_t *scene, bool dev_mode) {
   scene->dev_mode = dev_mode;
+  tick_profiler_set_enabled(dev_mode);
 }
 
 void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
@@ -80,6 +99,13 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
   list_add(scene->forces, force);
 }
 
+void scene_add_collision_creator(scene_t *scene, force_creator_t forcer,
+                                 void *aux, list_t *bodies, free_func_t freer) {
+  force_wrapper_t *force = force_init_with_bodies(forcer, aux, freer, bodies);
+  force_set_collision(force);
+  list_add(scene->forces, force);
+}
+
 void scene_remove_forces_from_body(scene_t *scene, body_t *body) {
   for (size_t i = 0; i < list_size(scene->forces); i++) {
     force_wrapper_t *force = list_get(scene->forces, i);
@@ -93,102 +119,290 @@ void scene_remove_forces_from_body(scene_t *scene, body_t *body) {
   }
 }
 
+/**
+ * Re-inserts the bodies that were added or moved out of their fat boxes
+ * since the last query
+ */
+void scene_update_index(scene_t *scene) {
+  size_t num_moved = list_size(scene->moved);
+  if (num_moved == 0) {
+    return;
+  }
+  profiler_begin(tick_profiler(), PROFILE_BROAD_PHASE);
+  void **moved = list_data(scene->moved);
+  for (size_t i = 0; i < num_moved; i++) {
+    body_t *body = moved[i];
+    body_clear_moved(body);
+    size_t handle = body_get_index_handle(body);
+    if (handle == SIZE_MAX) {
+      body_set_index_handle(
+          body, spatial_grid_insert(scene->index, body, body_get_fat_aabb(body)));
+    } else {
+      spatial_grid_move(scene->index, handle, body_get_fat_aabb(body));
+    }
+  }
+  list_clear(scene->moved);
+  profiler_end(tick_profiler(), PROFILE_BROAD_PHASE);
+}
+
+/** Returns whether a query with the given mask may return the body */
+bool scene_query_matches(body_t *body, uint32_t mask) {
+  return (body_get_layer(body) & mask) != 0 && !body_is_removed(body);
+}
+
+/** Fills the scratch list with the bodies whose boxes overlap the box */
+list_t *scene_query_candidates(scene_t *scene, aabb_t box) {
+  scene_update_index(scene);
+  list_t *candidates = scene->query_scratch;
+  list_clear(candidates);
+  spatial_grid_query(scene->index, box, candidates);
+  return candidates;
+}
+
+size_t scene_query_aabb(scene_t *scene, aabb_t box, uint32_t mask,
+                        list_t *out) {
+  list_t *candidates = scene_query_candidates(scene, box);
+  size_t found = 0;
+  for (size_t i = 0; i < list_size(candidates); i++) {
+    body_t *body = list_get(candidates, i);
+    // the index holds fat boxes, so recheck against the tight one
+    if (scene_query_matches(body, mask) &&
+        aabb_overlaps(body_get_aabb(body), box)) {
+      list_add(out, body);
+      found++;
+    }
+  }
+  return found;
+}
+
+size_t scene_query_radius(scene_t *scene, vector_t center, double radius,
+                          uint32_t mask, list_t *out) {
+  list_t *candidates =
+      scene_query_candidates(scene, aabb_from_circle(center, radius));
+  size_t found = 0;
+  for (size_t i = 0; i < list_size(candidates); i++) {
+    body_t *body = list_get(candidates, i);
+    if (scene_query_matches(body, mask) &&
+        body_overlaps_circle(body, center, radius)) {
+      list_add(out, body);
+      found++;
+    }
+  }
+  return found;
+}
+
+body_t *scene_query_point(scene_t *scene, vector_t point, uint32_t mask) {
+  list_t *candidates =
+      scene_query_candidates(scene, (aabb_t){.min = point, .max = point});
+  for (size_t i = 0; i < list_size(candidates); i++) {
+    body_t *body = list_get(candidates, i);
+    if (scene_query_matches(body, mask) && body_contains_point(body, point)) {
+      return body;
+    }
+  }
+  return NULL;
+}
+
+typedef struct scene_ray {
+  vector_t start;
+  vector_t end;
+  uint32_t mask;
+} scene_ray_t;
+
+double scene_ray_test(void *item, void *aux) {
+  body_t *body = (body_t *)item;
+  scene_ray_t *ray = (scene_ray_t *)aux;
+  if (!scene_query_matches(body, ray->mask)) {
+    return INFINITY;
+  }
+  return body_raycast(body, ray->start, ray->end);
+}
+
+bool scene_raycast(scene_t *scene, vector_t start, vector_t end, uint32_t mask,
+                   raycast_hit_t *hit) {
+  scene_update_index(scene);
+  scene_ray_t ray = {.start = start, .end = end, .mask = mask};
+  double fraction;
+  body_t *body = spatial_grid_raycast(scene->index, start, end, scene_ray_test,
+                                      &ray, &fraction);
+  if (body == NULL) {
+    return false;
+  }
+  if (hit != NULL) {
+    hit->body = body;
+    hit->fraction = fraction;
+    hit->point = vec_add(start, vec_multiply(fraction, vec_subtract(end, start)));
+  }
+  return true;
+}
+
 void scene_draw(scene_t *scene) {
+  profiler_begin(tick_profiler(), PROFILE_DRAW);
   for (size_t i = 0; i < scene_bodies(scene); i++) {
     body_t *body = scene_get_body(scene, i);
-    sdl_draw_polygon(body_get_shape(body), body_get_color(body));
+    sdl_draw_polygon(body_get_frame_shape(body), body_get_color(body));
     if (scene->dev_mode) {
       body_draw_acl(body);
     }
   }
+  profiler_end(tick_profiler(), PROFILE_DRAW);
 }
 
-void scene_tick(scene_t *scene, double dt) {
-  scene->time_s += dt;
-  for (size_t j = 0; j < list_size(scene->forces); j++) {
-    force_create(list_get(scene->forces, j));
-  }
+void scene_render(scene_t *scene) {
+  profiler_t *profiler = tick_profiler();
+  // glows lie below the bodies
+  profiler_begin(profiler, PROFILE_GLOW);
+  void **bodies = list_data(scene->bodies);
   for (size_t i = 0; i < scene_bodies(scene); i++) {
-    body_t *curr_body = scene_get_body(scene, i);
-    if (body_is_removed(curr_body)) {
-      scene_remove_forces_from_body(scene, curr_body);
-      body_t *removed_body = list_remove(scene->bodies, i);
-      body_free(removed_body);
-      i--;
-    } else {
-      body_tick(curr_body, dt);
+    if (body_get_glow(bodies[i])) {
+      body_draw_glow(bodies[i], body_get_glow_radius(bodies[i]));
     }
   }
+  profiler_end(profiler, PROFILE_GLOW);
+  scene_draw(scene);
+  profiler_begin(profiler, PROFILE_TEXT);
+  for (size_t i = 0; i < list_size(scene->texts); i++) {
+    text_t *t = list_get(scene->texts, i);
+    if (!t->removed) {
+      text_render(t);
+    }
+  }
+  profiler_end(profiler, PROFILE_TEXT);
+  if (scene->dev_mode) {
+    vector_t hud = profiler_draw_hud(profiler, sdl_get_top_left(),
+                                     scene_bodies(scene),
+                                     list_size(scene->forces));
+    metrics_draw_hud(hud);
+  }
+}
+
+/** Returns whether a force acts on a body that is about to be removed */
+bool scene_force_has_removed_body(force_wrapper_t *force) {
+  list_t *bodies = force_get_bodies(force);
+  if (bodies == NULL) {
+    return false;
+  }
+  void **data = list_data(bodies);
+  for (size_t j = 0; j < list_size(bodies); j++) {
+    if (body_is_removed(data[j])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool scene_body_should_remove(void *body, void *aux) {
+  return body_is_removed(body);
+}
+
+/** Takes a removed body out of the index before it is freed */
+bool scene_body_should_unindex(void *body, void *aux) {
+  if (!body_is_removed(body)) {
+    return false;
+  }
+  size_t handle = body_get_index_handle(body);
+  if (handle != SIZE_MAX) {
+    spatial_grid_remove(((scene_t *)aux)->index, handle);
+  }
+  return true;
+}
+
+bool scene_force_should_remove(void *force, void *aux) {
+  return force_is_removed(force);
+}
+
+/**
+ * Frees every body and force flagged for removal, along with the forces
+ * acting on removed bodies, in one pass over each list
+ */
+void scene_remove_flagged(scene_t *scene) {
+  void **forces = list_data(scene->forces);
   for (size_t i = 0; i < list_size(scene->forces); i++) {
-    force_wrapper_t *curr_force = list_get(scene->forces, i);
-    if (force_is_removed(curr_force)) {
-      force_wrapper_t *removed_force = list_remove(scene->forces, i);
-      force_free(removed_force);
-      i--;
+    if (scene_force_has_removed_body(forces[i])) {
+      force_remove(forces[i]);
     }
   }
+  list_compact_if(scene->moved, scene_body_should_remove, NULL);
+  list_compact_if(scene->bodies, scene_body_should_unindex, scene);
+  list_compact_if(scene->forces, scene_force_should_remove, NULL);
+}
+
+bool scene_text_should_remove(void *text, void *aux) {
+  return ((text_t *)text)->removed;
+}
+
+/**
+ * Applies every force, then every collision check,
+ * and then frees the flagged bodies and forces
+ */
+void scene_apply_forces(scene_t *scene) {
+  profiler_t *profiler = tick_profiler();
+  profiler_begin(profiler, PROFILE_FORCES);
+  for (size_t j = 0; j < list_size(scene->forces); j++) {
+    force_wrapper_t *force = list_get(scene->forces, j);
+    if (!force_is_collision(force)) {
+      force_create(force);
+    }
+  }
+  profiler_end(profiler, PROFILE_FORCES);
+  // timed once per tick: a span per pair would cost more than the test
+  profiler_begin(profiler, PROFILE_COLLISIONS);
+  for (size_t j = 0; j < list_size(scene->forces); j++) {
+    force_wrapper_t *force = list_get(scene->forces, j);
+    if (force_is_collision(force)) {
+      force_create(force);
+    }
+  }
+  profiler_end(profiler, PROFILE_COLLISIONS);
+  profiler_begin(profiler, PROFILE_REMOVAL);
+  scene_remove_flagged(scene);
+  profiler_end(profiler, PROFILE_REMOVAL);
+}
+
+void scene_tick(scene_t *scene, double dt) {
+  scene->time_s += dt;
+  scene_apply_forces(scene);
+  profiler_begin(tick_profiler(), PROFILE_INTEGRATE);
+  void **bodies = list_data(scene->bodies);
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_tick(bodies[i], dt);
+  }
+  profiler_end(tick_profiler(), PROFILE_INTEGRATE);
 }
 
 void scene_tick_canon(scene_t *scene, double dt) {
   scene->time_s += dt;
   // forces tick
-  for (size_t j = 0; j < list_size(scene->forces); j++) {
-    force_create(list_get(scene->forces, j));
-  }
+  scene_apply_forces(scene);
   // body tick
+  profiler_begin(tick_profiler(), PROFILE_INTEGRATE);
+  void **bodies = list_data(scene->bodies);
   for (size_t i = 0; i < scene_bodies(scene); i++) {
-    body_t *curr_body = scene_get_body(scene, i);
-    if (body_is_removed(curr_body)) {
-      scene_remove_forces_from_body(scene, curr_body);
-      body_t *removed_body = list_remove(scene->bodies, i);
-      body_free(removed_body);
-      i--;
-    } else {
-      body_tick_canon(curr_body, dt);
-      if (body_get_glow(curr_body)) body_draw_glow(curr_body, body_get_glow_radius(curr_body));
-    }
-  }
-  for (size_t i = 0; i < list_size(scene->forces); i++) {
-    force_wrapper_t *curr_force = list_get(scene->forces, i);
-    if (force_is_removed(curr_force)) {
-      force_wrapper_t *removed_force = list_remove(scene->forces, i);
-      force_free(removed_force);
-      i--;
-    }
+    body_tick_canon(bodies[i], dt);
   }
+  profiler_end(tick_profiler(), PROFILE_INTEGRATE);
 
   // texts tick
+  profiler_begin(tick_profiler(), PROFILE_TEXT);
   for (size_t i = 0; i < list_size(scene->texts); i++) {
     text_t *t = list_get(scene->texts, i);
     if(!t->removed) {
       text_tick(t, dt);
     }
   }
+  list_compact_if(scene->texts, scene_text_should_remove, NULL);
+  profiler_end(tick_profiler(), PROFILE_TEXT);
 }
 
 void scene_tick_canon_no_reset(scene_t *scene, double dt) {
   scene->time_s += dt;
-  for (size_t j = 0; j < list_size(scene->forces); j++) {
-    force_create(list_get(scene->forces, j));
-  }
+  scene_apply_forces(scene);
+  profiler_begin(tick_profiler(), PROFILE_INTEGRATE);
+  void **bodies = list_data(scene->bodies);
   for (size_t i = 0; i < scene_bodies(scene); i++) {
-    body_t *curr_body = scene_get_body(scene, i);
-    if (body_is_removed(curr_body)) {
-      scene_remove_forces_from_body(scene, curr_body);
-      body_t *removed_body = list_remove(scene->bodies, i);
-      body_free(removed_body);
-      i--;
-      body_tick_canon_no_reset(curr_body, dt);
-    }
-  }
-    for (size_t i = 0; i < list_size(scene->forces); i++) {
-    force_wrapper_t *curr_force = list_get(scene->forces, i);
-    if (force_is_removed(curr_force)) {
-      force_wrapper_t *removed_force = list_remove(scene->forces, i);
-      force_free(removed_force);
-      i--;
-    }
+    body_tick_canon_no_reset(bodies[i], dt);
   }
+  profiler_end(tick_profiler(), PROFILE_INTEGRATE);
 }
 
 void scene_accel_reset(scene_t *scene) {
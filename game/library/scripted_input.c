@@ -0,0 +1,197 @@
+#include "scripted_input.h"
+#include "sdl_null.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t SCRIPT_INITIAL_CAPACITY = 16;
+#define SCRIPT_MAX_LINE 128
+
+typedef enum { SCRIPT_MOUSE, SCRIPT_KEY, SCRIPT_QUIT } script_event_kind_t;
+
+typedef struct script_event {
+  size_t tick;
+  // the order the event was added in, to keep same-tick events in order
+  size_t seq;
+  script_event_kind_t kind;
+  vector_t pos;
+  char key;
+  key_event_type_t type;
+} script_event_t;
+
+typedef struct scripted_input {
+  script_event_t *events;
+  size_t size;
+  size_t capacity;
+  size_t next;
+  bool sorted;
+} scripted_input_t;
+
+typedef struct {
+  const char *name;
+  char key;
+} script_key_name_t;
+
+const script_key_name_t SCRIPT_KEY_NAMES[] = {
+    {"enter", '\r'},       {"space", ' '},      {"left", LEFT_ARROW},
+    {"up", UP_ARROW},      {"right", RIGHT_ARROW}, {"down", DOWN_ARROW},
+};
+
+scripted_input_t *scripted_input_init(void) {
+  scripted_input_t *input = malloc(sizeof(scripted_input_t));
+  assert(input != NULL);
+  input->events = malloc(sizeof(script_event_t) * SCRIPT_INITIAL_CAPACITY);
+  assert(input->events != NULL);
+  input->size = 0;
+  input->capacity = SCRIPT_INITIAL_CAPACITY;
+  input->next = 0;
+  input->sorted = true;
+  return input;
+}
+
+void scripted_input_free(scripted_input_t *input) {
+  free(input->events);
+  free(input);
+}
+
+void scripted_input_add(scripted_input_t *input, script_event_t event) {
+  if (input->size == input->capacity) {
+    input->capacity *= 2;
+    input->events =
+        realloc(input->events, sizeof(script_event_t) * input->capacity);
+    assert(input->events != NULL);
+  }
+  event.seq = input->size;
+  if (input->size > 0 && event.tick < input->events[input->size - 1].tick) {
+    input->sorted = false;
+  }
+  input->events[input->size++] = event;
+}
+
+void scripted_input_add_mouse(scripted_input_t *input, size_t tick,
+                              vector_t pos) {
+  scripted_input_add(
+      input, (script_event_t){.tick = tick, .kind = SCRIPT_MOUSE, .pos = pos});
+}
+
+void scripted_input_add_key(scripted_input_t *input, size_t tick, char key,
+                            key_event_type_t type) {
+  scripted_input_add(input, (script_event_t){.tick = tick,
+                                             .kind = SCRIPT_KEY,
+                                             .key = key,
+                                             .type = type});
+}
+
+void scripted_input_add_quit(scripted_input_t *input, size_t tick) {
+  scripted_input_add(input,
+                     (script_event_t){.tick = tick, .kind = SCRIPT_QUIT});
+}
+
+/** Parses a key name; returns '\0' if it isn't one */
+char script_parse_key(const char *name) {
+  if (strlen(name) == 1) {
+    return name[0];
+  }
+  for (size_t i = 0; i < sizeof(SCRIPT_KEY_NAMES) / sizeof(*SCRIPT_KEY_NAMES);
+       i++) {
+    if (strcmp(name, SCRIPT_KEY_NAMES[i].name) == 0) {
+      return SCRIPT_KEY_NAMES[i].key;
+    }
+  }
+  return '\0';
+}
+
+/** Parses one line of a script into the script; returns whether it was valid */
+bool script_parse_line(scripted_input_t *input, const char *line) {
+  size_t tick;
+  char command[16], arg[16];
+  double x, y;
+  int read = sscanf(line, "%zu %15s", &tick, command);
+  if (read < 1) {
+    // nothing but whitespace
+    return sscanf(line, " %15s", command) < 1;
+  }
+  if (read < 2) {
+    return false;
+  }
+  if (strcmp(command, "mouse") == 0 &&
+      sscanf(line, "%*u %*s %lf %lf", &x, &y) == 2) {
+    scripted_input_add_mouse(input, tick, (vector_t){x, y});
+    return true;
+  }
+  bool press = strcmp(command, "press") == 0,
+       release = strcmp(command, "release") == 0;
+  if ((press || release) && sscanf(line, "%*u %*s %15s", arg) == 1) {
+    char key = script_parse_key(arg);
+    if (key == '\0') {
+      return false;
+    }
+    scripted_input_add_key(input, tick, key, press ? KEY_PRESSED : KEY_RELEASED);
+    return true;
+  }
+  if (strcmp(command, "quit") == 0) {
+    scripted_input_add_quit(input, tick);
+    return true;
+  }
+  return false;
+}
+
+scripted_input_t *scripted_input_load(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    fprintf(stderr, "%s: could not open script\n", path);
+    return NULL;
+  }
+  scripted_input_t *input = scripted_input_init();
+  char line[SCRIPT_MAX_LINE];
+  size_t line_number = 0;
+  while (fgets(line, sizeof(line), file) != NULL) {
+    line_number++;
+    if (line[0] == '#') {
+      continue;
+    }
+    if (!script_parse_line(input, line)) {
+      fprintf(stderr, "%s:%zu: bad script line: %s", path, line_number, line);
+      scripted_input_free(input);
+      fclose(file);
+      return NULL;
+    }
+  }
+  fclose(file);
+  return input;
+}
+
+int script_event_cmp(const void *a, const void *b) {
+  const script_event_t *event_a = a, *event_b = b;
+  if (event_a->tick != event_b->tick) {
+    return event_a->tick < event_b->tick ? -1 : 1;
+  }
+  return event_a->seq < event_b->seq ? -1 : event_a->seq > event_b->seq;
+}
+
+void scripted_input_step(scripted_input_t *input, size_t tick) {
+  if (!input->sorted) {
+    qsort(input->events + input->next, input->size - input->next,
+          sizeof(script_event_t), script_event_cmp);
+    input->sorted = true;
+  }
+  while (input->next < input->size && input->events[input->next].tick <= tick) {
+    script_event_t *event = &input->events[input->next++];
+    switch (event->kind) {
+    case SCRIPT_MOUSE:
+      sdl_null_set_mouse(event->pos);
+      break;
+    case SCRIPT_KEY:
+      sdl_null_send_key(event->key, event->type);
+      break;
+    case SCRIPT_QUIT:
+      sdl_null_quit();
+      break;
+    }
+  }
+}
+
+bool scripted_input_done(scripted_input_t *input) {
+  return input->next == input->size;
+}
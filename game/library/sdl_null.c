@@ -0,0 +1,95 @@
+#include "sdl_null.h"
+#include "arena.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "trace.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+const double SDL_NULL_DEFAULT_TICK = 1.0 / 60;
+#define SDL_NULL_MAX_KEYS 64
+
+typedef struct {
+  char key;
+  key_event_type_t type;
+} null_key_event_t;
+
+key_handler_t null_key_handler = NULL;
+double null_tick = SDL_NULL_DEFAULT_TICK;
+vector_t null_mouse = {0, 0};
+vector_t null_top_left = {0, 0};
+bool null_quit = false;
+null_key_event_t null_keys[SDL_NULL_MAX_KEYS];
+size_t null_num_keys = 0;
+
+void sdl_null_set_tick(double dt) {
+  assert(dt > 0);
+  null_tick = dt;
+}
+
+void sdl_null_set_mouse(vector_t pos) { null_mouse = pos; }
+
+void sdl_null_send_key(char key, key_event_type_t type) {
+  assert(null_num_keys < SDL_NULL_MAX_KEYS);
+  null_keys[null_num_keys] = (null_key_event_t){.key = key, .type = type};
+  null_num_keys++;
+}
+
+void sdl_null_quit(void) { null_quit = true; }
+
+vector_t get_mouse_pos(void) { return null_mouse; }
+
+void sdl_init(vector_t min, vector_t max) {
+  null_top_left = (vector_t){min.x, max.y};
+}
+
+void sdl_quit(void) {}
+
+vector_t sdl_get_top_left(void) { return null_top_left; }
+
+bool sdl_is_done(state_t *state) {
+  for (size_t i = 0; i < null_num_keys; i++) {
+    if (null_key_handler != NULL) {
+      null_key_handler(state, null_keys[i].key, null_keys[i].type, 0);
+    }
+  }
+  null_num_keys = 0;
+  return null_quit;
+}
+
+void sdl_clear(void) {}
+
+void sdl_draw_polygon(vec_array_t *points, color_t color) {}
+
+void sdl_draw_regular_polygons(const vector_t *centers, const color_t *colors,
+                               size_t n, size_t sides, double radius) {}
+
+void sdl_draw_glows(const vector_t *centers, const color_t *colors, size_t n,
+                    double radius) {}
+
+void sdl_draw_text(const char *text, vector_t center, double height,
+                   double char_width, color_t color) {}
+
+void sdl_show(void) {
+  profiler_begin(tick_profiler(), PROFILE_PRESENT);
+  frame_arena_reset();
+  profiler_end(tick_profiler(), PROFILE_PRESENT);
+  profiler_end_frame(tick_profiler());
+  trace_end_frame(tick_tracer());
+  metrics_end_tick();
+}
+
+void sdl_set_frame_rate(double frame_rate) {}
+
+void sdl_set_render_thread(bool enabled) {}
+
+void sdl_render_scene(scene_t *scene) {}
+
+void sdl_play_sound(int channel, sound_id_t sound, int loops) {}
+
+void sdl_on_key(key_handler_t handler) { null_key_handler = handler; }
+
+double time_since_last_tick(void) { return null_tick; }
+
+void sdl_render_image(image_id_t image) {}
@@ -1,13 +1,20 @@
 #include "sdl_wrapper.h"
+#include "arena.h"
 #include "list.h"
 #include "body.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "trace.h"
 #include "scene.h"
+#include "sound_bank.h"
 #include "state.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL2_gfxPrimitives.h>
 #include <assert.h>
 #include <math.h>
+#include <stdatomic.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <SDL2/SDL_mixer.h>
 #include <SDL2/SDL_ttf.h>
@@ -19,10 +26,35 @@ const int WINDOW_WIDTH = 1600;
 const int WINDOW_HEIGHT = 900;
 const double MS_PER_S = 1e3;
 
-const TTF_Font *font;
+const char TEXT_FONT_PATH[] = "assets/joystix.ttf";
+// glyph atlases cover the printable ASCII characters
+#define TEXT_FIRST_GLYPH ' '
+#define TEXT_LAST_GLYPH '~'
+#define TEXT_NUM_GLYPHS (TEXT_LAST_GLYPH - TEXT_FIRST_GLYPH + 1)
+// atlases are built at power-of-2 point sizes between these
+#define TEXT_MIN_POINT_SIZE 16
+#define TEXT_NUM_ATLASES 4
+const int TEXT_ATLAS_COLUMNS = 16;
+// glows fade out over GLOW_FACTOR rings, GLOW_INCREASE apart,
+// each GLOW_REDUCTION times as opaque as the one inside it
+const double GLOW_SCALE = 0.1;
+const size_t GLOW_FACTOR = 8;
+const double GLOW_REDUCTION = 0.8;
+const double GLOW_INCREASE = 3;
+// glow radii are rounded to a multiple of this to pick a sprite
+const double GLOW_BUCKET_WIDTH = 0.5;
+const int GLOW_TEXTURE_SIZE = 64;
 const double frequency = 44100;
 const int channels = 2;
 const int chunk_size = 2048;
+// mixer channels below this are only used when a sound asks for them
+const int SOUND_FIRST_VOICE = 2;
+const size_t SOUND_NUM_VOICES = 16;
+// a sound queued again within this many seconds is dropped
+const double SOUND_COOLDOWN = 0.05;
+const double DEFAULT_FRAME_RATE = 60;
+// set in snapshot_middle when it holds a snapshot the renderer hasn't drawn
+#define SNAPSHOT_FRESH 4
 
 /**
  * The coordinate at the center of the screen.
@@ -32,12 +64,28 @@ vector_t center;
  * The coordinate difference from the center to the top right corner.
  */
 vector_t max_diff;
+/**
+ * The scene-to-pixel transform: a scene point p is drawn at pixel
+ * (view_scale * p.x + view_offset.x, -view_scale * p.y + view_offset.y).
+ * Only recomputed by sdl_update_viewport() when a frame arrives with a new
+ * window size.
+ */
+double view_scale;
+vector_t view_offset;
+/**
+ * The window's size in pixels, read by the event loop on the main thread
+ * and published with each snapshot, and the size the transform was last
+ * computed for by the renderer.
+ */
+int window_width = 0, window_height = 0;
+int viewport_width = 0, viewport_height = 0;
 /**
  * The SDL window where the scene is rendered.
  */
 SDL_Window *window;
 /**
  * The renderer used to draw the scene.
+ * Only used by the render thread, or by sdl_show() if there is none.
  */
 SDL_Renderer *renderer;
 /**
@@ -54,6 +102,176 @@ uint32_t key_start_timestamp;
  * Initially 0.
  */
 clock_t last_clock = 0;
+/**
+ * The untextured triangles queued this frame, drawn together by
+ * sdl_flush_geometry(). The buffers are kept between frames.
+ */
+SDL_Vertex *batch_vertices = NULL;
+size_t batch_num_vertices = 0;
+size_t batch_vertex_capacity = 0;
+int *batch_indices = NULL;
+size_t batch_num_indices = 0;
+size_t batch_index_capacity = 0;
+/**
+ * Scratch pixel coordinates for polygons drawn through SDL2_gfx.
+ */
+int16_t *gfx_points = NULL;
+size_t gfx_point_capacity = 0;
+/**
+ * The window coordinates of every point of the snapshot being drawn,
+ * and the corners of a regular polygon around the origin, in pixels.
+ */
+SDL_FPoint *pixel_points = NULL;
+size_t pixel_point_capacity = 0;
+SDL_FPoint *unit_corners = NULL;
+size_t unit_corner_capacity = 0;
+
+/**
+ * The kinds of draw calls a snapshot records.
+ */
+typedef enum {
+  DRAW_POLYGON,
+  DRAW_REGULAR_POLYGONS,
+  DRAW_GLOWS,
+  DRAW_TEXT,
+  DRAW_IMAGE
+} draw_kind_t;
+
+/**
+ * One recorded draw call. Its points, colors and characters are stored in
+ * the snapshot's arrays, starting at the given indices.
+ */
+typedef struct draw_command {
+  draw_kind_t kind;
+  // the number of vertices, polygons, glows or characters
+  size_t count;
+  size_t first_point;
+  size_t first_color;
+  size_t first_char;
+  color_t color;
+  size_t sides;
+  double radius;
+  double height;
+  double width;
+  image_id_t image;
+} draw_command_t;
+
+/**
+ * Everything drawn in one frame, recorded by the sdl_draw_*() functions so
+ * the frame can be drawn later, on another thread.
+ * The buffers are kept between frames.
+ */
+typedef struct snapshot {
+  draw_command_t *commands;
+  size_t num_commands;
+  size_t command_capacity;
+  vector_t *points;
+  size_t num_points;
+  size_t point_capacity;
+  color_t *colors;
+  size_t num_colors;
+  size_t color_capacity;
+  char *chars;
+  size_t num_chars;
+  size_t char_capacity;
+  // the window's size when the frame was published
+  int window_width;
+  int window_height;
+} snapshot_t;
+
+/**
+ * A triple buffer of snapshots. The game records into snapshot_back while
+ * the renderer draws snapshot_front. sdl_show() swaps the back snapshot with
+ * the middle one, and the renderer swaps the front one with the middle one
+ * whenever it is fresh, so neither side ever waits for the other.
+ */
+snapshot_t snapshots[3] = {{0}};
+int snapshot_back = 0;
+atomic_int snapshot_middle = 1;
+int snapshot_front = 2;
+/**
+ * The thread that draws published snapshots, woken by render_wake.
+ * NULL if threads are unavailable or were switched off before sdl_init(),
+ * in which case sdl_show() draws them.
+ */
+bool render_thread_enabled = true;
+SDL_Thread *render_thread = NULL;
+SDL_sem *render_wake = NULL;
+/**
+ * Set by sdl_quit() to make the render and audio threads return
+ * the next time they are woken.
+ */
+atomic_bool sdl_threads_stopping = false;
+/**
+ * The time between frames that sdl_show() keeps to, in seconds,
+ * and the performance counter value it waits for next.
+ */
+double frame_period;
+Uint64 next_frame = 0;
+
+int sdl_render_thread(void *aux);
+
+/**
+ * Every printable glyph of the font rendered once at one point size,
+ * along with the text quads queued against it this frame.
+ */
+typedef struct glyph_atlas {
+  SDL_Texture *texture;
+  SDL_Rect glyphs[TEXT_NUM_GLYPHS];
+  SDL_Vertex *vertices;
+  size_t num_vertices;
+  size_t vertex_capacity;
+  int *indices;
+  size_t num_indices;
+  size_t index_capacity;
+} glyph_atlas_t;
+
+/**
+ * A glow baked into a texture for one glow radius, along with the quads
+ * queued against it since the last flush.
+ */
+typedef struct glow_sprite {
+  long bucket;
+  SDL_Texture *texture;
+  SDL_Vertex *vertices;
+  size_t num_vertices;
+  size_t vertex_capacity;
+  int *indices;
+  size_t num_indices;
+  size_t index_capacity;
+} glow_sprite_t;
+
+/**
+ * The glow sprites baked so far, one per radius bucket.
+ */
+glow_sprite_t **glow_sprites = NULL;
+size_t glow_num_sprites = 0;
+size_t glow_sprite_capacity = 0;
+
+/**
+ * Every sound and image, decoded once by sdl_load_assets().
+ * Assets whose files couldn't be loaded are left NULL.
+ */
+Mix_Chunk *sound_chunks[NUM_SOUNDS] = {NULL};
+SDL_Texture *image_textures[NUM_IMAGES] = {NULL};
+bool image_loaded[NUM_IMAGES] = {false};
+/**
+ * Play commands queued by sdl_play_sound() for the audio thread.
+ */
+sound_bank_t *sound_bank = NULL;
+/**
+ * The thread that starts queued sounds, woken by audio_wake.
+ * NULL if threads are unavailable (e.g. in the browser),
+ * in which case sdl_show() starts them instead.
+ */
+SDL_Thread *audio_thread = NULL;
+SDL_sem *audio_wake = NULL;
+
+/**
+ * The glyph atlas for each point size, built the first time it is needed.
+ * Atlas i is rendered at TEXT_MIN_POINT_SIZE << i points.
+ */
+glyph_atlas_t *glyph_atlases[TEXT_NUM_ATLASES] = {NULL};
 
 typedef struct context {
     SDL_Rect dest;
@@ -67,50 +285,61 @@ typedef struct context {
 
 
 vector_t get_mouse_pos(void) {
-  int *x = malloc(sizeof(int));
-  int *y = malloc(sizeof(int));
-  SDL_GetMouseState(x, y);
-  vector_t dimensions = {.x = *x, .y = *y};
-  free(x);
-  free(y);
-  return dimensions;
-}
-
-/** Computes the center of the window in pixel coordinates */
-vector_t get_window_center(void) {
-  int *width = malloc(sizeof(*width)), *height = malloc(sizeof(*height));
-  assert(width != NULL);
-  assert(height != NULL);
-  SDL_GetWindowSize(window, width, height);
-  vector_t dimensions = {.x = *width, .y = *height};
-  free(width);
-  free(height);
-  return vec_multiply(0.5, dimensions);
+  int x, y;
+  SDL_GetMouseState(&x, &y);
+  return (vector_t){.x = x, .y = y};
 }
 
 /**
- * Computes the scaling factor between scene coordinates and pixel coordinates.
+ * Recomputes the scene-to-pixel transform for a window size.
  * The scene is scaled by the same factor in the x and y dimensions,
- * chosen to maximize the size of the scene while keeping it in the window.
+ * chosen to maximize the size of the scene while keeping it in the window,
+ * and the center of the scene is mapped to the center of the window.
  */
-double get_scene_scale(vector_t window_center) {
-  // Scale scene so it fits entirely in the window
+void sdl_update_viewport(int width, int height) {
+  viewport_width = width;
+  viewport_height = height;
+  vector_t window_center = {.x = 0.5 * width, .y = 0.5 * height};
   double x_scale = window_center.x / max_diff.x,
          y_scale = window_center.y / max_diff.y;
-  return x_scale < y_scale ? x_scale : y_scale;
+  view_scale = x_scale < y_scale ? x_scale : y_scale;
+  // Flip y axis since positive y is down on the screen
+  view_offset = (vector_t){.x = window_center.x - view_scale * center.x,
+                           .y = window_center.y + view_scale * center.y};
 }
 
+/** Gets the number of pixels per unit of scene distance */
+double get_scene_scale(void) { return view_scale; }
+
 /** Maps a scene coordinate to a window coordinate */
-vector_t get_window_position(vector_t scene_pos, vector_t window_center) {
-  // Scale scene coordinates by the scaling factor
-  // and map the center of the scene to the center of the window
-  vector_t scene_center_offset = vec_subtract(scene_pos, center);
-  double scale = get_scene_scale(window_center);
-  vector_t pixel_center_offset = vec_multiply(scale, scene_center_offset);
-  vector_t pixel = {.x = round(window_center.x + pixel_center_offset.x),
-                    // Flip y axis since positive y is down on the screen
-                    .y = round(window_center.y - pixel_center_offset.y)};
-  return pixel;
+vector_t get_window_position(vector_t scene_pos) {
+  return (vector_t){.x = view_scale * scene_pos.x + view_offset.x,
+                    .y = -view_scale * scene_pos.y + view_offset.y};
+}
+
+/**
+ * Maps a run of scene points to window coordinates.
+ * The loop only reads points and writes floats, so the compiler can
+ * vectorize it.
+ */
+void sdl_transform_points(const vector_t *restrict points, size_t n,
+                          SDL_FPoint *restrict pixels) {
+  double scale = view_scale, offset_x = view_offset.x,
+         offset_y = view_offset.y;
+  for (size_t i = 0; i < n; i++) {
+    pixels[i].x = scale * points[i].x + offset_x;
+    pixels[i].y = -scale * points[i].y + offset_y;
+  }
+}
+
+/**
+ * Fills untextured vertices with a run of window coordinates and a color.
+ */
+void sdl_fill_vertices(const SDL_FPoint *pixels, size_t n,
+                       SDL_Vertex *vertices, SDL_Color color) {
+  for (size_t i = 0; i < n; i++) {
+    vertices[i] = (SDL_Vertex){pixels[i], color, {0, 0}};
+  }
 }
 
 /**
@@ -134,6 +363,60 @@ char get_keycode(SDL_Keycode key) {
   }
 }
 
+/** Decodes every sound so they can be played without disk I/O */
+void sdl_load_assets(void) {
+  // the number of bytes of audio played per second
+  int rate = 0, num_channels = 0;
+  Uint16 format = 0;
+  Mix_QuerySpec(&rate, &format, &num_channels);
+  double bytes_per_s = rate * num_channels * (SDL_AUDIO_BITSIZE(format) / 8);
+
+  for (sound_id_t sound = 0; sound < NUM_SOUNDS; sound++) {
+    sound_chunks[sound] = Mix_LoadWAV(asset_sound_path(sound));
+    if (sound_chunks[sound] == NULL) {
+      printf("Could not load %s: %s\n", asset_sound_path(sound), Mix_GetError());
+    } else if (bytes_per_s > 0) {
+      sound_bank_set_length(sound_bank, sound,
+                            sound_chunks[sound]->alen / bytes_per_s);
+    }
+  }
+}
+
+/**
+ * Gets the texture for an image, loading it the first time.
+ * Textures belong to the renderer, so this runs on the thread that draws.
+ */
+SDL_Texture *get_image_texture(image_id_t image) {
+  if (!image_loaded[image]) {
+    image_loaded[image] = true;
+    SDL_Surface *surface = SDL_LoadBMP(asset_image_path(image));
+    if (surface == NULL) {
+      printf("Could not load %s: %s\n", asset_image_path(image), SDL_GetError());
+      return NULL;
+    }
+    image_textures[image] = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_FreeSurface(surface);
+  }
+  return image_textures[image];
+}
+
+/** Starts every queued sound on the voice picked for it */
+void sdl_start_sounds(void) {
+  double now = SDL_GetTicks() / MS_PER_S;
+  sound_command_t command;
+  while (sound_bank_pop(sound_bank, &command)) {
+    int channel = sound_bank_assign_voice(sound_bank, command, now);
+    Mix_PlayChannel(channel, sound_chunks[command.sound], command.loops);
+  }
+}
+
+int sdl_audio_thread(void *aux) {
+  while (SDL_SemWait(audio_wake) == 0 && !atomic_load(&sdl_threads_stopping)) {
+    sdl_start_sounds();
+  }
+  return 0;
+}
+
 void sdl_init(vector_t min, vector_t max) {
   // Check parameters
   assert(min.x < max.x);
@@ -143,117 +426,537 @@ void sdl_init(vector_t min, vector_t max) {
   max_diff = vec_subtract(max, center);
   SDL_Init(SDL_INIT_EVERYTHING);
   TTF_Init();
-  font = TTF_OpenFont("assets/joystix.ttf", 100);
 
   // init mixer
   if( Mix_OpenAudio( frequency, MIX_DEFAULT_FORMAT, channels, chunk_size ) < 0 ) {
       printf( "SDL_mixer could not initialize! SDL_mixer Error: %s\n", Mix_GetError() );
   }
+  Mix_AllocateChannels(SOUND_FIRST_VOICE + SOUND_NUM_VOICES);
+  sound_bank = sound_bank_init(SOUND_FIRST_VOICE, SOUND_NUM_VOICES, SOUND_COOLDOWN);
+  audio_wake = SDL_CreateSemaphore(0);
+  audio_thread = SDL_CreateThread(sdl_audio_thread, "audio", NULL);
 
   window = SDL_CreateWindow(WINDOW_TITLE, SDL_WINDOWPOS_CENTERED,
                             SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT,
                             SDL_WINDOW_RESIZABLE);
+  SDL_GetWindowSize(window, &window_width, &window_height);
+  sdl_load_assets();
+  sdl_set_frame_rate(DEFAULT_FRAME_RATE);
+
+  // some backends only support creating the renderer on the window's thread
   renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
+
+  // In the browser, the page's animation frames pace the game
+  // and everything has to be drawn on the main thread
+#ifndef __EMSCRIPTEN__
+  if (render_thread_enabled) {
+    // let go of the renderer's GL context, if it has one,
+    // so the render thread can make it current there
+    SDL_GL_MakeCurrent(window, NULL);
+    render_wake = SDL_CreateSemaphore(0);
+    render_thread = SDL_CreateThread(sdl_render_thread, "render", NULL);
+  }
+#endif
+}
+
+void sdl_quit(void) {
+  atomic_store(&sdl_threads_stopping, true);
+  if (render_thread != NULL) {
+    SDL_SemPost(render_wake);
+    SDL_WaitThread(render_thread, NULL);
+    render_thread = NULL;
+    SDL_DestroySemaphore(render_wake);
+    render_wake = NULL;
+  }
+  if (audio_thread != NULL) {
+    SDL_SemPost(audio_wake);
+    SDL_WaitThread(audio_thread, NULL);
+    audio_thread = NULL;
+  }
+  SDL_DestroySemaphore(audio_wake);
+  audio_wake = NULL;
+  // the renderer's textures go with it
+  SDL_DestroyRenderer(renderer);
+  renderer = NULL;
+  SDL_DestroyWindow(window);
+  window = NULL;
+  for (sound_id_t sound = 0; sound < NUM_SOUNDS; sound++) {
+    Mix_FreeChunk(sound_chunks[sound]);
+    sound_chunks[sound] = NULL;
+  }
+  Mix_CloseAudio();
+  TTF_Quit();
+  SDL_Quit();
+}
+
+vector_t sdl_get_top_left(void) {
+  return (vector_t){center.x - max_diff.x, center.y + max_diff.y};
 }
 
 bool sdl_is_done(state_t *state) {
-  SDL_Event *event = malloc(sizeof(*event));
-  assert(event != NULL);
-  while (SDL_PollEvent(event)) {
-    switch (event->type) {
+  SDL_Event event;
+  while (SDL_PollEvent(&event)) {
+    switch (event.type) {
     case SDL_QUIT:
-      free(event);
       return true;
+    case SDL_WINDOWEVENT:
+      // the renderer may be on another thread, where the video subsystem
+      // must not be used, so it gets the size along with the next frame
+      if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+        SDL_GetWindowSize(window, &window_width, &window_height);
+      }
+      break;
     case SDL_KEYDOWN:
     case SDL_KEYUP:
       // Skip the keypress if no handler is configured
       // or an unrecognized key was pressed
       if (key_handler == NULL)
         break;
-      char key = get_keycode(event->key.keysym.sym);
+      char key = get_keycode(event.key.keysym.sym);
       if (key == '\0')
         break;
 
-      uint32_t timestamp = event->key.timestamp;
-      if (!event->key.repeat) {
+      uint32_t timestamp = event.key.timestamp;
+      if (!event.key.repeat) {
         key_start_timestamp = timestamp;
       }
       key_event_type_t type =
-          event->type == SDL_KEYDOWN ? KEY_PRESSED : KEY_RELEASED;
+          event.type == SDL_KEYDOWN ? KEY_PRESSED : KEY_RELEASED;
       double held_time = (timestamp - key_start_timestamp) / MS_PER_S;
       key_handler(state, key, type, held_time);
       break;
     }
   }
-  free(event);
   return false;
 }
 
-void sdl_clear(void) {
+void render_clear(void) {
   SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
   SDL_RenderClear(renderer);
 }
 
-void sdl_draw_polygon(list_t *points, color_t color) {
-  // Check parameters
-  size_t n = list_size(points);
-  assert(n >= 3);
-  assert(0 <= color.r && color.r <= 1);
-  assert(0 <= color.g && color.g <= 1);
-  assert(0 <= color.b && color.b <= 1);
-  assert(0 <= color.a && color.a <= 1);
+/**
+ * Grows a scratch buffer used by the batched draw functions.
+ * The buffers are kept between frames so steady-state batches don't allocate.
+ */
+void *sdl_reserve_scratch(void *buffer, size_t *capacity, size_t needed,
+                          size_t elem_size) {
+  if (*capacity >= needed) {
+    return buffer;
+  }
+  size_t new_capacity = needed * 2;
+  buffer = realloc(buffer, elem_size * new_capacity);
+  assert(buffer != NULL);
+  *capacity = new_capacity;
+  return buffer;
+}
+
+/**
+ * Makes room in the geometry batch for a number of extra vertices and indices.
+ * Returns the index of the first new vertex.
+ */
+int sdl_reserve_geometry(size_t vertices, size_t indices) {
+  batch_vertices =
+      sdl_reserve_scratch(batch_vertices, &batch_vertex_capacity,
+                          batch_num_vertices + vertices, sizeof(SDL_Vertex));
+  batch_indices =
+      sdl_reserve_scratch(batch_indices, &batch_index_capacity,
+                          batch_num_indices + indices, sizeof(int));
+  return batch_num_vertices;
+}
 
-  vector_t window_center = get_window_center();
+/** Appends the indices of a triangle fan around the vertex first */
+void sdl_add_fan(int first, size_t n) {
+  for (size_t k = 1; k + 1 < n; k++) {
+    batch_indices[batch_num_indices++] = first;
+    batch_indices[batch_num_indices++] = first + k;
+    batch_indices[batch_num_indices++] = first + k + 1;
+  }
+}
 
-  // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points != NULL);
-  assert(y_points != NULL);
+/**
+ * Draws the geometry queued since the last flush in one draw call.
+ * Must be called before anything that isn't batched is drawn,
+ * so the draw order is kept.
+ */
+void sdl_flush_geometry(void) {
+  if (batch_num_indices == 0) {
+    return;
+  }
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+  SDL_RenderGeometry(renderer, NULL, batch_vertices, batch_num_vertices,
+                     batch_indices, batch_num_indices);
+  batch_num_vertices = 0;
+  batch_num_indices = 0;
+}
+
+/**
+ * Computes the opacity of a glow at some distance from its center.
+ * The glow looks like GLOW_FACTOR stacked translucent circles,
+ * with each circle's edge blurred into the gap before the next one.
+ */
+double glow_profile(double radius, double distance) {
+  double alpha = GLOW_SCALE, clear = 1;
+  for (size_t j = 0; j < GLOW_FACTOR; j++) {
+    alpha *= GLOW_REDUCTION;
+    double edge = radius + GLOW_INCREASE * j;
+    double cover = (edge - distance) / GLOW_INCREASE + 0.5;
+    cover = cover < 0 ? 0 : cover > 1 ? 1 : cover;
+    clear *= 1 - alpha * cover;
+  }
+  return 1 - clear;
+}
+
+/** Gets the distance from the center to the edge of a glow's sprite */
+double glow_extent(double radius) {
+  return radius + GLOW_INCREASE * GLOW_FACTOR;
+}
+
+/**
+ * Bakes the glow for a radius bucket into a white texture.
+ * The glow's color comes from the vertices it is drawn with.
+ */
+glow_sprite_t *glow_sprite_init(long bucket) {
+  double radius = bucket * GLOW_BUCKET_WIDTH, extent = glow_extent(radius);
+  SDL_Surface *surface =
+      SDL_CreateRGBSurfaceWithFormat(0, GLOW_TEXTURE_SIZE, GLOW_TEXTURE_SIZE,
+                                     32, SDL_PIXELFORMAT_ARGB8888);
+  assert(surface != NULL);
+  for (int y = 0; y < GLOW_TEXTURE_SIZE; y++) {
+    uint32_t *row = (uint32_t *)((uint8_t *)surface->pixels + y * surface->pitch);
+    for (int x = 0; x < GLOW_TEXTURE_SIZE; x++) {
+      // distance from the center of the texel to the center of the texture
+      double dx = (x + 0.5) / GLOW_TEXTURE_SIZE * 2 - 1,
+             dy = (y + 0.5) / GLOW_TEXTURE_SIZE * 2 - 1;
+      double alpha = glow_profile(radius, extent * sqrt(dx * dx + dy * dy));
+      row[x] = SDL_MapRGBA(surface->format, 255, 255, 255, round(alpha * 255));
+    }
+  }
+
+  glow_sprite_t *sprite = malloc(sizeof(glow_sprite_t));
+  assert(sprite != NULL);
+  sprite->bucket = bucket;
+  sprite->texture = SDL_CreateTextureFromSurface(renderer, surface);
+  assert(sprite->texture != NULL);
+  SDL_SetTextureBlendMode(sprite->texture, SDL_BLENDMODE_ADD);
+  SDL_SetTextureScaleMode(sprite->texture, SDL_ScaleModeLinear);
+  SDL_FreeSurface(surface);
+
+  sprite->vertices = NULL;
+  sprite->num_vertices = 0;
+  sprite->vertex_capacity = 0;
+  sprite->indices = NULL;
+  sprite->num_indices = 0;
+  sprite->index_capacity = 0;
+  return sprite;
+}
+
+/** Finds the sprite for a glow radius, baking it the first time */
+glow_sprite_t *get_glow_sprite(double radius) {
+  long bucket = lround(radius / GLOW_BUCKET_WIDTH);
+  for (size_t i = 0; i < glow_num_sprites; i++) {
+    if (glow_sprites[i]->bucket == bucket) {
+      return glow_sprites[i];
+    }
+  }
+  glow_sprites = sdl_reserve_scratch(glow_sprites, &glow_sprite_capacity,
+                                     glow_num_sprites + 1,
+                                     sizeof(glow_sprite_t *));
+  glow_sprites[glow_num_sprites] = glow_sprite_init(bucket);
+  return glow_sprites[glow_num_sprites++];
+}
+
+/** Draws the glows queued since the last flush, one draw call per sprite */
+void sdl_flush_glows(void) {
+  for (size_t i = 0; i < glow_num_sprites; i++) {
+    glow_sprite_t *sprite = glow_sprites[i];
+    if (sprite->num_indices == 0) {
+      continue;
+    }
+    SDL_RenderGeometry(renderer, sprite->texture, sprite->vertices,
+                       sprite->num_vertices, sprite->indices,
+                       sprite->num_indices);
+    sprite->num_vertices = 0;
+    sprite->num_indices = 0;
+  }
+}
+
+void render_glows(const SDL_FPoint *centers, const color_t *colors, size_t n,
+                  double radius) {
+  // glows go on top of whatever was drawn before them
+  sdl_flush_geometry();
+
+  glow_sprite_t *sprite = get_glow_sprite(radius);
+  float pixel_extent = get_scene_scale() * glow_extent(radius);
+  sprite->vertices =
+      sdl_reserve_scratch(sprite->vertices, &sprite->vertex_capacity,
+                          sprite->num_vertices + 4 * n, sizeof(SDL_Vertex));
+  sprite->indices =
+      sdl_reserve_scratch(sprite->indices, &sprite->index_capacity,
+                          sprite->num_indices + 6 * n, sizeof(int));
+
+  for (size_t i = 0; i < n; i++) {
+    SDL_FPoint pixel = centers[i];
+    SDL_Color color = {colors[i].r * 255, colors[i].g * 255,
+                       colors[i].b * 255, colors[i].a * 255};
+    float x0 = pixel.x - pixel_extent, x1 = pixel.x + pixel_extent,
+          y0 = pixel.y - pixel_extent, y1 = pixel.y + pixel_extent;
+
+    SDL_Vertex *quad = sprite->vertices + sprite->num_vertices;
+    quad[0] = (SDL_Vertex){{x0, y0}, color, {0, 0}};
+    quad[1] = (SDL_Vertex){{x1, y0}, color, {1, 0}};
+    quad[2] = (SDL_Vertex){{x1, y1}, color, {1, 1}};
+    quad[3] = (SDL_Vertex){{x0, y1}, color, {0, 1}};
+    int *indices = sprite->indices + sprite->num_indices;
+    int first = sprite->num_vertices;
+    indices[0] = first;
+    indices[1] = first + 1;
+    indices[2] = first + 2;
+    indices[3] = first;
+    indices[4] = first + 2;
+    indices[5] = first + 3;
+    sprite->num_vertices += 4;
+    sprite->num_indices += 6;
+  }
+}
+
+/**
+ * Returns whether a polygon is convex, i.e. every corner turns the same way.
+ * Only convex polygons can be drawn as a triangle fan.
+ */
+bool sdl_is_convex(const SDL_FPoint *vertices, size_t n) {
+  bool left = false, right = false;
   for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = list_get(points, i);
-    vector_t pixel = get_window_position(*vertex, window_center);
-    x_points[i] = pixel.x;
-    y_points[i] = pixel.y;
+    SDL_FPoint a = vertices[i], b = vertices[(i + 1) % n],
+               c = vertices[(i + 2) % n];
+    double turn = ((double)b.x - a.x) * ((double)c.y - b.y) -
+                  ((double)b.y - a.y) * ((double)c.x - b.x);
+    left = left || turn > 0;
+    right = right || turn < 0;
+  }
+  return !(left && right);
+}
+
+void render_polygon(const SDL_FPoint *vertices, size_t n, color_t color) {
+  sdl_flush_glows();
+
+  if (!sdl_is_convex(vertices, n)) {
+    // Concave polygons are rare, so let SDL2_gfx fill them
+    sdl_flush_geometry();
+    gfx_points = sdl_reserve_scratch(gfx_points, &gfx_point_capacity, 2 * n,
+                                     sizeof(int16_t));
+    int16_t *x_points = gfx_points, *y_points = gfx_points + n;
+    for (size_t i = 0; i < n; i++) {
+      x_points[i] = round(vertices[i].x);
+      y_points[i] = round(vertices[i].y);
+    }
+    filledPolygonRGBA(renderer, x_points, y_points, n, color.r * 255,
+                      color.g * 255, color.b * 255, color.a * 255);
+    return;
   }
 
-  // Draw polygon with the given color
-  filledPolygonRGBA(renderer, x_points, y_points, n, color.r * 255,
-                    color.g * 255, color.b * 255, color.a * 255);
-  free(x_points);
-  free(y_points);
+  // Queue the polygon as a triangle fan around its first vertex
+  int first = sdl_reserve_geometry(n, (n - 2) * 3);
+  SDL_Color vertex_color = {color.r * 255, color.g * 255, color.b * 255,
+                            color.a * 255};
+  sdl_fill_vertices(vertices, n, batch_vertices + first, vertex_color);
+  batch_num_vertices += n;
+  sdl_add_fan(first, n);
 }
 
-void sdl_show(void) {
+void render_regular_polygons(const SDL_FPoint *centers, const color_t *colors,
+                             size_t n, size_t sides, double radius) {
+  sdl_flush_glows();
+
+  double pixel_radius = get_scene_scale() * radius;
+
+  sdl_reserve_geometry(n * sides, n * (sides - 2) * 3);
+
+  // every polygon has the same corners around its center, in pixels
+  unit_corners = sdl_reserve_scratch(unit_corners, &unit_corner_capacity,
+                                     sides, sizeof(SDL_FPoint));
+  for (size_t k = 0; k < sides; k++) {
+    double angle = 2 * M_PI * k / sides;
+    // flip y axis since positive y is down on the screen
+    unit_corners[k] = (SDL_FPoint){cos(angle) * pixel_radius,
+                                   -sin(angle) * pixel_radius};
+  }
+
+  // each polygon is a triangle fan around its first vertex
+  for (size_t i = 0; i < n; i++) {
+    SDL_FPoint pixel = centers[i];
+    SDL_Color color = {colors[i].r * 255, colors[i].g * 255,
+                       colors[i].b * 255, colors[i].a * 255};
+    int first = batch_num_vertices;
+    SDL_Vertex *polygon = batch_vertices + first;
+    for (size_t k = 0; k < sides; k++) {
+      polygon[k] = (SDL_Vertex){{pixel.x + unit_corners[k].x,
+                                 pixel.y + unit_corners[k].y},
+                                color,
+                                {0, 0}};
+    }
+    batch_num_vertices += sides;
+    sdl_add_fan(first, sides);
+  }
+}
+
+/** Renders every printable glyph of the font into one texture */
+glyph_atlas_t *glyph_atlas_init(int point_size) {
+  TTF_Font *font = TTF_OpenFont(TEXT_FONT_PATH, point_size);
+  assert(font != NULL);
+  SDL_Color white = {255, 255, 255, 255};
+  SDL_Surface *glyphs[TEXT_NUM_GLYPHS];
+  int cell_width = 0, cell_height = TTF_FontHeight(font);
+  for (size_t i = 0; i < TEXT_NUM_GLYPHS; i++) {
+    glyphs[i] = TTF_RenderGlyph_Blended(font, TEXT_FIRST_GLYPH + i, white);
+    assert(glyphs[i] != NULL);
+    cell_width = glyphs[i]->w > cell_width ? glyphs[i]->w : cell_width;
+    cell_height = glyphs[i]->h > cell_height ? glyphs[i]->h : cell_height;
+  }
+  TTF_CloseFont(font);
+  metrics_add(METRIC_GLYPHS_RASTERIZED, TEXT_NUM_GLYPHS);
+
+  int rows = (TEXT_NUM_GLYPHS + TEXT_ATLAS_COLUMNS - 1) / TEXT_ATLAS_COLUMNS;
+  SDL_Surface *sheet = SDL_CreateRGBSurfaceWithFormat(
+      0, cell_width * TEXT_ATLAS_COLUMNS, cell_height * rows, 32,
+      SDL_PIXELFORMAT_ARGB8888);
+  assert(sheet != NULL);
+  SDL_FillRect(sheet, NULL, SDL_MapRGBA(sheet->format, 255, 255, 255, 0));
+
+  glyph_atlas_t *atlas = malloc(sizeof(glyph_atlas_t));
+  assert(atlas != NULL);
+  for (size_t i = 0; i < TEXT_NUM_GLYPHS; i++) {
+    SDL_Rect cell = {.x = (i % TEXT_ATLAS_COLUMNS) * cell_width,
+                     .y = (i / TEXT_ATLAS_COLUMNS) * cell_height,
+                     .w = glyphs[i]->w,
+                     .h = glyphs[i]->h};
+    // copy the glyph's alpha instead of blending it onto the sheet
+    SDL_SetSurfaceBlendMode(glyphs[i], SDL_BLENDMODE_NONE);
+    SDL_BlitSurface(glyphs[i], NULL, sheet, &cell);
+    atlas->glyphs[i] = cell;
+    SDL_FreeSurface(glyphs[i]);
+  }
+  atlas->texture = SDL_CreateTextureFromSurface(renderer, sheet);
+  assert(atlas->texture != NULL);
+  SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+  SDL_FreeSurface(sheet);
+
+  atlas->vertices = NULL;
+  atlas->num_vertices = 0;
+  atlas->vertex_capacity = 0;
+  atlas->indices = NULL;
+  atlas->num_indices = 0;
+  atlas->index_capacity = 0;
+  return atlas;
+}
+
+/** Picks the smallest atlas whose glyphs are at least the given height */
+glyph_atlas_t *get_glyph_atlas(double pixel_height) {
+  size_t i = 0;
+  while (i + 1 < TEXT_NUM_ATLASES && (TEXT_MIN_POINT_SIZE << i) < pixel_height) {
+    i++;
+  }
+  if (glyph_atlases[i] == NULL) {
+    glyph_atlases[i] = glyph_atlas_init(TEXT_MIN_POINT_SIZE << i);
+  }
+  return glyph_atlases[i];
+}
+
+void render_text(const char *text, size_t length, SDL_FPoint pixel,
+                 double height, double char_width, color_t color) {
+  double scale = get_scene_scale();
+  double pixel_height = scale * height, pixel_width = scale * char_width;
+  glyph_atlas_t *atlas = get_glyph_atlas(pixel_height);
+
+  atlas->vertices =
+      sdl_reserve_scratch(atlas->vertices, &atlas->vertex_capacity,
+                          atlas->num_vertices + 4 * length, sizeof(SDL_Vertex));
+  atlas->indices =
+      sdl_reserve_scratch(atlas->indices, &atlas->index_capacity,
+                          atlas->num_indices + 6 * length, sizeof(int));
+
+  int texture_width, texture_height;
+  SDL_QueryTexture(atlas->texture, NULL, NULL, &texture_width, &texture_height);
+  SDL_Color vertex_color = {color.r * 255, color.g * 255, color.b * 255,
+                            color.a * 255};
+  float left = pixel.x - 0.5 * pixel_width * length,
+        top = pixel.y - 0.5 * pixel_height;
+  for (size_t i = 0; i < length; i++) {
+    char c = text[i];
+    if (c < TEXT_FIRST_GLYPH || c > TEXT_LAST_GLYPH) {
+      c = ' ';
+    }
+    SDL_Rect glyph = atlas->glyphs[c - TEXT_FIRST_GLYPH];
+    float u0 = (float)glyph.x / texture_width,
+          u1 = (float)(glyph.x + glyph.w) / texture_width,
+          v0 = (float)glyph.y / texture_height,
+          v1 = (float)(glyph.y + glyph.h) / texture_height;
+    float x0 = left + i * pixel_width, x1 = x0 + pixel_width;
+    float y0 = top, y1 = top + pixel_height;
+
+    SDL_Vertex *quad = atlas->vertices + atlas->num_vertices;
+    quad[0] = (SDL_Vertex){{x0, y0}, vertex_color, {u0, v0}};
+    quad[1] = (SDL_Vertex){{x1, y0}, vertex_color, {u1, v0}};
+    quad[2] = (SDL_Vertex){{x1, y1}, vertex_color, {u1, v1}};
+    quad[3] = (SDL_Vertex){{x0, y1}, vertex_color, {u0, v1}};
+    int *indices = atlas->indices + atlas->num_indices;
+    int first = atlas->num_vertices;
+    indices[0] = first;
+    indices[1] = first + 1;
+    indices[2] = first + 2;
+    indices[3] = first;
+    indices[4] = first + 2;
+    indices[5] = first + 3;
+    atlas->num_vertices += 4;
+    atlas->num_indices += 6;
+  }
+}
+
+/** Draws the text queued this frame, one draw call per atlas */
+void sdl_flush_text(void) {
+  for (size_t i = 0; i < TEXT_NUM_ATLASES; i++) {
+    glyph_atlas_t *atlas = glyph_atlases[i];
+    if (atlas == NULL || atlas->num_indices == 0) {
+      continue;
+    }
+    SDL_RenderGeometry(renderer, atlas->texture, atlas->vertices,
+                       atlas->num_vertices, atlas->indices, atlas->num_indices);
+    atlas->num_vertices = 0;
+    atlas->num_indices = 0;
+  }
+}
+
+void render_image(image_id_t image) {
+  sdl_flush_geometry();
+  sdl_flush_glows();
+  SDL_Texture *texture = get_image_texture(image);
+  if (texture != NULL) {
+    SDL_RenderCopy(renderer, texture, NULL, NULL);
+  }
+}
+
+/** Draws the boundary and the queued text, and presents the frame */
+void render_present(void) {
+  sdl_flush_geometry();
+  sdl_flush_glows();
+
   // Draw boundary lines
-  vector_t window_center = get_window_center();
   vector_t max = vec_add(center, max_diff),
            min = vec_subtract(center, max_diff);
-  vector_t max_pixel = get_window_position(max, window_center),
-           min_pixel = get_window_position(min, window_center);
-  SDL_Rect *boundary = malloc(sizeof(*boundary));
-  boundary->x = min_pixel.x;
-  boundary->y = max_pixel.y;
-  boundary->w = max_pixel.x - min_pixel.x;
-  boundary->h = min_pixel.y - max_pixel.y;
+  vector_t max_pixel = get_window_position(max),
+           min_pixel = get_window_position(min);
+  SDL_Rect boundary = {.x = round(min_pixel.x),
+                       .y = round(max_pixel.y),
+                       .w = round(max_pixel.x - min_pixel.x),
+                       .h = round(min_pixel.y - max_pixel.y)};
   SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-  SDL_RenderDrawRect(renderer, boundary);
-  free(boundary);
+  SDL_RenderDrawRect(renderer, &boundary);
 
+  // text goes on top of everything else
+  sdl_flush_text();
   SDL_RenderPresent(renderer);
 }
 
-void sdl_render_scene(scene_t *scene) {
-  size_t body_count = scene_bodies(scene);
-  for (size_t i = 0; i < body_count; i++) {
-    body_t *body = scene_get_body(scene, i);
-    list_t *shape = body_get_shape(body);
-    sdl_draw_polygon(shape, body_get_color(body));
-    list_free(shape);
-  }
-  sdl_show();
-}
-
 void sdl_on_key(key_handler_t handler) { key_handler = handler; }
 
 double time_since_last_tick(void) {
@@ -265,69 +968,261 @@ double time_since_last_tick(void) {
   return difference;
 }
 
-void sdl_move_text(list_t *l, vector_t pos, double height, double width) {
-  SDL_Rect *message_rectangle = (SDL_Rect *) list_get(l, 1);
-  message_rectangle->x = pos.x - width / 2;
-  message_rectangle->y = WINDOW_HEIGHT - pos.y - height / 2;
-  message_rectangle->w = width;
-  message_rectangle->h = height;
+void sdl_play_sound(int channel, sound_id_t sound, int loops) {
+  assert(sound < NUM_SOUNDS);
+  if (sound_chunks[sound] == NULL) {
+    return;
+  }
+  sound_command_t command = {.sound = sound, .channel = channel, .loops = loops};
+  if (sound_bank_push(sound_bank, command, SDL_GetTicks() / MS_PER_S) &&
+      audio_thread != NULL) {
+    SDL_SemPost(audio_wake);
+  }
+}
+
+/** Draws a snapshot, front to back, and presents it */
+void sdl_replay(snapshot_t *snapshot) {
+  if (snapshot->window_width != viewport_width ||
+      snapshot->window_height != viewport_height) {
+    sdl_update_viewport(snapshot->window_width, snapshot->window_height);
+  }
+  // map every point of the frame to the window in one pass
+  pixel_points = sdl_reserve_scratch(pixel_points, &pixel_point_capacity,
+                                     snapshot->num_points, sizeof(SDL_FPoint));
+  sdl_transform_points(snapshot->points, snapshot->num_points, pixel_points);
+
+  render_clear();
+  for (size_t i = 0; i < snapshot->num_commands; i++) {
+    draw_command_t *command = &snapshot->commands[i];
+    const SDL_FPoint *points = pixel_points + command->first_point;
+    const color_t *colors = snapshot->colors + command->first_color;
+    switch (command->kind) {
+    case DRAW_POLYGON:
+      render_polygon(points, command->count, command->color);
+      break;
+    case DRAW_REGULAR_POLYGONS:
+      render_regular_polygons(points, colors, command->count, command->sides,
+                              command->radius);
+      break;
+    case DRAW_GLOWS:
+      render_glows(points, colors, command->count, command->radius);
+      break;
+    case DRAW_TEXT:
+      metrics_add(METRIC_TEXTS_DRAWN, 1);
+      render_text(snapshot->chars + command->first_char, command->count,
+                  points[0], command->height, command->width, command->color);
+      break;
+    case DRAW_IMAGE:
+      render_image(command->image);
+      break;
+    }
+  }
+  render_present();
 }
 
-list_t *sdl_prepare_text(char* text, vector_t center, double height, double width, color_t color) {
-  // texture prep
-  SDL_Color text_color = {color.r*255, color.g*255, color.b*255, color.a*255};
-  SDL_Surface* message_surface = TTF_RenderText_Solid(font, text, text_color);
-  SDL_Texture* message_texture = SDL_CreateTextureFromSurface(renderer, message_surface);
+/**
+ * Takes the most recently published snapshot for drawing.
+ * Returns NULL if it has already been drawn.
+ */
+snapshot_t *sdl_take_snapshot(void) {
+  if (!(atomic_load(&snapshot_middle) & SNAPSHOT_FRESH)) {
+    return NULL;
+  }
+  snapshot_front = atomic_exchange(&snapshot_middle, snapshot_front) &
+                   ~SNAPSHOT_FRESH;
+  return &snapshots[snapshot_front];
+}
 
-  // rectangle prep (placement)
-  SDL_Rect *message_rectangle = malloc(sizeof(SDL_FRect));
-  message_rectangle->x = center.x - width / 2;
-  message_rectangle->y = WINDOW_HEIGHT - center.y - height / 2;
-  message_rectangle->w = width;
-  message_rectangle->h = height;
+int sdl_render_thread(void *aux) {
+  while (SDL_SemWait(render_wake) == 0 &&
+         !atomic_load(&sdl_threads_stopping)) {
+    snapshot_t *snapshot = sdl_take_snapshot();
+    if (snapshot != NULL) {
+      sdl_replay(snapshot);
+    }
+  }
+  // hand the GL context back so sdl_quit() can destroy the renderer
+  SDL_GL_MakeCurrent(window, NULL);
+  return 0;
+}
 
-  list_t *l = list_init(2, NULL);
-  list_add(l, message_texture);
-  list_add(l, message_rectangle);
-  list_add(l, message_surface);
-  return l;
+/** Starts recording a new frame, discarding anything recorded so far */
+void snapshot_clear(snapshot_t *snapshot) {
+  snapshot->num_commands = 0;
+  snapshot->num_points = 0;
+  snapshot->num_colors = 0;
+  snapshot->num_chars = 0;
 }
 
-void sdl_render_text(list_t *l) {
-  SDL_Texture *message_texture = list_get(l, 0);
-  SDL_Rect *message_rectangle = list_get(l, 1);
-  SDL_RenderCopy(renderer, message_texture, NULL, message_rectangle);
-  sdl_show();
+/** Appends a draw command of the given kind to the back snapshot */
+draw_command_t *snapshot_add_command(draw_kind_t kind) {
+  snapshot_t *snapshot = &snapshots[snapshot_back];
+  snapshot->commands = sdl_reserve_scratch(
+      snapshot->commands, &snapshot->command_capacity,
+      snapshot->num_commands + 1, sizeof(draw_command_t));
+  draw_command_t *command = &snapshot->commands[snapshot->num_commands++];
+  *command = (draw_command_t){.kind = kind,
+                              .first_point = snapshot->num_points,
+                              .first_color = snapshot->num_colors,
+                              .first_char = snapshot->num_chars};
+  return command;
 }
 
-void sdl_free_text(list_t *l) {
-  SDL_Texture *message_texture = (SDL_Texture *) list_get(l, 0);
-  SDL_Rect *message_rectangle = (SDL_Rect *) list_get(l, 1);
-  SDL_Surface *message_surface = (SDL_Surface *) list_get(l, 2);
-  SDL_FreeSurface(message_surface);
-  SDL_DestroyTexture(message_texture);
-  free(message_rectangle);
+/** Copies points into the back snapshot */
+void snapshot_add_points(const vector_t *points, size_t n) {
+  snapshot_t *snapshot = &snapshots[snapshot_back];
+  snapshot->points =
+      sdl_reserve_scratch(snapshot->points, &snapshot->point_capacity,
+                          snapshot->num_points + n, sizeof(vector_t));
+  memcpy(snapshot->points + snapshot->num_points, points, sizeof(vector_t) * n);
+  snapshot->num_points += n;
 }
 
-// disabled for compatibility
-void sdl_play_music(char *path) {
-//   Mix_Music *sound = Mix_LoadMUS(path);
-//   Mix_PlayMusic(sound, 0);
+/** Copies colors into the back snapshot */
+void snapshot_add_colors(const color_t *colors, size_t n) {
+  snapshot_t *snapshot = &snapshots[snapshot_back];
+  snapshot->colors =
+      sdl_reserve_scratch(snapshot->colors, &snapshot->color_capacity,
+                          snapshot->num_colors + n, sizeof(color_t));
+  memcpy(snapshot->colors + snapshot->num_colors, colors, sizeof(color_t) * n);
+  snapshot->num_colors += n;
 }
-// disabled for compatibility
-void sdl_play_sound(int channel, char *path, int loops) {
-//   Mix_Chunk *chunk = Mix_LoadWAV(path);
-//   Mix_PlayChannel(channel, chunk, loops);
+
+/** Copies characters into the back snapshot */
+void snapshot_add_chars(const char *chars, size_t n) {
+  snapshot_t *snapshot = &snapshots[snapshot_back];
+  snapshot->chars =
+      sdl_reserve_scratch(snapshot->chars, &snapshot->char_capacity,
+                          snapshot->num_chars + n, sizeof(char));
+  memcpy(snapshot->chars + snapshot->num_chars, chars, n);
+  snapshot->num_chars += n;
 }
 
-void sdl_render_image() {
-  SDL_Surface * image = SDL_LoadBMP("assets/background.bmp");
-  SDL_Texture * texture = SDL_CreateTextureFromSurface(renderer, image);
+void sdl_clear(void) { snapshot_clear(&snapshots[snapshot_back]); }
 
-  SDL_RenderCopy(renderer, texture, NULL, NULL);
+void sdl_draw_polygon(vec_array_t *points, color_t color) {
+  // Check parameters
+  size_t n = vec_array_size(points);
+  assert(n >= 3);
+  assert(0 <= color.r && color.r <= 1);
+  assert(0 <= color.g && color.g <= 1);
+  assert(0 <= color.b && color.b <= 1);
+  assert(0 <= color.a && color.a <= 1);
 
-  SDL_RenderPresent(renderer);
-  sdl_show();
-  SDL_DestroyTexture(texture);
-  SDL_FreeSurface(image);
+  draw_command_t *command = snapshot_add_command(DRAW_POLYGON);
+  command->count = n;
+  command->color = color;
+  snapshot_add_points(vec_array_data(points), n);
+}
+
+void sdl_draw_regular_polygons(const vector_t *centers, const color_t *colors,
+                               size_t n, size_t sides, double radius) {
+  assert(sides >= 3);
+  if (n == 0) {
+    return;
+  }
+  draw_command_t *command = snapshot_add_command(DRAW_REGULAR_POLYGONS);
+  command->count = n;
+  command->sides = sides;
+  command->radius = radius;
+  snapshot_add_points(centers, n);
+  snapshot_add_colors(colors, n);
+}
+
+void sdl_draw_glows(const vector_t *centers, const color_t *colors, size_t n,
+                    double radius) {
+  assert(radius > 0);
+  if (n == 0) {
+    return;
+  }
+  draw_command_t *command = snapshot_add_command(DRAW_GLOWS);
+  command->count = n;
+  command->radius = radius;
+  snapshot_add_points(centers, n);
+  snapshot_add_colors(colors, n);
+}
+
+void sdl_draw_text(const char *text, vector_t center, double height,
+                   double char_width, color_t color) {
+  size_t length = strlen(text);
+  if (length == 0) {
+    return;
+  }
+  draw_command_t *command = snapshot_add_command(DRAW_TEXT);
+  command->count = length;
+  command->height = height;
+  command->width = char_width;
+  command->color = color;
+  snapshot_add_points(&center, 1);
+  snapshot_add_chars(text, length);
+}
+
+void sdl_render_image(image_id_t image) {
+  assert(image < NUM_IMAGES);
+  draw_command_t *command = snapshot_add_command(DRAW_IMAGE);
+  command->image = image;
+}
+
+void sdl_render_scene(scene_t *scene) {
+  size_t body_count = scene_bodies(scene);
+  for (size_t i = 0; i < body_count; i++) {
+    body_t *body = scene_get_body(scene, i);
+    sdl_draw_polygon(body_get_frame_shape(body), body_get_color(body));
+  }
+}
+
+void sdl_set_frame_rate(double frame_rate) {
+  assert(frame_rate > 0);
+  frame_period = 1 / frame_rate;
+}
+
+/** Only takes effect before sdl_init(), which decides whether to start one */
+void sdl_set_render_thread(bool enabled) {
+  assert(window == NULL);
+  render_thread_enabled = enabled;
+}
+
+/** Sleeps until it is time for the next frame */
+void sdl_wait_for_frame(void) {
+  Uint64 now = SDL_GetPerformanceCounter(),
+         frequency = SDL_GetPerformanceFrequency(),
+         period = frame_period * frequency;
+  if (now < next_frame) {
+    SDL_Delay((next_frame - now) * MS_PER_S / frequency);
+    next_frame += period;
+  } else {
+    // running behind: start counting again from now instead of catching up
+    next_frame = now + period;
+  }
+}
+
+void sdl_show(void) {
+  // the render thread's drawing and the wait for the next frame
+  // are not part of the frame's time
+  profiler_begin(tick_profiler(), PROFILE_PRESENT);
+  // publish the frame and start recording the next one
+  snapshots[snapshot_back].window_width = window_width;
+  snapshots[snapshot_back].window_height = window_height;
+  snapshot_back = atomic_exchange(&snapshot_middle,
+                                  snapshot_back | SNAPSHOT_FRESH) &
+                  ~SNAPSHOT_FRESH;
+  snapshot_clear(&snapshots[snapshot_back]);
+  if (render_thread != NULL) {
+    SDL_SemPost(render_wake);
+  } else {
+    sdl_replay(sdl_take_snapshot());
+  }
+
+  if (audio_thread == NULL) {
+    sdl_start_sounds();
+  }
+  // nothing drawn this frame is needed any more
+  frame_arena_reset();
+  profiler_end(tick_profiler(), PROFILE_PRESENT);
+  profiler_end_frame(tick_profiler());
+  trace_end_frame(tick_tracer());
+  metrics_end_tick();
+#ifndef __EMSCRIPTEN__
+  sdl_wait_for_frame();
+#endif
 }
@@ -0,0 +1,708 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "server.h"
+#include "list.h"
+#include "scene.h"
+#include "sdl_null.h"
+#include "state.h"
+#include <arpa/inet.h>
+#include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// the keys the game binds its players to, by slot and button
+const char SERVER_PLAYER_KEYS[SERVER_MAX_PLAYERS][SERVER_BUTTON_START] = {
+    {'q', 'e', 'w', 'r'},
+    {'u', 'o', 'i', 'p'},
+    {'z', 'c', 'x', 'v'},
+    {'b', 'm', 'n', ','},
+};
+const char SERVER_START_KEY = '\r';
+
+// packets received or sent per system call
+#define SERVER_BATCH 64
+// batches received per wake-up, so a flood cannot starve the timer
+const size_t SERVER_MAX_BATCHES_PER_WAKE = 8;
+// magic and kind
+const size_t SERVER_HEADER_SIZE = 3;
+const size_t SERVER_INPUT_SIZE = 3 + 4 + 1 + 1 + 4 + 4;
+const size_t SERVER_WELCOME_SIZE = 3 + 1 + 2;
+const size_t SERVER_SNAPSHOT_HEADER_SIZE = 3 + 4 + 2 + 2 + 2;
+const size_t SERVER_SNAPSHOT_BODY_SIZE = 4 + 4 + 4;
+// how much the kernel may buffer for the socket in each direction
+const int SERVER_SOCKET_BUFFER = 1 << 21;
+
+typedef struct {
+  server_button_t button;
+  bool pressed;
+  vector_t mouse;
+} server_input_t;
+
+typedef struct {
+  struct sockaddr_in address;
+  uint8_t slot;
+  // the tick the client was last heard from on
+  size_t last_heard;
+  uint32_t last_seq;
+
+  // ring buffer of inputs waiting for a tick
+  server_input_t inputs[SERVER_INPUT_QUEUE];
+  size_t next_input;
+  size_t num_inputs;
+
+  // the player's buttons that are held down, to let go of when it leaves
+  bool held[SERVER_BUTTON_START];
+} server_client_t;
+
+typedef struct server {
+  list_t *clients;
+  uint32_t ip;
+  uint16_t port;
+  int socket_id;
+  int epoll_id;
+  int timer_id;
+  int wake_id;
+  state_t *state;
+  bool players_taken[SERVER_MAX_PLAYERS];
+  server_stats_t stats;
+
+  // received packets
+  uint8_t (*recv_packets)[SERVER_MAX_PACKET];
+  struct mmsghdr *recvs;
+  struct iovec *recv_iovs;
+  struct sockaddr_in *recv_addresses;
+
+  // the chunks of the snapshot being sent, and a message for each chunk
+  // going to each client
+  uint8_t (*chunks)[SERVER_MAX_PACKET];
+  size_t *chunk_sizes;
+  size_t num_chunks;
+  size_t chunks_capacity;
+  struct mmsghdr *sends;
+  struct iovec *send_iovs;
+  size_t sends_capacity;
+} server_t;
+
+void server_put_u8(uint8_t **packet, uint8_t value) { *(*packet)++ = value; }
+
+void server_put_u16(uint8_t **packet, uint16_t value) {
+  value = htons(value);
+  memcpy(*packet, &value, sizeof(value));
+  *packet += sizeof(value);
+}
+
+void server_put_u32(uint8_t **packet, uint32_t value) {
+  value = htonl(value);
+  memcpy(*packet, &value, sizeof(value));
+  *packet += sizeof(value);
+}
+
+void server_put_f32(uint8_t **packet, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  server_put_u32(packet, bits);
+}
+
+uint8_t server_get_u8(const uint8_t **packet) { return *(*packet)++; }
+
+uint16_t server_get_u16(const uint8_t **packet) {
+  uint16_t value;
+  memcpy(&value, *packet, sizeof(value));
+  *packet += sizeof(value);
+  return ntohs(value);
+}
+
+uint32_t server_get_u32(const uint8_t **packet) {
+  uint32_t value;
+  memcpy(&value, *packet, sizeof(value));
+  *packet += sizeof(value);
+  return ntohl(value);
+}
+
+float server_get_f32(const uint8_t **packet) {
+  uint32_t bits = server_get_u32(packet);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/** Converts a color component between 0 and 1 to a byte */
+uint8_t server_color_byte(float component) {
+  if (!(component > 0)) {
+    return 0;
+  }
+  return component >= 1 ? UINT8_MAX : (uint8_t)lroundf(component * UINT8_MAX);
+}
+
+size_t server_message_write(const server_message_t *message, uint8_t *packet) {
+  uint8_t *end = packet;
+  server_put_u16(&end, SERVER_PROTOCOL_MAGIC);
+  server_put_u8(&end, message->type);
+  switch (message->type) {
+  case SERVER_MSG_HELLO:
+  case SERVER_MSG_BYE:
+    break;
+  case SERVER_MSG_INPUT:
+    assert(message->button < SERVER_NUM_BUTTONS);
+    server_put_u32(&end, message->seq);
+    server_put_u8(&end, message->button);
+    server_put_u8(&end, message->pressed);
+    server_put_f32(&end, message->mouse.x);
+    server_put_f32(&end, message->mouse.y);
+    break;
+  case SERVER_MSG_WELCOME:
+    server_put_u8(&end, message->slot);
+    server_put_u16(&end, message->tick_rate);
+    break;
+  default:
+    // snapshots are only written by the server, a chunk at a time
+    assert(false);
+  }
+  return end - packet;
+}
+
+bool server_message_read(server_message_t *message, const uint8_t *packet,
+                         size_t size) {
+  if (size < SERVER_HEADER_SIZE) {
+    return false;
+  }
+  const uint8_t *next = packet;
+  if (server_get_u16(&next) != SERVER_PROTOCOL_MAGIC) {
+    return false;
+  }
+  message->type = server_get_u8(&next);
+  switch (message->type) {
+  case SERVER_MSG_HELLO:
+  case SERVER_MSG_BYE:
+    return size == SERVER_HEADER_SIZE;
+  case SERVER_MSG_INPUT:
+    if (size != SERVER_INPUT_SIZE) {
+      return false;
+    }
+    message->seq = server_get_u32(&next);
+    message->button = server_get_u8(&next);
+    message->pressed = server_get_u8(&next) != 0;
+    message->mouse.x = server_get_f32(&next);
+    message->mouse.y = server_get_f32(&next);
+    return message->button < SERVER_NUM_BUTTONS &&
+           isfinite(message->mouse.x) && isfinite(message->mouse.y);
+  case SERVER_MSG_WELCOME:
+    if (size != SERVER_WELCOME_SIZE) {
+      return false;
+    }
+    message->slot = server_get_u8(&next);
+    message->tick_rate = server_get_u16(&next);
+    return true;
+  case SERVER_MSG_SNAPSHOT:
+    if (size < SERVER_SNAPSHOT_HEADER_SIZE) {
+      return false;
+    }
+    message->tick = server_get_u32(&next);
+    message->num_bodies = server_get_u16(&next);
+    message->first = server_get_u16(&next);
+    message->count = server_get_u16(&next);
+    message->bodies = next;
+    return size == SERVER_SNAPSHOT_HEADER_SIZE +
+                       message->count * SERVER_SNAPSHOT_BODY_SIZE &&
+           (size_t)message->first + message->count <= message->num_bodies;
+  default:
+    return false;
+  }
+}
+
+server_body_t server_message_body(const server_message_t *message,
+                                  size_t index) {
+  assert(message->type == SERVER_MSG_SNAPSHOT);
+  assert(index < message->count);
+  const uint8_t *next = message->bodies + index * SERVER_SNAPSHOT_BODY_SIZE;
+  server_body_t body;
+  body.centroid.x = server_get_f32(&next);
+  body.centroid.y = server_get_f32(&next);
+  body.color.r = server_get_u8(&next) / (float)UINT8_MAX;
+  body.color.g = server_get_u8(&next) / (float)UINT8_MAX;
+  body.color.b = server_get_u8(&next) / (float)UINT8_MAX;
+  body.color.a = server_get_u8(&next) / (float)UINT8_MAX;
+  return body;
+}
+
+server_t *server_init(uint32_t ip, uint16_t port) {
+  server_t *s = calloc(1, sizeof(server_t));
+  assert(s != NULL);
+  s->clients = list_init(SERVER_MAX_PLAYERS, free);
+  s->ip = ip;
+  s->port = port;
+  s->socket_id = -1;
+  s->epoll_id = -1;
+  s->timer_id = -1;
+  s->wake_id = -1;
+
+  s->recv_packets = malloc(SERVER_BATCH * sizeof(*s->recv_packets));
+  s->recvs = calloc(SERVER_BATCH, sizeof(struct mmsghdr));
+  s->recv_iovs = malloc(SERVER_BATCH * sizeof(struct iovec));
+  s->recv_addresses = malloc(SERVER_BATCH * sizeof(struct sockaddr_in));
+  assert(s->recv_packets != NULL && s->recvs != NULL &&
+         s->recv_iovs != NULL && s->recv_addresses != NULL);
+  for (size_t i = 0; i < SERVER_BATCH; i++) {
+    s->recv_iovs[i] = (struct iovec){.iov_base = s->recv_packets[i],
+                                     .iov_len = SERVER_MAX_PACKET};
+    s->recvs[i].msg_hdr.msg_iov = &s->recv_iovs[i];
+    s->recvs[i].msg_hdr.msg_iovlen = 1;
+    s->recvs[i].msg_hdr.msg_name = &s->recv_addresses[i];
+  }
+  return s;
+}
+
+/** Prints why a call failed and returns false */
+bool server_fail(const char *call) {
+  perror(call);
+  return false;
+}
+
+/** Adds a descriptor to the server's epoll instance */
+bool server_watch(server_t *s, int descriptor) {
+  struct epoll_event event = {.events = EPOLLIN, .data.fd = descriptor};
+  if (epoll_ctl(s->epoll_id, EPOLL_CTL_ADD, descriptor, &event) < 0) {
+    return server_fail("epoll_ctl");
+  }
+  return true;
+}
+
+bool server_bind(server_t *s) {
+  assert(s->socket_id < 0);
+  s->socket_id = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (s->socket_id < 0) {
+    return server_fail("socket");
+  }
+  // a tick's snapshots go out in one burst, so give them room;
+  // the kernel caps these at its own limits
+  setsockopt(s->socket_id, SOL_SOCKET, SO_SNDBUF, &SERVER_SOCKET_BUFFER,
+             sizeof(SERVER_SOCKET_BUFFER));
+  setsockopt(s->socket_id, SOL_SOCKET, SO_RCVBUF, &SERVER_SOCKET_BUFFER,
+             sizeof(SERVER_SOCKET_BUFFER));
+  struct sockaddr_in address = {.sin_family = AF_INET,
+                                .sin_port = htons(s->port),
+                                .sin_addr.s_addr = htonl(s->ip)};
+  if (bind(s->socket_id, (struct sockaddr *)&address, sizeof(address)) < 0) {
+    return server_fail("bind");
+  }
+  socklen_t length = sizeof(address);
+  if (getsockname(s->socket_id, (struct sockaddr *)&address, &length) < 0) {
+    return server_fail("getsockname");
+  }
+  s->port = ntohs(address.sin_port);
+
+  s->timer_id = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (s->timer_id < 0) {
+    return server_fail("timerfd_create");
+  }
+  s->wake_id = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (s->wake_id < 0) {
+    return server_fail("eventfd");
+  }
+  s->epoll_id = epoll_create1(EPOLL_CLOEXEC);
+  if (s->epoll_id < 0) {
+    return server_fail("epoll_create1");
+  }
+  if (!server_watch(s, s->socket_id) || !server_watch(s, s->timer_id) ||
+      !server_watch(s, s->wake_id)) {
+    return false;
+  }
+
+  sdl_null_set_tick(1.0 / SERVER_TICK_RATE);
+  s->state = emscripten_init();
+  return true;
+}
+
+uint16_t server_get_port(server_t *s) {
+  assert(s->socket_id >= 0);
+  return s->port;
+}
+
+/** Sends one packet, counting it as dropped if the socket is full */
+void server_send(server_t *s, const server_client_t *client,
+                 const uint8_t *packet, size_t size) {
+  if (sendto(s->socket_id, packet, size, 0,
+             (const struct sockaddr *)&client->address,
+             sizeof(client->address)) < 0) {
+    s->stats.sends_dropped++;
+  } else {
+    s->stats.packets_sent++;
+  }
+}
+
+server_client_t *server_find_client(server_t *s,
+                                    const struct sockaddr_in *address,
+                                    size_t *index) {
+  size_t num_clients = list_size(s->clients);
+  for (size_t i = 0; i < num_clients; i++) {
+    server_client_t *client = list_get(s->clients, i);
+    if (client->address.sin_addr.s_addr == address->sin_addr.s_addr &&
+        client->address.sin_port == address->sin_port) {
+      *index = i;
+      return client;
+    }
+  }
+  return NULL;
+}
+
+server_client_t *server_add_client(server_t *s,
+                                   const struct sockaddr_in *address) {
+  if (list_size(s->clients) >= SERVER_MAX_CLIENTS) {
+    return NULL;
+  }
+  server_client_t *client = calloc(1, sizeof(server_client_t));
+  assert(client != NULL);
+  client->address = *address;
+  client->slot = SERVER_SPECTATOR;
+  for (uint8_t slot = 0; slot < SERVER_MAX_PLAYERS; slot++) {
+    if (!s->players_taken[slot]) {
+      s->players_taken[slot] = true;
+      client->slot = slot;
+      break;
+    }
+  }
+  list_add(s->clients, client);
+  return client;
+}
+
+/** Removes a client, letting go of its player's buttons */
+void server_remove_client(server_t *s, size_t index) {
+  server_client_t *client = list_swap_remove(s->clients, index);
+  if (client->slot != SERVER_SPECTATOR) {
+    for (size_t i = 0; i < SERVER_BUTTON_START; i++) {
+      if (client->held[i]) {
+        sdl_null_send_key(SERVER_PLAYER_KEYS[client->slot][i], KEY_RELEASED);
+      }
+    }
+    s->players_taken[client->slot] = false;
+  }
+  free(client);
+}
+
+void server_handle_packet(server_t *s, const struct sockaddr_in *address,
+                          const uint8_t *packet, size_t size) {
+  server_message_t message;
+  if (!server_message_read(&message, packet, size)) {
+    s->stats.packets_rejected++;
+    return;
+  }
+  size_t index;
+  server_client_t *client = server_find_client(s, address, &index);
+  switch (message.type) {
+  case SERVER_MSG_HELLO: {
+    if (client == NULL) {
+      client = server_add_client(s, address);
+      if (client == NULL) {
+        s->stats.packets_rejected++;
+        return;
+      }
+    }
+    client->last_heard = s->stats.ticks;
+    uint8_t welcome[SERVER_MAX_PACKET];
+    size_t welcome_size = server_message_write(
+        &(server_message_t){.type = SERVER_MSG_WELCOME,
+                            .slot = client->slot,
+                            .tick_rate = SERVER_TICK_RATE},
+        welcome);
+    server_send(s, client, welcome, welcome_size);
+    break;
+  }
+  case SERVER_MSG_INPUT:
+    if (client == NULL) {
+      s->stats.packets_rejected++;
+      return;
+    }
+    client->last_heard = s->stats.ticks;
+    if (client->slot == SERVER_SPECTATOR || message.seq <= client->last_seq) {
+      return;
+    }
+    client->last_seq = message.seq;
+    if (client->num_inputs == SERVER_INPUT_QUEUE) {
+      s->stats.inputs_dropped++;
+      return;
+    }
+    client->inputs[(client->next_input + client->num_inputs++) %
+                   SERVER_INPUT_QUEUE] =
+        (server_input_t){.button = message.button,
+                         .pressed = message.pressed,
+                         .mouse = message.mouse};
+    break;
+  case SERVER_MSG_BYE:
+    if (client != NULL) {
+      server_remove_client(s, index);
+    }
+    break;
+  default:
+    s->stats.packets_rejected++;
+  }
+}
+
+/**
+ * Handles the packets waiting on the socket, up to
+ * SERVER_MAX_BATCHES_PER_WAKE batches of them. The socket is polled
+ * level-triggered, so any left over wake the loop again once the
+ * other descriptors have had their turn.
+ */
+void server_receive(server_t *s) {
+  for (size_t batch = 0; batch < SERVER_MAX_BATCHES_PER_WAKE; batch++) {
+    for (size_t i = 0; i < SERVER_BATCH; i++) {
+      s->recvs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+    }
+    int received = recvmmsg(s->socket_id, s->recvs, SERVER_BATCH, 0, NULL);
+    if (received < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        perror("recvmmsg");
+      }
+      return;
+    }
+    for (int i = 0; i < received; i++) {
+      s->stats.packets_received++;
+      if (s->recvs[i].msg_hdr.msg_namelen != sizeof(struct sockaddr_in) ||
+          (s->recvs[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+        s->stats.packets_rejected++;
+        continue;
+      }
+      server_handle_packet(s, &s->recv_addresses[i], s->recv_packets[i],
+                           s->recvs[i].msg_len);
+    }
+    if (received < SERVER_BATCH) {
+      return;
+    }
+  }
+}
+
+/** Applies a client's queued inputs to the game */
+void server_apply_inputs(server_client_t *client) {
+  for (size_t i = 0; i < SERVER_INPUTS_PER_TICK && client->num_inputs > 0;
+       i++) {
+    server_input_t input = client->inputs[client->next_input];
+    client->next_input = (client->next_input + 1) % SERVER_INPUT_QUEUE;
+    client->num_inputs--;
+    key_event_type_t type = input.pressed ? KEY_PRESSED : KEY_RELEASED;
+    if (input.button == SERVER_BUTTON_MOUSE) {
+      sdl_null_set_mouse(input.mouse);
+      // the game only looks at the mouse once a tick,
+      // so a later move would hide this one
+      break;
+    } else if (input.button == SERVER_BUTTON_START) {
+      sdl_null_send_key(SERVER_START_KEY, type);
+    } else {
+      client->held[input.button] = input.pressed;
+      sdl_null_send_key(SERVER_PLAYER_KEYS[client->slot][input.button], type);
+    }
+  }
+}
+
+void server_tick(server_t *s) {
+  size_t num_clients = list_size(s->clients);
+  for (size_t i = 0; i < num_clients; i++) {
+    server_apply_inputs(list_get(s->clients, i));
+  }
+  emscripten_main(s->state);
+  // delivers the keys to the game
+  sdl_is_done(s->state);
+  s->stats.ticks++;
+
+  for (size_t i = list_size(s->clients); i-- > 0;) {
+    server_client_t *client = list_get(s->clients, i);
+    if (s->stats.ticks - client->last_heard > SERVER_CLIENT_TIMEOUT) {
+      server_remove_client(s, i);
+    }
+  }
+}
+
+/** Writes the scene being played into chunks */
+void server_build_snapshot(server_t *s) {
+  scene_t *scene = emscripten_get_scene(s->state);
+  size_t num_bodies = scene_bodies(scene);
+  if (num_bodies > UINT16_MAX) {
+    num_bodies = UINT16_MAX;
+  }
+  size_t per_chunk = (SERVER_MAX_PACKET - SERVER_SNAPSHOT_HEADER_SIZE) /
+                     SERVER_SNAPSHOT_BODY_SIZE;
+  // an empty scene still gets a chunk, so clients see the tick
+  s->num_chunks = num_bodies == 0 ? 1 : (num_bodies + per_chunk - 1) / per_chunk;
+  if (s->num_chunks > s->chunks_capacity) {
+    s->chunks_capacity = s->num_chunks;
+    s->chunks = realloc(s->chunks, s->chunks_capacity * sizeof(*s->chunks));
+    s->chunk_sizes =
+        realloc(s->chunk_sizes, s->chunks_capacity * sizeof(size_t));
+    assert(s->chunks != NULL && s->chunk_sizes != NULL);
+  }
+  for (size_t i = 0; i < s->num_chunks; i++) {
+    size_t first = i * per_chunk;
+    size_t count = num_bodies - first < per_chunk ? num_bodies - first
+                                                  : per_chunk;
+    uint8_t *end = s->chunks[i];
+    server_put_u16(&end, SERVER_PROTOCOL_MAGIC);
+    server_put_u8(&end, SERVER_MSG_SNAPSHOT);
+    server_put_u32(&end, s->stats.ticks);
+    server_put_u16(&end, num_bodies);
+    server_put_u16(&end, first);
+    server_put_u16(&end, count);
+    for (size_t j = first; j < first + count; j++) {
+      body_t *body = scene_get_body(scene, j);
+      vector_t centroid = body_get_centroid(body);
+      color_t color = body_get_color(body);
+      server_put_f32(&end, centroid.x);
+      server_put_f32(&end, centroid.y);
+      server_put_u8(&end, server_color_byte(color.r));
+      server_put_u8(&end, server_color_byte(color.g));
+      server_put_u8(&end, server_color_byte(color.b));
+      server_put_u8(&end, server_color_byte(color.a));
+    }
+    s->chunk_sizes[i] = end - s->chunks[i];
+  }
+}
+
+/** Sends the snapshot to every client, a batch of packets per system call */
+void server_send_snapshot(server_t *s) {
+  server_build_snapshot(s);
+  size_t num_clients = list_size(s->clients);
+  size_t num_sends = num_clients * s->num_chunks;
+  if (num_sends > s->sends_capacity) {
+    s->sends_capacity = num_sends;
+    s->sends = realloc(s->sends, num_sends * sizeof(struct mmsghdr));
+    s->send_iovs = realloc(s->send_iovs, num_sends * sizeof(struct iovec));
+    assert(s->sends != NULL && s->send_iovs != NULL);
+  }
+  for (size_t i = 0; i < num_clients; i++) {
+    server_client_t *client = list_get(s->clients, i);
+    for (size_t j = 0; j < s->num_chunks; j++) {
+      size_t k = i * s->num_chunks + j;
+      s->send_iovs[k] = (struct iovec){.iov_base = s->chunks[j],
+                                       .iov_len = s->chunk_sizes[j]};
+      s->sends[k] = (struct mmsghdr){
+          .msg_hdr = {.msg_name = &client->address,
+                      .msg_namelen = sizeof(client->address),
+                      .msg_iov = &s->send_iovs[k],
+                      .msg_iovlen = 1}};
+    }
+  }
+  size_t sent = 0;
+  while (sent < num_sends) {
+    size_t batch = num_sends - sent < SERVER_BATCH ? num_sends - sent
+                                                   : SERVER_BATCH;
+    int result = sendmmsg(s->socket_id, s->sends + sent, batch, 0);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // the socket is full: this snapshot is lost for the rest,
+      // and the next one makes up for it
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS) {
+        perror("sendmmsg");
+      }
+      s->stats.sends_dropped += num_sends - sent;
+      break;
+    }
+    s->stats.packets_sent += result;
+    sent += result;
+  }
+}
+
+/** Runs the ticks that came due; returns whether to stop */
+bool server_run_due_ticks(server_t *s, size_t max_ticks) {
+  uint64_t expirations;
+  if (read(s->timer_id, &expirations, sizeof(expirations)) !=
+      sizeof(expirations)) {
+    return false;
+  }
+  uint64_t due = expirations;
+  if (due > 1 + SERVER_MAX_CATCH_UP) {
+    s->stats.ticks_skipped += due - 1 - SERVER_MAX_CATCH_UP;
+    due = 1 + SERVER_MAX_CATCH_UP;
+  }
+  for (uint64_t i = 0; i < due; i++) {
+    server_tick(s);
+    if (max_ticks != 0 && s->stats.ticks >= max_ticks) {
+      break;
+    }
+  }
+  server_send_snapshot(s);
+  return max_ticks != 0 && s->stats.ticks >= max_ticks;
+}
+
+void server_listen(server_t *s, size_t max_ticks) {
+  assert(s->socket_id >= 0);
+  long period = 1000000000L / SERVER_TICK_RATE;
+  struct itimerspec timer = {.it_interval = {.tv_nsec = period},
+                             .it_value = {.tv_nsec = period}};
+  if (timerfd_settime(s->timer_id, 0, &timer, NULL) < 0) {
+    perror("timerfd_settime");
+    return;
+  }
+  bool done = false;
+  while (!done) {
+    struct epoll_event events[3];
+    int num_events = epoll_wait(s->epoll_id, events, 3, -1);
+    if (num_events < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("epoll_wait");
+      break;
+    }
+    for (int i = 0; i < num_events; i++) {
+      int descriptor = events[i].data.fd;
+      if (descriptor == s->socket_id) {
+        server_receive(s);
+      } else if (descriptor == s->timer_id) {
+        done = server_run_due_ticks(s, max_ticks) || done;
+      } else {
+        uint64_t wakes;
+        if (read(s->wake_id, &wakes, sizeof(wakes)) == sizeof(wakes)) {
+          done = true;
+        }
+      }
+    }
+  }
+  timerfd_settime(s->timer_id, 0, &(struct itimerspec){{0}}, NULL);
+}
+
+void server_close(server_t *s) {
+  uint64_t wake = 1;
+  // only fails if the counter would overflow, which wakes the loop anyway
+  ssize_t written = write(s->wake_id, &wake, sizeof(wake));
+  (void)written;
+}
+
+server_stats_t server_get_stats(server_t *s) {
+  server_stats_t stats = s->stats;
+  stats.clients = list_size(s->clients);
+  return stats;
+}
+
+void server_free(server_t *s) {
+  // the game checks that every pool is empty on the way out, lists' included
+  list_free(s->clients);
+  if (s->state != NULL) {
+    emscripten_free(s->state);
+  }
+  int descriptors[] = {s->socket_id, s->epoll_id, s->timer_id, s->wake_id};
+  for (size_t i = 0; i < sizeof(descriptors) / sizeof(*descriptors); i++) {
+    if (descriptors[i] >= 0) {
+      close(descriptors[i]);
+    }
+  }
+  free(s->recv_packets);
+  free(s->recvs);
+  free(s->recv_iovs);
+  free(s->recv_addresses);
+  free(s->chunks);
+  free(s->chunk_sizes);
+  free(s->sends);
+  free(s->send_iovs);
+  free(s);
+}
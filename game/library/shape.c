@@ -0,0 +1,119 @@
+#include "shape.h"
+#include "utils.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+const size_t SHAPE_REGISTRY_CAPACITY = 8;
+
+typedef enum { SHAPE_CUSTOM, SHAPE_CIRCLE, SHAPE_RECTANGLE } shape_kind_t;
+
+typedef struct shape {
+  vec_array_t *vertices;
+  polygon_meta_t *meta;
+  size_t refs;
+  // registry key
+  shape_kind_t kind;
+  double params[2];
+} shape_t;
+
+/** The prototypes handed out so far; each holds one reference */
+list_t *shape_registry = NULL;
+
+shape_t *shape_from_polygon(vec_array_t *polygon) {
+  shape_t *shape = malloc(sizeof(shape_t));
+  assert(shape != NULL);
+  polygon_translate(polygon, vec_negate(polygon_centroid(polygon)));
+  shape->vertices = polygon;
+  shape->meta = polygon_meta_init(polygon);
+  shape->refs = 1;
+  shape->kind = SHAPE_CUSTOM;
+  return shape;
+}
+
+/** Finds a registered prototype, or returns NULL */
+shape_t *shape_registry_find(shape_kind_t kind, double a, double b) {
+  if (shape_registry == NULL) {
+    return NULL;
+  }
+  for (size_t i = 0; i < list_size(shape_registry); i++) {
+    shape_t *shape = list_get(shape_registry, i);
+    if (shape->kind == kind && shape->params[0] == a && shape->params[1] == b) {
+      return shape;
+    }
+  }
+  return NULL;
+}
+
+/** Registers a new prototype, handing the caller its reference */
+shape_t *shape_registry_add(vec_array_t *polygon, shape_kind_t kind, double a,
+                            double b) {
+  if (shape_registry == NULL) {
+    shape_registry =
+        list_init(SHAPE_REGISTRY_CAPACITY, (free_func_t)shape_release);
+  }
+  shape_t *shape = shape_from_polygon(polygon);
+  shape->kind = kind;
+  shape->params[0] = a;
+  shape->params[1] = b;
+  list_add(shape_registry, shape_retain(shape));
+  return shape;
+}
+
+shape_t *shape_circle(size_t num_points, double radius) {
+  shape_t *shape = shape_registry_find(SHAPE_CIRCLE, num_points, radius);
+  if (shape != NULL) {
+    return shape_retain(shape);
+  }
+  vec_array_t *circle = vec_array_init(num_points);
+  double increment_angle = 2 * M_PI / num_points;
+  for (size_t i = 0; i < num_points; i++) {
+    vec_array_add(circle, vec_rotate((vector_t){radius, 0}, i * increment_angle));
+  }
+  return shape_registry_add(circle, SHAPE_CIRCLE, num_points, radius);
+}
+
+shape_t *shape_rectangle(double width, double height) {
+  shape_t *shape = shape_registry_find(SHAPE_RECTANGLE, width, height);
+  if (shape != NULL) {
+    return shape_retain(shape);
+  }
+  return shape_registry_add(make_rectangle(width, height, VEC_ZERO),
+                            SHAPE_RECTANGLE, width, height);
+}
+
+shape_t *shape_retain(shape_t *shape) {
+  shape->refs++;
+  return shape;
+}
+
+void shape_release(shape_t *shape) {
+  assert(shape->refs > 0);
+  shape->refs--;
+  if (shape->refs == 0) {
+    vec_array_free(shape->vertices);
+    polygon_meta_free(shape->meta);
+    free(shape);
+  }
+}
+
+vec_array_t *shape_get_vertices(shape_t *shape) { return shape->vertices; }
+
+vec_array_t *shape_place(shape_t *shape, vector_t centroid, double angle,
+                         arena_t *arena) {
+  vec_array_t *placed = vec_array_copy_in(arena, shape->vertices);
+  if (angle != 0) {
+    polygon_rotate(placed, angle, VEC_ZERO);
+  }
+  polygon_translate(placed, centroid);
+  return placed;
+}
+
+polygon_meta_t *shape_get_meta(shape_t *shape) { return shape->meta; }
+
+void shape_registry_free(void) {
+  if (shape_registry != NULL) {
+    list_free(shape_registry);
+    shape_registry = NULL;
+  }
+}
@@ -0,0 +1,129 @@
+#include "sound_bank.h"
+#include <assert.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// must be a power of 2
+#define SOUND_QUEUE_CAPACITY 256
+
+typedef struct voice {
+  double start;
+  double end;
+} voice_t;
+
+typedef struct sound_bank {
+  // written by the producer only
+  atomic_size_t tail;
+  double cooldowns[NUM_SOUNDS];
+  double last_queued[NUM_SOUNDS];
+  size_t dropped;
+
+  // written by the consumer only
+  atomic_size_t head;
+  double lengths[NUM_SOUNDS];
+  int first_voice;
+  size_t num_voices;
+  voice_t *voices;
+
+  sound_command_t queue[SOUND_QUEUE_CAPACITY];
+} sound_bank_t;
+
+sound_bank_t *sound_bank_init(int first_voice, size_t num_voices,
+                              double cooldown) {
+  assert(first_voice >= 0);
+  assert(num_voices > 0);
+  sound_bank_t *bank = malloc(sizeof(sound_bank_t));
+  assert(bank != NULL);
+  atomic_init(&bank->tail, 0);
+  atomic_init(&bank->head, 0);
+  for (size_t i = 0; i < NUM_SOUNDS; i++) {
+    bank->cooldowns[i] = cooldown;
+    bank->last_queued[i] = -INFINITY;
+    bank->lengths[i] = 0;
+  }
+  bank->dropped = 0;
+  bank->first_voice = first_voice;
+  bank->num_voices = num_voices;
+  bank->voices = malloc(sizeof(voice_t) * num_voices);
+  assert(bank->voices != NULL);
+  for (size_t i = 0; i < num_voices; i++) {
+    bank->voices[i] = (voice_t){.start = -INFINITY, .end = -INFINITY};
+  }
+  return bank;
+}
+
+void sound_bank_free(sound_bank_t *bank) {
+  free(bank->voices);
+  free(bank);
+}
+
+void sound_bank_set_cooldown(sound_bank_t *bank, sound_id_t sound,
+                             double cooldown) {
+  assert(sound < NUM_SOUNDS);
+  bank->cooldowns[sound] = cooldown;
+}
+
+void sound_bank_set_length(sound_bank_t *bank, sound_id_t sound,
+                           double length) {
+  assert(sound < NUM_SOUNDS);
+  bank->lengths[sound] = length;
+}
+
+bool sound_bank_push(sound_bank_t *bank, sound_command_t command, double now) {
+  assert(command.sound < NUM_SOUNDS);
+  if (now - bank->last_queued[command.sound] < bank->cooldowns[command.sound]) {
+    bank->dropped++;
+    return false;
+  }
+  size_t tail = atomic_load_explicit(&bank->tail, memory_order_relaxed);
+  size_t head = atomic_load_explicit(&bank->head, memory_order_acquire);
+  if (tail - head == SOUND_QUEUE_CAPACITY) {
+    bank->dropped++;
+    return false;
+  }
+  bank->queue[tail & (SOUND_QUEUE_CAPACITY - 1)] = command;
+  // publish the command only once it has been written
+  atomic_store_explicit(&bank->tail, tail + 1, memory_order_release);
+  bank->last_queued[command.sound] = now;
+  return true;
+}
+
+bool sound_bank_pop(sound_bank_t *bank, sound_command_t *command) {
+  size_t head = atomic_load_explicit(&bank->head, memory_order_relaxed);
+  size_t tail = atomic_load_explicit(&bank->tail, memory_order_acquire);
+  if (head == tail) {
+    return false;
+  }
+  *command = bank->queue[head & (SOUND_QUEUE_CAPACITY - 1)];
+  // only let the producer reuse the slot once it has been read
+  atomic_store_explicit(&bank->head, head + 1, memory_order_release);
+  return true;
+}
+
+int sound_bank_assign_voice(sound_bank_t *bank, sound_command_t command,
+                            double now) {
+  if (command.channel >= 0) {
+    return command.channel;
+  }
+  // prefer a free voice, then the oldest voice that will end by itself
+  size_t best = 0;
+  for (size_t i = 0; i < bank->num_voices; i++) {
+    voice_t *voice = &bank->voices[i], *best_voice = &bank->voices[best];
+    if (voice->end <= now) {
+      best = i;
+      break;
+    }
+    bool finite = voice->end < INFINITY, best_finite = best_voice->end < INFINITY;
+    if ((finite && !best_finite) ||
+        (finite == best_finite && voice->start < best_voice->start)) {
+      best = i;
+    }
+  }
+  double length =
+      command.loops < 0 ? INFINITY : bank->lengths[command.sound] * (command.loops + 1);
+  bank->voices[best] = (voice_t){.start = now, .end = now + length};
+  return bank->first_voice + best;
+}
+
+size_t sound_bank_get_dropped(sound_bank_t *bank) { return bank->dropped; }
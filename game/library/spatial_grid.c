@@ -0,0 +1,308 @@
+#include "spatial_grid.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// must be a power of 2
+const size_t GRID_NUM_BUCKETS = 1024;
+const size_t GRID_DEFAULT_ENTRIES = 64;
+const size_t GRID_BUCKET_CAPACITY = 4;
+
+typedef struct grid_entry {
+  void *item;
+  aabb_t box;
+  size_t stamp;
+} grid_entry_t;
+
+typedef struct grid_bucket {
+  size_t *entries;
+  size_t size;
+  size_t capacity;
+} grid_bucket_t;
+
+typedef struct spatial_grid {
+  double cell_size;
+  // entries of removed items have a NULL item and are listed in free_entries
+  grid_entry_t *entries;
+  size_t num_entries;
+  size_t capacity;
+  size_t *free_entries;
+  size_t num_free;
+  size_t size;
+  grid_bucket_t *buckets;
+  // items that span too many cells to be worth bucketing; always tested
+  grid_bucket_t oversized;
+  size_t stamp;
+} spatial_grid_t;
+
+spatial_grid_t *spatial_grid_init(double cell_size) {
+  assert(cell_size > 0);
+  spatial_grid_t *grid = malloc(sizeof(spatial_grid_t));
+  assert(grid != NULL);
+  grid->cell_size = cell_size;
+  grid->entries = malloc(sizeof(grid_entry_t) * GRID_DEFAULT_ENTRIES);
+  assert(grid->entries != NULL);
+  grid->num_entries = 0;
+  grid->capacity = GRID_DEFAULT_ENTRIES;
+  grid->free_entries = malloc(sizeof(size_t) * GRID_DEFAULT_ENTRIES);
+  assert(grid->free_entries != NULL);
+  grid->num_free = 0;
+  grid->size = 0;
+  grid->buckets = calloc(GRID_NUM_BUCKETS, sizeof(grid_bucket_t));
+  assert(grid->buckets != NULL);
+  grid->oversized = (grid_bucket_t){.entries = NULL, .size = 0, .capacity = 0};
+  grid->stamp = 0;
+  return grid;
+}
+
+void spatial_grid_free(spatial_grid_t *grid) {
+  for (size_t i = 0; i < GRID_NUM_BUCKETS; i++) {
+    free(grid->buckets[i].entries);
+  }
+  free(grid->buckets);
+  free(grid->oversized.entries);
+  free(grid->entries);
+  free(grid->free_entries);
+  free(grid);
+}
+
+void spatial_grid_clear(spatial_grid_t *grid) {
+  for (size_t i = 0; i < GRID_NUM_BUCKETS; i++) {
+    grid->buckets[i].size = 0;
+  }
+  grid->oversized.size = 0;
+  grid->num_entries = 0;
+  grid->num_free = 0;
+  grid->size = 0;
+}
+
+size_t spatial_grid_size(spatial_grid_t *grid) { return grid->size; }
+
+/** Maps a coordinate to the index of the cell containing it */
+long grid_cell(spatial_grid_t *grid, double coord) {
+  return (long)floor(coord / grid->cell_size);
+}
+
+grid_bucket_t *grid_bucket(spatial_grid_t *grid, long cx, long cy) {
+  size_t hash = ((size_t)cx * 73856093u) ^ ((size_t)cy * 19349663u);
+  return &grid->buckets[hash & (GRID_NUM_BUCKETS - 1)];
+}
+
+void grid_bucket_add(grid_bucket_t *bucket, size_t entry) {
+  if (bucket->size == bucket->capacity) {
+    size_t new_capacity =
+        bucket->capacity == 0 ? GRID_BUCKET_CAPACITY : bucket->capacity * 2;
+    bucket->entries = realloc(bucket->entries, sizeof(size_t) * new_capacity);
+    assert(bucket->entries != NULL);
+    bucket->capacity = new_capacity;
+  }
+  bucket->entries[bucket->size] = entry;
+  bucket->size++;
+}
+
+/** Returns the number of cells a box spans */
+double grid_cell_count(spatial_grid_t *grid, aabb_t box) {
+  double cols = grid_cell(grid, box.max.x) - grid_cell(grid, box.min.x) + 1;
+  double rows = grid_cell(grid, box.max.y) - grid_cell(grid, box.min.y) + 1;
+  return cols * rows;
+}
+
+/** Removes every occurrence of an entry from a bucket */
+void grid_bucket_remove(grid_bucket_t *bucket, size_t entry) {
+  for (size_t i = 0; i < bucket->size;) {
+    if (bucket->entries[i] == entry) {
+      bucket->entries[i] = bucket->entries[--bucket->size];
+    } else {
+      i++;
+    }
+  }
+}
+
+/** Adds an entry to the buckets of the cells its box overlaps */
+void grid_link(spatial_grid_t *grid, size_t entry) {
+  aabb_t box = grid->entries[entry].box;
+  if (grid_cell_count(grid, box) > GRID_NUM_BUCKETS) {
+    grid_bucket_add(&grid->oversized, entry);
+    return;
+  }
+  for (long cx = grid_cell(grid, box.min.x); cx <= grid_cell(grid, box.max.x);
+       cx++) {
+    for (long cy = grid_cell(grid, box.min.y);
+         cy <= grid_cell(grid, box.max.y); cy++) {
+      grid_bucket_t *bucket = grid_bucket(grid, cx, cy);
+      // an item spanning two cells that hash together only needs one entry
+      if (bucket->size == 0 || bucket->entries[bucket->size - 1] != entry) {
+        grid_bucket_add(bucket, entry);
+      }
+    }
+  }
+}
+
+/** Removes an entry from the buckets of the cells its box overlaps */
+void grid_unlink(spatial_grid_t *grid, size_t entry) {
+  aabb_t box = grid->entries[entry].box;
+  if (grid_cell_count(grid, box) > GRID_NUM_BUCKETS) {
+    grid_bucket_remove(&grid->oversized, entry);
+    return;
+  }
+  for (long cx = grid_cell(grid, box.min.x); cx <= grid_cell(grid, box.max.x);
+       cx++) {
+    for (long cy = grid_cell(grid, box.min.y);
+         cy <= grid_cell(grid, box.max.y); cy++) {
+      grid_bucket_remove(grid_bucket(grid, cx, cy), entry);
+    }
+  }
+}
+
+size_t spatial_grid_insert(spatial_grid_t *grid, void *item, aabb_t box) {
+  assert(item != NULL);
+  size_t entry;
+  if (grid->num_free > 0) {
+    entry = grid->free_entries[--grid->num_free];
+  } else {
+    if (grid->num_entries == grid->capacity) {
+      grid->capacity *= 2;
+      grid->entries =
+          realloc(grid->entries, sizeof(grid_entry_t) * grid->capacity);
+      grid->free_entries =
+          realloc(grid->free_entries, sizeof(size_t) * grid->capacity);
+      assert(grid->entries != NULL && grid->free_entries != NULL);
+    }
+    entry = grid->num_entries++;
+  }
+  grid->entries[entry] = (grid_entry_t){.item = item, .box = box, .stamp = 0};
+  grid->size++;
+  grid_link(grid, entry);
+  return entry;
+}
+
+void spatial_grid_move(spatial_grid_t *grid, size_t handle, aabb_t box) {
+  assert(handle < grid->num_entries && grid->entries[handle].item != NULL);
+  grid_unlink(grid, handle);
+  grid->entries[handle].box = box;
+  grid_link(grid, handle);
+}
+
+void spatial_grid_remove(spatial_grid_t *grid, size_t handle) {
+  assert(handle < grid->num_entries && grid->entries[handle].item != NULL);
+  grid_unlink(grid, handle);
+  grid->entries[handle].item = NULL;
+  grid->free_entries[grid->num_free++] = handle;
+  grid->size--;
+}
+
+/**
+ * Appends the entries of a bucket that overlap the box and haven't been seen
+ * by the current query
+ */
+size_t grid_query_bucket(spatial_grid_t *grid, grid_bucket_t *bucket,
+                         aabb_t box, list_t *out) {
+  size_t found = 0;
+  for (size_t i = 0; i < bucket->size; i++) {
+    grid_entry_t *entry = &grid->entries[bucket->entries[i]];
+    if (entry->stamp == grid->stamp) {
+      continue;
+    }
+    entry->stamp = grid->stamp;
+    if (aabb_overlaps(entry->box, box)) {
+      list_add(out, entry->item);
+      found++;
+    }
+  }
+  return found;
+}
+
+size_t spatial_grid_query(spatial_grid_t *grid, aabb_t box, list_t *out) {
+  grid->stamp++;
+  size_t found = grid_query_bucket(grid, &grid->oversized, box, out);
+
+  if (grid_cell_count(grid, box) > GRID_NUM_BUCKETS) {
+    // the box covers more cells than there are buckets: scan everything
+    for (size_t i = 0; i < grid->num_entries; i++) {
+      grid_entry_t *entry = &grid->entries[i];
+      if (entry->item != NULL && entry->stamp != grid->stamp &&
+          aabb_overlaps(entry->box, box)) {
+        entry->stamp = grid->stamp;
+        list_add(out, entry->item);
+        found++;
+      }
+    }
+    return found;
+  }
+
+  for (long cx = grid_cell(grid, box.min.x); cx <= grid_cell(grid, box.max.x);
+       cx++) {
+    for (long cy = grid_cell(grid, box.min.y);
+         cy <= grid_cell(grid, box.max.y); cy++) {
+      found += grid_query_bucket(grid, grid_bucket(grid, cx, cy), box, out);
+    }
+  }
+  return found;
+}
+
+/** Tests the unseen entries of a bucket against a ray, keeping the closest */
+void grid_raycast_bucket(spatial_grid_t *grid, grid_bucket_t *bucket,
+                         aabb_t ray_box, spatial_ray_test_t test, void *aux,
+                         void **best_item, double *best) {
+  for (size_t i = 0; i < bucket->size; i++) {
+    grid_entry_t *entry = &grid->entries[bucket->entries[i]];
+    if (entry->stamp == grid->stamp) {
+      continue;
+    }
+    entry->stamp = grid->stamp;
+    if (!aabb_overlaps(entry->box, ray_box)) {
+      continue;
+    }
+    double t = test(entry->item, aux);
+    if (t < *best) {
+      *best = t;
+      *best_item = entry->item;
+    }
+  }
+}
+
+void *spatial_grid_raycast(spatial_grid_t *grid, vector_t start, vector_t end,
+                           spatial_ray_test_t test, void *aux,
+                           double *fraction) {
+  grid->stamp++;
+  aabb_t ray_box = aabb_from_segment(start, end);
+  void *best_item = NULL;
+  double best = INFINITY;
+  grid_raycast_bucket(grid, &grid->oversized, ray_box, test, aux, &best_item,
+                      &best);
+
+  // walk the cells along the segment (Amanatides & Woo)
+  vector_t dir = vec_subtract(end, start);
+  long cx = grid_cell(grid, start.x), cy = grid_cell(grid, start.y);
+  long end_cx = grid_cell(grid, end.x), end_cy = grid_cell(grid, end.y);
+  long step_x = dir.x > 0 ? 1 : -1, step_y = dir.y > 0 ? 1 : -1;
+  double next_x = (cx + (step_x > 0 ? 1 : 0)) * grid->cell_size;
+  double next_y = (cy + (step_y > 0 ? 1 : 0)) * grid->cell_size;
+  double t_max_x = dir.x != 0 ? (next_x - start.x) / dir.x : INFINITY;
+  double t_max_y = dir.y != 0 ? (next_y - start.y) / dir.y : INFINITY;
+  double t_delta_x = dir.x != 0 ? grid->cell_size / fabs(dir.x) : INFINITY;
+  double t_delta_y = dir.y != 0 ? grid->cell_size / fabs(dir.y) : INFINITY;
+  size_t steps = labs(end_cx - cx) + labs(end_cy - cy) + 1;
+
+  for (size_t i = 0; i < steps; i++) {
+    grid_raycast_bucket(grid, grid_bucket(grid, cx, cy), ray_box, test, aux,
+                        &best_item, &best);
+    // no later cell can hold a hit closer than where we leave this one
+    double t_exit = fmin(t_max_x, t_max_y);
+    if (best <= t_exit) {
+      break;
+    }
+    if (t_max_x < t_max_y) {
+      cx += step_x;
+      t_max_x += t_delta_x;
+    } else {
+      cy += step_y;
+      t_max_y += t_delta_y;
+    }
+  }
+
+  if (fraction != NULL) {
+    *fraction = best;
+  }
+  return best_item;
+}
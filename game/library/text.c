@@ -1,4 +1,5 @@
 #include "sdl_wrapper.h"
+#include <assert.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -13,7 +14,6 @@ text_t *text_init(char *text, vector_t center, double height, double width, colo
   t->width = width;
   t->color = color;
   t->duration = duration;
-  t->texture = sdl_prepare_text(text, center, height, width * strlen(text), color);
   t->removed = false;
   return t;
 }
@@ -21,27 +21,21 @@ text_t *text_init(char *text, vector_t center, double height, double width, colo
 void text_edit(text_t *t, char *new) {
   // new text contents
   free(t->text);
-  t->text = malloc(sizeof(char) * strlen(new));
+  t->text = malloc(sizeof(char) * (strlen(new) + 1));
+  assert(t->text != NULL);
   strcpy(t->text, new);
-
-  // new texture
-  sdl_free_text(t->texture);
-  t->texture = sdl_prepare_text(new, t->center, t->height, t->width * strlen(new), t->color);
 }
 
 void text_set_color(text_t *t, color_t new_color) {
-  sdl_free_text(t->texture);
   t->color = new_color;
-  t->texture = sdl_prepare_text(t->text, t->center, t->height, t->width * strlen(t->text), new_color);
 }
 
 void text_move(text_t *t, vector_t pos) {
   t->center = pos;
-  sdl_move_text(t->texture, pos, t->height, t->width * strlen(t->text));
 }
 
 void text_render(text_t *t) {
-  sdl_render_text(t->texture);
+  sdl_draw_text(t->text, t->center, t->height, t->width, t->color);
 }
 
 void text_remove(text_t *t) {
@@ -59,15 +53,10 @@ void text_tick(text_t *t, double dt) {
       text_remove(t);
     }
   }
-  
-  if(!t->removed) {
-    text_render(t);
-  } 
 }
 
 void text_free(void *t) {
   text_t *t_casted = (text_t *)t;
-  sdl_free_text(t_casted->texture);
   free(t_casted->text);
   free(t_casted);
 }
\ No newline at end of file
@@ -0,0 +1,233 @@
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <dlfcn.h>
+#define TRACE_HAVE_DLADDR
+#endif
+
+#include "trace.h"
+#include "profiler.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// enough for a few frames of a busy game
+const size_t TICK_TRACER_CAPACITY = 1 << 16;
+#define TRACE_MAX_DEPTH 16
+const size_t TRACE_MAX_SLOW_DUMPS = 10;
+const char *TRACE_FRAME_CATEGORY = "frame";
+
+typedef struct {
+  const char *category;
+  // NULL for spans named after their function
+  const char *name;
+  const void *function;
+  // microseconds since the tracer was allocated
+  double start;
+  double duration;
+} trace_span_t;
+
+typedef struct tracer {
+  // ring buffer of closed spans
+  trace_span_t *spans;
+  size_t capacity;
+  size_t next_span;
+  size_t num_spans;
+
+  // the open spans, innermost last
+  trace_span_t stack[TRACE_MAX_DEPTH];
+  size_t depth;
+
+  double origin;
+  double frame_start;
+  size_t num_frames;
+
+  double slow_frame_us;
+  char *slow_frame_prefix;
+  size_t num_slow_dumps;
+} tracer_t;
+
+tracer_t *tick_tracer_instance = NULL;
+
+tracer_t *tracer_init(size_t capacity) {
+  assert(capacity > 0);
+  tracer_t *tracer = calloc(1, sizeof(tracer_t));
+  assert(tracer != NULL);
+  tracer->spans = malloc(capacity * sizeof(trace_span_t));
+  assert(tracer->spans != NULL);
+  tracer->capacity = capacity;
+  tracer->origin = profiler_now();
+  return tracer;
+}
+
+void tracer_free(tracer_t *tracer) {
+  if (tracer == NULL) {
+    return;
+  }
+  free(tracer->spans);
+  free(tracer->slow_frame_prefix);
+  free(tracer);
+}
+
+void tracer_set_slow_frame(tracer_t *tracer, double threshold_ms,
+                           const char *prefix) {
+  if (tracer == NULL) {
+    return;
+  }
+  assert(threshold_ms >= 0);
+  assert(prefix != NULL);
+  free(tracer->slow_frame_prefix);
+  tracer->slow_frame_prefix = malloc(strlen(prefix) + 1);
+  assert(tracer->slow_frame_prefix != NULL);
+  strcpy(tracer->slow_frame_prefix, prefix);
+  tracer->slow_frame_us = threshold_ms * 1e3;
+}
+
+/** Opens a span with either a name or a function */
+void trace_push(tracer_t *tracer, const char *category, const char *name,
+                const void *function) {
+  assert(tracer->depth < TRACE_MAX_DEPTH);
+  tracer->stack[tracer->depth++] =
+      (trace_span_t){.category = category,
+                     .name = name,
+                     .function = function,
+                     .start = profiler_now() - tracer->origin};
+}
+
+void trace_begin(tracer_t *tracer, const char *category, const char *name) {
+  if (tracer == NULL) {
+    return;
+  }
+  assert(name != NULL);
+  trace_push(tracer, category, name, NULL);
+}
+
+void trace_begin_call(tracer_t *tracer, const char *category,
+                      const void *function) {
+  if (tracer == NULL) {
+    return;
+  }
+  trace_push(tracer, category, NULL, function);
+}
+
+/** Adds a closed span to the buffer, overwriting the oldest if it is full */
+void trace_add_span(tracer_t *tracer, trace_span_t span) {
+  tracer->spans[tracer->next_span] = span;
+  tracer->next_span = (tracer->next_span + 1) % tracer->capacity;
+  if (tracer->num_spans < tracer->capacity) {
+    tracer->num_spans++;
+  }
+}
+
+void trace_end(tracer_t *tracer) {
+  if (tracer == NULL) {
+    return;
+  }
+  assert(tracer->depth > 0);
+  trace_span_t span = tracer->stack[--tracer->depth];
+  span.duration = profiler_now() - tracer->origin - span.start;
+  trace_add_span(tracer, span);
+}
+
+void trace_end_frame(tracer_t *tracer) {
+  if (tracer == NULL) {
+    return;
+  }
+  assert(tracer->depth == 0);
+  double now = profiler_now() - tracer->origin;
+  trace_span_t frame = {.category = TRACE_FRAME_CATEGORY,
+                        .name = TRACE_FRAME_CATEGORY,
+                        .function = NULL,
+                        .start = tracer->frame_start,
+                        .duration = now - tracer->frame_start};
+  trace_add_span(tracer, frame);
+  tracer->frame_start = now;
+  tracer->num_frames++;
+
+  if (tracer->slow_frame_us > 0 && frame.duration > tracer->slow_frame_us &&
+      tracer->num_slow_dumps < TRACE_MAX_SLOW_DUMPS) {
+    tracer->num_slow_dumps++;
+    size_t length = strlen(tracer->slow_frame_prefix) + 32;
+    char path[length];
+    snprintf(path, length, "%s-%zu.json", tracer->slow_frame_prefix,
+             tracer->num_frames);
+    if (tracer_dump(tracer, path)) {
+      fprintf(stderr, "frame %zu took %.1f ms, trace written to %s\n",
+              tracer->num_frames, frame.duration * 1e-3, path);
+    }
+  }
+}
+
+/** Writes a string as a JSON string */
+void trace_write_string(FILE *file, const char *string) {
+  fputc('"', file);
+  for (const char *c = string; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') {
+      fputc('\\', file);
+    }
+    if ((unsigned char)*c >= ' ') {
+      fputc(*c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+/** Writes a span's name, looking up the name of its function if need be */
+void trace_write_name(FILE *file, const trace_span_t *span) {
+  if (span->name != NULL) {
+    trace_write_string(file, span->name);
+    return;
+  }
+#ifdef TRACE_HAVE_DLADDR
+  // dladdr() finds the closest symbol before the address,
+  // which is only the function if the function itself is exported
+  Dl_info info;
+  if (dladdr(span->function, &info) != 0 && info.dli_sname != NULL &&
+      info.dli_saddr == span->function) {
+    trace_write_string(file, info.dli_sname);
+    return;
+  }
+#endif
+  fprintf(file, "\"%p\"", span->function);
+}
+
+bool tracer_dump(tracer_t *tracer, const char *path) {
+  if (tracer == NULL) {
+    return false;
+  }
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    fprintf(stderr, "%s: could not write trace\n", path);
+    return false;
+  }
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+                "\"args\":{\"name\":\"game\"}}");
+  size_t oldest =
+      (tracer->next_span + tracer->capacity - tracer->num_spans) %
+      tracer->capacity;
+  for (size_t i = 0; i < tracer->num_spans; i++) {
+    const trace_span_t *span = &tracer->spans[(oldest + i) % tracer->capacity];
+    fprintf(file, ",\n{\"name\":");
+    trace_write_name(file, span);
+    fprintf(file, ",\"cat\":");
+    trace_write_string(file, span->category);
+    fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+            span->start, span->duration);
+  }
+  fprintf(file, "\n]}\n");
+  return fclose(file) == 0;
+}
+
+tracer_t *tick_tracer(void) { return tick_tracer_instance; }
+
+void tick_tracer_set_enabled(bool enabled) {
+  if (enabled && tick_tracer_instance == NULL) {
+    tick_tracer_instance = tracer_init(TICK_TRACER_CAPACITY);
+  } else if (!enabled && tick_tracer_instance != NULL) {
+    tracer_free(tick_tracer_instance);
+    tick_tracer_instance = NULL;
+  }
+}
@@ -28,9 +28,9 @@ color_t rainbow_color(double n, double m)
   return (color_t){.r = r / 255, .g = g / 255, .b = b / 255, .a = 1};
 }
 
-list_t *make_circle(size_t num_points, size_t length, vector_t center)
+vec_array_t *make_circle(size_t num_points, size_t length, vector_t center)
 {
-  list_t *circle = list_init(num_points, free);
+  vec_array_t *circle = vec_array_init(num_points);
   double x_pos, y_pos;
   double increment_angle = 2 * M_PI / num_points;
   double angle = 0;
@@ -38,29 +38,18 @@ list_t *make_circle(size_t num_points, size_t length, vector_t center)
   {
     x_pos = cos(angle) * length + center.x;
     y_pos = sin(angle) * length + center.y;
-    vector_t *point = malloc(sizeof(vector_t));
-    point->x = x_pos;
-    point->y = y_pos;
-    list_add(circle, point);
+    vec_array_add(circle, (vector_t){x_pos, y_pos});
     angle += increment_angle;
   }
   return circle;
 }
 
-list_t *make_rectangle(double width, double height, vector_t center)
+vec_array_t *make_rectangle(double width, double height, vector_t center)
 {
-  list_t *rectangle = list_init(4, free);
-  vector_t *v = malloc(sizeof(*v));
-  *v = (vector_t){-0.5 * width + center.x, -0.5 * height + center.y};
-  list_add(rectangle, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){+0.5 * width + center.x, -0.5 * height + center.y};
-  list_add(rectangle, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){+0.5 * width + center.x, +0.5 * height + center.y};
-  list_add(rectangle, v);
-  v = malloc(sizeof(*v));
-  *v = (vector_t){-0.5 * width + center.x, +0.5 * height + center.y};
-  list_add(rectangle, v);
+  vec_array_t *rectangle = vec_array_init(4);
+  vec_array_add(rectangle, (vector_t){-0.5 * width + center.x, -0.5 * height + center.y});
+  vec_array_add(rectangle, (vector_t){+0.5 * width + center.x, -0.5 * height + center.y});
+  vec_array_add(rectangle, (vector_t){+0.5 * width + center.x, +0.5 * height + center.y});
+  vec_array_add(rectangle, (vector_t){-0.5 * width + center.x, +0.5 * height + center.y});
   return rectangle;
 }
\ No newline at end of file
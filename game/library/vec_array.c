@@ -0,0 +1,110 @@
+#include "vec_array.h"
+#include "metrics.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t VEC_ARRAY_RESIZE_MULTIPLIER = 2;
+
+typedef struct vec_array {
+  vector_t *data;
+  size_t size;
+  size_t capacity;
+  // if non-NULL, the arena holding the array and its data
+  arena_t *arena;
+} vec_array_t;
+
+vec_array_t *vec_array_init(size_t initial_capacity) {
+  vec_array_t *array = malloc(sizeof(vec_array_t));
+  assert(array != NULL);
+  // always keep a buffer so that vec_array_data() is never NULL
+  array->capacity = initial_capacity > 0 ? initial_capacity : 1;
+  array->data = malloc(sizeof(vector_t) * array->capacity);
+  assert(array->data != NULL);
+  metrics_add(METRIC_ALLOCS_VEC_ARRAY, 2);
+  array->size = 0;
+  array->arena = NULL;
+  return array;
+}
+
+vec_array_t *vec_array_init_in(arena_t *arena, size_t initial_capacity) {
+  vec_array_t *array = arena_alloc(arena, sizeof(vec_array_t));
+  array->capacity = initial_capacity > 0 ? initial_capacity : 1;
+  array->data = arena_alloc(arena, sizeof(vector_t) * array->capacity);
+  array->size = 0;
+  array->arena = arena;
+  return array;
+}
+
+void vec_array_free(void *array) {
+  vec_array_t *casted_array = (vec_array_t *)array;
+  if (casted_array->arena != NULL) {
+    return; // released with its arena
+  }
+  free(casted_array->data);
+  free(casted_array);
+}
+
+size_t vec_array_size(vec_array_t *array) { return array->size; }
+
+vector_t vec_array_get(vec_array_t *array, size_t index) {
+  assert(index < array->size);
+  return array->data[index];
+}
+
+void vec_array_set(vec_array_t *array, size_t index, vector_t value) {
+  assert(index < array->size);
+  array->data[index] = value;
+}
+
+void vec_array_add(vec_array_t *array, vector_t value) {
+  if (array->size == array->capacity) {
+    array->capacity *= VEC_ARRAY_RESIZE_MULTIPLIER;
+    if (array->arena != NULL) {
+      vector_t *data =
+          arena_alloc(array->arena, sizeof(vector_t) * array->capacity);
+      memcpy(data, array->data, sizeof(vector_t) * array->size);
+      array->data = data;
+    } else {
+      array->data = realloc(array->data, sizeof(vector_t) * array->capacity);
+      assert(array->data != NULL);
+      metrics_add(METRIC_ALLOCS_VEC_ARRAY, 1);
+    }
+  }
+  array->data[array->size] = value;
+  array->size++;
+}
+
+vector_t *vec_array_data(vec_array_t *array) { return array->data; }
+
+vec_array_t *vec_array_copy(vec_array_t *array) {
+  return vec_array_copy_in(NULL, array);
+}
+
+vec_array_t *vec_array_copy_in(arena_t *arena, vec_array_t *array) {
+  vec_array_t *copy = arena != NULL ? vec_array_init_in(arena, array->size)
+                                    : vec_array_init(array->size);
+  memcpy(copy->data, array->data, sizeof(vector_t) * array->size);
+  copy->size = array->size;
+  return copy;
+}
+
+vec_array_t *vec_array_from_list(list_t *points) {
+  vec_array_t *array = vec_array_init(list_size(points));
+  for (size_t i = 0; i < list_size(points); i++) {
+    vec_array_add(array, *((vector_t *)list_get(points, i)));
+  }
+  return array;
+}
+
+list_t *vec_array_to_list(vec_array_t *array) {
+  list_t *points = list_init(array->size, free);
+  for (size_t i = 0; i < array->size; i++) {
+    vector_t *point = malloc(sizeof(vector_t));
+    assert(point != NULL);
+    metrics_add(METRIC_ALLOCS_VEC_ARRAY, 1);
+    *point = array->data[i];
+    list_add(points, point);
+  }
+  return points;
+}
@@ -0,0 +1,126 @@
+/**
+ * Headless bullet test: plays SLYCE on the core library, puts the first
+ * player's head against each wall in turn, facing it, and shoots. The bullet
+ * spawns on or past the wall's inner edge, and the test fails unless the
+ * wall still stops it within a few frames.
+ *
+ * Usage: bin/bullets
+ */
+
+#include "body.h"
+#include "list.h"
+#include "scene.h"
+#include "sdl_null.h"
+#include "state.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+const double BULLETS_TICK = 1.0 / 60;
+const vector_t BULLETS_WINDOW = {.x = 1600, .y = 900};
+// half the side of a color choice box, so the sweep hovers every box
+const double BULLETS_SWEEP_STEP = 25;
+// the first player's shoot key
+const char BULLETS_SHOOT_KEY = 'r';
+// how far inside the arena the head is put, less than the bullet's spawn
+// distance, so the bullet starts on or past the wall's edge
+const double BULLETS_WALL_GAP = 1;
+// long enough for the shot's cooldown to run out
+const size_t BULLETS_MAX_SHOOT_FRAMES = 600;
+// a bullet that is not stopped by then has gone through the wall
+const size_t BULLETS_MAX_HIT_FRAMES = 10;
+
+typedef struct {
+  const char *name;
+  vector_t head;
+  vector_t direction;
+} bullets_wall_t;
+
+/** Runs one frame the way emscripten.c's loop does */
+void bullets_frame(state_t *state) {
+  emscripten_main(state);
+  sdl_is_done(state);
+}
+
+/** Returns the first body whose info is a list starting with a type */
+body_t *bullets_find(scene_t *scene, const char *type) {
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    char *body_type = list_get(body_get_info(body), 0);
+    if (!body_is_removed(body) && strcmp(body_type, type) == 0) {
+      return body;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Shoots from the head at a position and in a direction, waiting out the
+ * cooldown first; returns whether a bullet was fired.
+ */
+bool bullets_shoot(state_t *state, body_t *head, bullets_wall_t wall) {
+  scene_t *scene = emscripten_get_scene(state);
+  for (size_t frame = 0; frame < BULLETS_MAX_SHOOT_FRAMES; frame++) {
+    body_set_centroid(head, wall.head);
+    body_set_velocity(head, vec_multiply(100, wall.direction));
+    sdl_null_send_key(BULLETS_SHOOT_KEY, KEY_PRESSED);
+    sdl_null_send_key(BULLETS_SHOOT_KEY, KEY_RELEASED);
+    sdl_is_done(state);
+    if (bullets_find(scene, "bullet") != NULL) {
+      return true;
+    }
+    emscripten_main(state);
+  }
+  return false;
+}
+
+int main(void) {
+  sdl_null_set_tick(BULLETS_TICK);
+  state_t *state = emscripten_init();
+
+  // menu: hover over every color choice, then start the game
+  for (double y = 0; y <= BULLETS_WINDOW.y; y += BULLETS_SWEEP_STEP) {
+    for (double x = 0; x <= BULLETS_WINDOW.x; x += BULLETS_SWEEP_STEP) {
+      sdl_null_set_mouse((vector_t){x, y});
+      bullets_frame(state);
+    }
+  }
+  sdl_null_send_key('\r', KEY_PRESSED);
+  bullets_frame(state);
+
+  scene_t *scene = emscripten_get_scene(state);
+  // the first player's segments are added first, head first
+  body_t *head = bullets_find(scene, "player");
+  vector_t center = vec_multiply(0.5, BULLETS_WINDOW);
+  bullets_wall_t walls[] = {
+      {"left", {BULLETS_WALL_GAP, center.y}, {-1, 0}},
+      {"right", {BULLETS_WINDOW.x - BULLETS_WALL_GAP, center.y}, {1, 0}},
+      {"bottom", {center.x, BULLETS_WALL_GAP}, {0, -1}},
+      {"top", {center.x, BULLETS_WINDOW.y - BULLETS_WALL_GAP}, {0, 1}},
+  };
+  bool passed = head != NULL;
+  for (size_t i = 0; passed && i < sizeof(walls) / sizeof(*walls); i++) {
+    if (!bullets_shoot(state, head, walls[i])) {
+      printf("%s wall: could not shoot\n", walls[i].name);
+      passed = false;
+      break;
+    }
+    size_t frames = 0;
+    while (bullets_find(scene, "bullet") != NULL &&
+           frames < BULLETS_MAX_HIT_FRAMES) {
+      bullets_frame(state);
+      frames++;
+    }
+    if (bullets_find(scene, "bullet") != NULL) {
+      printf("%s wall: the bullet went through it\n", walls[i].name);
+      passed = false;
+    } else {
+      printf("%s wall: the bullet stopped after %zu frames\n", walls[i].name,
+             frames);
+    }
+  }
+  emscripten_free(state);
+
+  printf("%s\n", passed ? "PASS" : "FAIL");
+  return passed ? 0 : 1;
+}
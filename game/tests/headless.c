@@ -0,0 +1,174 @@
+/**
+ * Headless driver: runs SLYCE on the core library (null renderer, null audio,
+ * scripted input) for a number of ticks, as fast as possible,
+ * and reports the tick rate.
+ *
+ * Usage: bin/headless [-n ticks] [-s seed] [-i script] [-m metrics]
+ *                     [-t trace [-T ms]]
+ *
+ * With -m, the engine's metrics (see metrics.h) are written to a file:
+ * one CSV line per tick, or the run's totals if the file ends in ".json".
+ * With -t, the run is traced (see trace.h) and the last few frames are
+ * written to <trace>.json at the end. With -T as well, any frame that takes
+ * longer than that many milliseconds is written to <trace>-<frame>.json.
+ *
+ * Without a script (see scripted_input.h), the input is the soak test's:
+ * sweep the mouse over the menu, start the game, then mash the players' keys.
+ */
+
+#include "metrics.h"
+#include "scripted_input.h"
+#include "sdl_null.h"
+#include "state.h"
+#include "trace.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+const size_t HEADLESS_DEFAULT_TICKS = 100000;
+const double HEADLESS_TICK = 1.0 / 60;
+const vector_t HEADLESS_WINDOW = {.x = 1600, .y = 900};
+const double HEADLESS_SWEEP_STEP = 25;
+const char HEADLESS_KEYS[] = "qweruiopzxcvbnm,";
+// on average, one key event every this many ticks
+const int HEADLESS_KEY_PERIOD = 10;
+
+/** Builds the default script; returns the tick the game starts on */
+size_t headless_default_script(scripted_input_t *input, size_t ticks) {
+  size_t tick = 0;
+  for (double y = 0; y <= HEADLESS_WINDOW.y; y += HEADLESS_SWEEP_STEP) {
+    for (double x = 0; x <= HEADLESS_WINDOW.x; x += HEADLESS_SWEEP_STEP) {
+      scripted_input_add_mouse(input, tick++, (vector_t){x, y});
+    }
+  }
+  scripted_input_add_key(input, tick, '\r', KEY_PRESSED);
+  size_t start = tick;
+  for (tick++; tick < ticks; tick++) {
+    if (rand() % HEADLESS_KEY_PERIOD == 0) {
+      char key = HEADLESS_KEYS[rand() % (sizeof(HEADLESS_KEYS) - 1)];
+      scripted_input_add_key(input, tick, key,
+                             rand() % 2 ? KEY_PRESSED : KEY_RELEASED);
+    }
+  }
+  return start;
+}
+
+double headless_seconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+  size_t ticks = HEADLESS_DEFAULT_TICKS;
+  unsigned seed = 0;
+  const char *script = NULL;
+  const char *trace = NULL;
+  const char *metrics = NULL;
+  double slow_frame_ms = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:s:i:m:t:T:")) != -1) {
+    switch (opt) {
+    case 'n':
+      ticks = strtoul(optarg, NULL, 10);
+      break;
+    case 's':
+      seed = strtoul(optarg, NULL, 10);
+      break;
+    case 'i':
+      script = optarg;
+      break;
+    case 'm':
+      metrics = optarg;
+      break;
+    case 't':
+      trace = optarg;
+      break;
+    case 'T':
+      slow_frame_ms = strtod(optarg, NULL);
+      break;
+    default:
+      fprintf(stderr,
+              "usage: %s [-n ticks] [-s seed] [-i script] [-m metrics] "
+              "[-t trace [-T ms]]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+
+  srand(seed);
+  scripted_input_t *input;
+  if (script != NULL) {
+    input = scripted_input_load(script);
+    if (input == NULL) {
+      return 1;
+    }
+  } else {
+    input = scripted_input_init();
+    size_t start = headless_default_script(input, ticks);
+    if (start >= ticks) {
+      fprintf(stderr, "warning: the game starts on tick %zu\n", start);
+    }
+  }
+
+  FILE *metrics_file = NULL;
+  bool metrics_json = false;
+  if (metrics != NULL) {
+    metrics_file = fopen(metrics, "w");
+    if (metrics_file == NULL) {
+      fprintf(stderr, "%s: could not write metrics\n", metrics);
+      return 1;
+    }
+    size_t length = strlen(metrics);
+    metrics_json = length >= 5 && strcmp(metrics + length - 5, ".json") == 0;
+    if (!metrics_json) {
+      metrics_write_csv_header(metrics_file);
+    }
+  }
+  if (trace != NULL) {
+    tick_tracer_set_enabled(true);
+    tracer_set_slow_frame(tick_tracer(), slow_frame_ms, trace);
+  }
+  sdl_null_set_tick(HEADLESS_TICK);
+  state_t *state = emscripten_init();
+  double begin = headless_seconds();
+  size_t tick;
+  for (tick = 0; tick < ticks; tick++) {
+    scripted_input_step(input, tick);
+    emscripten_main(state);
+    if (metrics_file != NULL && !metrics_json) {
+      metrics_snapshot_t last_tick = metrics_get_last_tick();
+      metrics_write_csv_row(metrics_file, tick, &last_tick);
+    }
+    if (sdl_is_done(state)) {
+      tick++;
+      break;
+    }
+  }
+  double elapsed = headless_seconds() - begin;
+  if (metrics_file != NULL) {
+    if (metrics_json) {
+      metrics_snapshot_t total = metrics_get_total();
+      fprintf(metrics_file, "{\"ticks\":%zu,\"total\":", tick);
+      metrics_write_json(metrics_file, &total);
+      fprintf(metrics_file, "}\n");
+    }
+    fclose(metrics_file);
+  }
+  if (trace != NULL) {
+    size_t length = strlen(trace) + sizeof(".json");
+    char path[length];
+    snprintf(path, length, "%s.json", trace);
+    tracer_dump(tick_tracer(), path);
+    tick_tracer_set_enabled(false);
+  }
+  emscripten_free(state);
+  scripted_input_free(input);
+
+  printf("%zu ticks in %.3f s: %.0f ticks/s\n", tick, elapsed,
+         tick / elapsed);
+  return 0;
+}
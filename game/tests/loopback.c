@@ -0,0 +1,325 @@
+/**
+ * Loopback test of the server (see server.h): hosts a server on a thread and
+ * plays it from a number of clients over 127.0.0.1, each with its own UDP
+ * socket, at the server's tick rate.
+ *
+ * The first player to join points the mouse at every body of the menu
+ * snapshot, which picks every player's color, and starts the game. Then the
+ * players mash their buttons while the spectators watch, for some seconds.
+ * The test fails unless the game started, the server kept its tick rate,
+ * and every client received nearly every snapshot.
+ *
+ * Usage: bin/loopback [-c clients] [-s seconds] [-r seed]
+ */
+
+#include "server.h"
+#include <arpa/inet.h>
+#include <assert.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+const size_t LOOPBACK_DEFAULT_CLIENTS = 64;
+const double LOOPBACK_DEFAULT_SECONDS = 10;
+// the height of the game's window, to turn scene positions into mouse ones
+const double LOOPBACK_WINDOW_HEIGHT = 900;
+// ticks to join and start the game in before giving up
+const size_t LOOPBACK_SETUP_TICKS = 10 * SERVER_TICK_RATE;
+// ticks between resending a hello that was not answered
+const size_t LOOPBACK_HELLO_PERIOD = 10;
+// ticks between keepalives
+const size_t LOOPBACK_KEEPALIVE_PERIOD = SERVER_TICK_RATE;
+// on average, each player presses or releases a button this often, in ticks
+const int LOOPBACK_BUTTON_PERIOD = 10;
+// the share of ticks and snapshots that must make it
+const double LOOPBACK_MIN_DELIVERY = 0.95;
+
+typedef enum { LOOPBACK_JOIN, LOOPBACK_MENU, LOOPBACK_GAME } loopback_phase_t;
+
+typedef struct {
+  int socket_id;
+  bool welcomed;
+  uint8_t slot;
+  uint32_t seq;
+
+  // the snapshot being received
+  uint32_t tick;
+  size_t num_bodies;
+  size_t bodies_received;
+  server_body_t *bodies;
+  size_t bodies_capacity;
+  // whether it was received whole
+  bool complete;
+
+  size_t snapshots;
+} loopback_client_t;
+
+void *loopback_serve(void *server) {
+  server_listen(server, 0);
+  return NULL;
+}
+
+double loopback_seconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/** Sleeps until a deadline, given in seconds on the monotonic clock */
+void loopback_sleep_until(double deadline) {
+  struct timespec until = {.tv_sec = (time_t)deadline,
+                           .tv_nsec = (long)((deadline - (time_t)deadline) *
+                                             1e9)};
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) ==
+         EINTR) {
+  }
+}
+
+void loopback_send(loopback_client_t *client, server_message_t message) {
+  if (message.type == SERVER_MSG_INPUT) {
+    message.seq = ++client->seq;
+  }
+  uint8_t packet[SERVER_MAX_PACKET];
+  size_t size = server_message_write(&message, packet);
+  if (send(client->socket_id, packet, size, 0) < 0 && errno != EAGAIN &&
+      errno != EWOULDBLOCK) {
+    perror("send");
+  }
+}
+
+void loopback_receive(loopback_client_t *client) {
+  uint8_t packet[SERVER_MAX_PACKET];
+  ssize_t size;
+  while ((size = recv(client->socket_id, packet, sizeof(packet), 0)) >= 0) {
+    server_message_t message;
+    if (!server_message_read(&message, packet, size)) {
+      fprintf(stderr, "malformed packet from the server\n");
+      continue;
+    }
+    if (message.type == SERVER_MSG_WELCOME) {
+      client->welcomed = true;
+      client->slot = message.slot;
+      assert(message.tick_rate == SERVER_TICK_RATE);
+      continue;
+    }
+    if (message.type != SERVER_MSG_SNAPSHOT) {
+      continue;
+    }
+    if (message.tick != client->tick || client->num_bodies == 0) {
+      // the start of a new snapshot, or a chunk of one whose start was lost
+      client->tick = message.tick;
+      client->num_bodies = message.num_bodies;
+      client->bodies_received = 0;
+      client->complete = false;
+      if (client->bodies_capacity < message.num_bodies) {
+        client->bodies_capacity = message.num_bodies;
+        client->bodies = realloc(client->bodies, client->bodies_capacity *
+                                                     sizeof(server_body_t));
+        assert(client->bodies != NULL);
+      }
+    }
+    for (size_t i = 0; i < message.count; i++) {
+      client->bodies[message.first + i] = server_message_body(&message, i);
+    }
+    client->bodies_received += message.count;
+    if (client->bodies_received == client->num_bodies) {
+      client->complete = true;
+      client->snapshots++;
+    }
+  }
+  if (errno != EAGAIN && errno != EWOULDBLOCK) {
+    perror("recv");
+  }
+}
+
+int main(int argc, char *argv[]) {
+  size_t num_clients = LOOPBACK_DEFAULT_CLIENTS;
+  double seconds = LOOPBACK_DEFAULT_SECONDS;
+  unsigned seed = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "c:s:r:")) != -1) {
+    switch (opt) {
+    case 'c':
+      num_clients = strtoul(optarg, NULL, 10);
+      break;
+    case 's':
+      seconds = strtod(optarg, NULL);
+      break;
+    case 'r':
+      seed = strtoul(optarg, NULL, 10);
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-c clients] [-s seconds] [-r seed]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  if (num_clients == 0 || num_clients > SERVER_MAX_CLIENTS) {
+    fprintf(stderr, "between 1 and %d clients, please\n", SERVER_MAX_CLIENTS);
+    return 2;
+  }
+  srand(seed);
+
+  server_t *server = server_init(INADDR_LOOPBACK, 0);
+  if (!server_bind(server)) {
+    server_free(server);
+    return 1;
+  }
+  struct sockaddr_in address = {.sin_family = AF_INET,
+                                .sin_port = htons(server_get_port(server)),
+                                .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+  loopback_client_t *clients = calloc(num_clients, sizeof(loopback_client_t));
+  assert(clients != NULL);
+  for (size_t i = 0; i < num_clients; i++) {
+    clients[i].socket_id =
+        socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (clients[i].socket_id < 0 ||
+        connect(clients[i].socket_id, (struct sockaddr *)&address,
+                sizeof(address)) < 0) {
+      perror("client socket");
+      return 1;
+    }
+  }
+  pthread_t thread;
+  pthread_create(&thread, NULL, loopback_serve, server);
+
+  loopback_phase_t phase = LOOPBACK_JOIN;
+  loopback_client_t *host = NULL;
+  server_body_t *menu = NULL;
+  size_t num_menu = 0, next_menu = 0;
+  size_t game_tick = 0, end_tick = 0;
+  double period = 1.0 / SERVER_TICK_RATE;
+  double begin = loopback_seconds(), game_start = 0;
+  size_t tick;
+  for (tick = 0; end_tick == 0 || tick < end_tick; tick++) {
+    loopback_sleep_until(begin + tick * period);
+    for (size_t i = 0; i < num_clients; i++) {
+      loopback_receive(&clients[i]);
+    }
+
+    if (phase != LOOPBACK_GAME && tick >= LOOPBACK_SETUP_TICKS) {
+      fprintf(stderr, "FAIL: the game did not start in %zu ticks\n", tick);
+      break;
+    }
+    if (phase == LOOPBACK_JOIN) {
+      size_t welcomed = 0;
+      for (size_t i = 0; i < num_clients; i++) {
+        if (clients[i].welcomed) {
+          welcomed++;
+          if (host == NULL && clients[i].slot == 0) {
+            host = &clients[i];
+          }
+        } else if (tick % LOOPBACK_HELLO_PERIOD == 0) {
+          loopback_send(&clients[i],
+                        (server_message_t){.type = SERVER_MSG_HELLO});
+        }
+      }
+      if (welcomed == num_clients && host != NULL && host->complete) {
+        num_menu = host->num_bodies;
+        menu = malloc(num_menu * sizeof(server_body_t));
+        assert(menu != NULL || num_menu == 0);
+        memcpy(menu, host->bodies, num_menu * sizeof(server_body_t));
+        phase = LOOPBACK_MENU;
+      }
+    } else if (phase == LOOPBACK_MENU) {
+      if (next_menu < num_menu) {
+        // one move per tick, so the game sees every one
+        vector_t centroid = menu[next_menu++].centroid;
+        loopback_send(host, (server_message_t){
+                                .type = SERVER_MSG_INPUT,
+                                .button = SERVER_BUTTON_MOUSE,
+                                .mouse = {centroid.x,
+                                          LOOPBACK_WINDOW_HEIGHT - centroid.y}});
+      } else if (next_menu == num_menu) {
+        next_menu++;
+        loopback_send(host, (server_message_t){.type = SERVER_MSG_INPUT,
+                                               .button = SERVER_BUTTON_START,
+                                               .pressed = true});
+      } else if (host->complete && host->num_bodies != num_menu) {
+        phase = LOOPBACK_GAME;
+        game_tick = host->tick;
+        end_tick = tick + (size_t)(seconds * SERVER_TICK_RATE);
+        game_start = loopback_seconds();
+        for (size_t i = 0; i < num_clients; i++) {
+          clients[i].snapshots = 0;
+        }
+      }
+    } else {
+      for (size_t i = 0; i < num_clients; i++) {
+        if (clients[i].slot != SERVER_SPECTATOR &&
+            rand() % LOOPBACK_BUTTON_PERIOD == 0) {
+          loopback_send(&clients[i],
+                        (server_message_t){.type = SERVER_MSG_INPUT,
+                                           .button = rand() % SERVER_BUTTON_START,
+                                           .pressed = rand() % 2});
+        }
+      }
+    }
+    if ((tick + 1) % LOOPBACK_KEEPALIVE_PERIOD == 0) {
+      for (size_t i = 0; i < num_clients; i++) {
+        if (clients[i].welcomed) {
+          loopback_send(&clients[i],
+                        (server_message_t){.type = SERVER_MSG_HELLO});
+        }
+      }
+    }
+  }
+  double elapsed = loopback_seconds() - game_start;
+  size_t last_tick = host != NULL ? host->tick : 0;
+
+  for (size_t i = 0; i < num_clients; i++) {
+    loopback_send(&clients[i], (server_message_t){.type = SERVER_MSG_BYE});
+  }
+  // give the server a few ticks to see everyone leave
+  loopback_sleep_until(loopback_seconds() + 5 * period);
+  server_close(server);
+  pthread_join(thread, NULL);
+  server_stats_t stats = server_get_stats(server);
+
+  bool passed = phase == LOOPBACK_GAME;
+  if (passed) {
+    size_t min_snapshots = SIZE_MAX, total_snapshots = 0;
+    for (size_t i = 0; i < num_clients; i++) {
+      total_snapshots += clients[i].snapshots;
+      if (clients[i].snapshots < min_snapshots) {
+        min_snapshots = clients[i].snapshots;
+      }
+    }
+    size_t game_ticks = last_tick - game_tick;
+    double expected_ticks = elapsed * SERVER_TICK_RATE;
+    printf("%zu clients, %zu ticks in %.3f s: %.1f ticks/s\n", num_clients,
+           game_ticks, elapsed, game_ticks / elapsed);
+    printf("snapshots per client: min %zu, mean %.1f, of %zu ticks\n",
+           min_snapshots, (double)total_snapshots / num_clients, game_ticks);
+    printf("server: %zu ticks skipped, %zu packets in (%zu rejected), %zu "
+           "out (%zu dropped), %zu inputs dropped, %zu clients left\n",
+           stats.ticks_skipped, stats.packets_received,
+           stats.packets_rejected, stats.packets_sent, stats.sends_dropped,
+           stats.inputs_dropped, stats.clients);
+    if (game_ticks < LOOPBACK_MIN_DELIVERY * expected_ticks) {
+      fprintf(stderr, "FAIL: the server ran %zu ticks of %.0f\n", game_ticks,
+              expected_ticks);
+      passed = false;
+    }
+    if (min_snapshots < LOOPBACK_MIN_DELIVERY * game_ticks) {
+      fprintf(stderr, "FAIL: a client received %zu snapshots of %zu\n",
+              min_snapshots, game_ticks);
+      passed = false;
+    }
+  }
+
+  for (size_t i = 0; i < num_clients; i++) {
+    close(clients[i].socket_id);
+    free(clients[i].bodies);
+  }
+  free(clients);
+  free(menu);
+  server_free(server);
+  return passed ? 0 : 1;
+}
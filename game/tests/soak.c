@@ -0,0 +1,151 @@
+/**
+ * Headless soak test: plays SLYCE with scripted input for a long stretch of
+ * simulated time and checks that the process's memory use stays flat.
+ * After the warmup, it also checks that no tick allocates: the engine's
+ * allocation counters must read zero for every tick, and the frame arena
+ * must not go back to the system for more memory.
+ *
+ * Usage: bin/soak [simulated seconds, default one hour]
+ */
+
+#include "arena.h"
+#include "metrics.h"
+#include "sdl_null.h"
+#include "state.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+const double SOAK_DEFAULT_SECONDS = 3600;
+const double SOAK_TICK = 1.0 / 60;
+// memory may still grow while lists and pools reach their steady-state sizes
+const double SOAK_WARMUP_SECONDS = 300;
+const double SOAK_SAMPLE_SECONDS = 60;
+const long SOAK_RSS_SLACK_KB = 2048;
+const vector_t SOAK_WINDOW = {.x = 1600, .y = 900};
+// half the side of a color choice box, so the sweep hovers every box
+const double SOAK_SWEEP_STEP = 25;
+const char SOAK_KEYS[] = "qweruiopzxcvbnm,";
+// on average, one key event every this many frames
+const int SOAK_KEY_PERIOD = 10;
+
+/** Returns the resident set size in KB */
+long soak_rss_kb(void) {
+  FILE *statm = fopen("/proc/self/statm", "r");
+  if (statm != NULL) {
+    long size, resident;
+    int read = fscanf(statm, "%ld %ld", &size, &resident);
+    fclose(statm);
+    if (read == 2) {
+      return resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+  }
+  // no procfs: fall back to the peak, which also only grows if memory leaks
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+/** Returns the number of allocations counted during the last tick */
+uint64_t soak_tick_allocs(void) {
+  metrics_snapshot_t tick = metrics_get_last_tick();
+  return tick.values[METRIC_ALLOCS_LIST] +
+         tick.values[METRIC_ALLOCS_VEC_ARRAY] +
+         tick.values[METRIC_ALLOCS_POOL] + tick.values[METRIC_ALLOCS_ARENA];
+}
+
+/** Runs one frame the way emscripten.c's loop does */
+void soak_frame(state_t *state) {
+  emscripten_main(state);
+  sdl_is_done(state);
+}
+
+int main(int argc, char *argv[]) {
+  double seconds = argc > 1 ? atof(argv[1]) : SOAK_DEFAULT_SECONDS;
+  srand(0);
+  sdl_null_set_tick(SOAK_TICK);
+  state_t *state = emscripten_init();
+
+  // menu: hover over every color choice, then start the game
+  for (double y = 0; y <= SOAK_WINDOW.y; y += SOAK_SWEEP_STEP) {
+    for (double x = 0; x <= SOAK_WINDOW.x; x += SOAK_SWEEP_STEP) {
+      sdl_null_set_mouse((vector_t){x, y});
+      soak_frame(state);
+    }
+  }
+  sdl_null_send_key('\r', KEY_PRESSED);
+  soak_frame(state);
+
+  // game: mash the players' keys
+  size_t frames = seconds / SOAK_TICK;
+  size_t frames_per_sample = SOAK_SAMPLE_SECONDS / SOAK_TICK;
+  size_t warmup_frames = SOAK_WARMUP_SECONDS / SOAK_TICK;
+  long baseline_kb = -1, peak_kb = 0;
+  size_t arena_mallocs = 0, allocating_ticks = 0, first_allocating_tick = 0;
+  for (size_t frame = 1; frame <= frames; frame++) {
+    if (rand() % SOAK_KEY_PERIOD == 0) {
+      char key = SOAK_KEYS[rand() % (sizeof(SOAK_KEYS) - 1)];
+      sdl_null_send_key(key, rand() % 2 ? KEY_PRESSED : KEY_RELEASED);
+    }
+    soak_frame(state);
+    if (frame == warmup_frames) {
+      arena_mallocs = arena_get_malloc_count(frame_arena());
+    } else if (frame > warmup_frames && soak_tick_allocs() > 0) {
+      if (allocating_ticks == 0) {
+        first_allocating_tick = frame;
+      }
+      allocating_ticks++;
+    }
+
+    if (frame % frames_per_sample == 0) {
+      long rss_kb = soak_rss_kb();
+      printf("t=%6.0fs rss=%ldKB\n", frame * SOAK_TICK, rss_kb);
+      fflush(stdout);
+      if (frame >= warmup_frames) {
+        if (baseline_kb < 0) {
+          baseline_kb = rss_kb;
+        }
+        peak_kb = rss_kb > peak_kb ? rss_kb : peak_kb;
+      }
+    }
+  }
+  size_t arena_growth =
+      arena_get_malloc_count(frame_arena()) - arena_mallocs;
+  emscripten_free(state);
+
+  if (baseline_kb < 0) {
+    printf("ran for less than the %.0fs warmup; nothing to check\n",
+           SOAK_WARMUP_SECONDS);
+    return 0;
+  }
+  long growth_kb = peak_kb - baseline_kb;
+  printf("rss grew by %ldKB after warmup (allowed %ldKB)\n", growth_kb,
+         SOAK_RSS_SLACK_KB);
+  printf("%zu ticks allocated after warmup, the frame arena grew %zu times\n",
+         allocating_ticks, arena_growth);
+  bool failed = false;
+  if (growth_kb > SOAK_RSS_SLACK_KB) {
+    printf("FAIL: memory use is not flat\n");
+    failed = true;
+  }
+  if (allocating_ticks > 0) {
+    printf("FAIL: ticks still allocate, first at t=%.0fs\n",
+           first_allocating_tick * SOAK_TICK);
+    failed = true;
+  }
+  if (arena_growth > 0) {
+    printf("FAIL: the frame arena is not big enough for a frame\n");
+    failed = true;
+  }
+  if (failed) {
+    return 1;
+  }
+  printf("PASS\n");
+  return 0;
+}